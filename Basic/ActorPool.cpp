@@ -0,0 +1,150 @@
+#include "ActorPool.h"
+#include <algorithm>
+
+PX::ActorPool::ActorPool(Physics& physics, const ActorArchetype& archetype, const ActorPoolDesc& desc) : m_Physics(physics), m_Archetype(archetype), m_Desc(desc)
+{
+	ShapeRegistry& registry = m_Physics.GetShapeRegistry();
+	m_Material = registry.AcquireMaterial(m_Archetype.staticFriction, m_Archetype.dynamicFriction, m_Archetype.restitution);
+	m_Shape = registry.AcquireShape(m_Archetype.geometry.any(), *m_Material, m_Archetype.localPose);
+
+	Grow(m_Desc.prewarm);
+}
+
+PX::ActorPool::~ActorPool()
+{
+	// The scene can't lose actors mid step, and a pipelined Physics can still have one running
+	m_Physics.FetchResults();
+
+	std::vector<physx::PxRigidActor*> actors(m_Actors.begin(), m_Actors.end());
+	m_Physics.OnActorsRemoved(actors.data(), actors.size());
+
+	// Releasing takes the body out of the scene as well, parked or not
+	for (physx::PxRigidDynamic* actor : m_Actors)
+	{
+		actor->release();
+	}
+
+	ShapeRegistry& registry = m_Physics.GetShapeRegistry();
+	registry.ReleaseShape(m_Shape);
+	registry.ReleaseMaterial(m_Material);
+}
+
+void PX::ActorPool::Grow(size_t count)
+{
+	if (m_Desc.maxActors > 0)
+	{
+		count = std::min(count, m_Desc.maxActors - std::min(m_Desc.maxActors, m_Actors.size()));
+	}
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	physx::PxPhysics* physics = m_Physics.GetPhysics();
+	physx::PxTransform park(m_Desc.parkPosition);
+
+	std::vector<physx::PxActor*> added;
+	added.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		// The expensive part of a spawn, done once per body instead of every time
+		physx::PxRigidDynamic* actor = physics->createRigidDynamic(park);
+		actor->attachShape(*m_Shape);
+		physx::PxRigidBodyExt::updateMassAndInertia(*actor, m_Archetype.density);
+
+		if (m_Desc.deactivation == PoolDeactivation::DisableSimulation)
+		{
+			actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, true);
+			added.push_back(actor);
+		}
+
+		m_Actors.push_back(actor);
+		m_Free.push_back(actor);
+	}
+
+	if (!added.empty())
+	{
+		m_Physics.GetScene()->addActors(added.data(), static_cast<physx::PxU32>(added.size()));
+	}
+
+	m_Stats.capacity = m_Actors.size();
+}
+
+physx::PxRigidDynamic* PX::ActorPool::Spawn(const physx::PxTransform& pose, const physx::PxVec3& linear_velocity, const physx::PxVec3& angular_velocity)
+{
+	if (m_Free.empty())
+	{
+		size_t count = std::max<size_t>(1, static_cast<size_t>(static_cast<float>(m_Actors.size()) * m_Desc.growth));
+		Grow(count);
+
+		if (m_Free.empty())
+		{
+			m_Stats.refused++;
+			return nullptr;
+		}
+
+		m_Stats.grows++;
+	}
+
+	physx::PxRigidDynamic* actor = m_Free.back();
+	m_Free.pop_back();
+	m_Spawned.insert(actor);
+
+	actor->setGlobalPose(pose);
+	if (m_Desc.deactivation == PoolDeactivation::DisableSimulation)
+	{
+		actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, false);
+	}
+	else
+	{
+		m_Physics.GetScene()->addActor(*actor);
+	}
+
+	// Velocities can only be set once the body simulates again
+	actor->setLinearVelocity(linear_velocity);
+	actor->setAngularVelocity(angular_velocity);
+
+	m_Stats.spawns++;
+	m_Stats.active++;
+	return actor;
+}
+
+void PX::ActorPool::Despawn(physx::PxRigidDynamic* actor)
+{
+	if (actor == nullptr)
+	{
+		return;
+	}
+
+	if (m_Spawned.erase(actor) == 0)
+	{
+		m_Stats.rejected++;
+		return;
+	}
+
+	Park(*actor);
+	m_Free.push_back(actor);
+
+	m_Stats.despawns++;
+	m_Stats.active--;
+}
+
+void PX::ActorPool::Park(physx::PxRigidDynamic& actor)
+{
+	m_Physics.OnActorRemoved(&actor);
+
+	if (m_Desc.deactivation == PoolDeactivation::DisableSimulation)
+	{
+		// Stopped before the flag goes on, a body that doesn't simulate can't have its velocity set
+		actor.setLinearVelocity(physx::PxVec3(0.0f));
+		actor.setAngularVelocity(physx::PxVec3(0.0f));
+		actor.setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, true);
+		actor.setGlobalPose(physx::PxTransform(m_Desc.parkPosition));
+	}
+	else
+	{
+		m_Physics.GetScene()->removeActor(actor);
+	}
+}
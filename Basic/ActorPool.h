@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+
+namespace PX
+{
+	// Everything the pooled bodies of one kind have in common, like the unit box the samples build
+	struct ActorArchetype
+	{
+		physx::PxGeometryHolder geometry = physx::PxGeometryHolder(physx::PxBoxGeometry(0.5f, 0.5f, 0.5f));
+		physx::PxTransform localPose = physx::PxTransform(physx::PxIdentity);
+
+		physx::PxReal staticFriction = 0.4f;
+		physx::PxReal dynamicFriction = 0.4f;
+		physx::PxReal restitution = 0.4f;
+		physx::PxReal density = 100.0f;
+	};
+
+	enum class PoolDeactivation
+	{
+		// Stays in the scene with eDISABLE_SIMULATION set, parked out of the way so queries don't find it
+		DisableSimulation,
+
+		// Taken out of the scene, adding it back rebuilds its broadphase entry
+		RemoveFromScene
+	};
+
+	struct ActorPoolDesc
+	{
+		// Bodies created up front
+		size_t prewarm = 64;
+
+		PoolDeactivation deactivation = PoolDeactivation::RemoveFromScene;
+
+		// An empty pool grows by this fraction of what it holds, zero maxActors leaves it unbounded
+		float growth = 1.0f;
+		size_t maxActors = 0;
+
+		// Where parked bodies wait when they stay in the scene
+		physx::PxVec3 parkPosition = physx::PxVec3(0.0f, -10000.0f, 0.0f);
+	};
+
+	struct ActorPoolStats
+	{
+		size_t capacity = 0;
+		size_t active = 0;
+
+		std::uint64_t spawns = 0;
+		std::uint64_t despawns = 0;
+
+		// Times the pool ran dry and grew, and spawns it had to turn down at maxActors
+		std::uint64_t grows = 0;
+		std::uint64_t refused = 0;
+
+		// Despawns turned away because the body was already back or never came out of this pool
+		std::uint64_t rejected = 0;
+	};
+
+	// Keeps dynamic bodies of one archetype alive between uses, so spawning is a pose and a flag instead of
+	// createRigidDynamic, attachShape, updateMassAndInertia and addActor. Call it while the scene isn't simulating
+	class ActorPool
+	{
+	public:
+		ActorPool(Physics& physics, const ActorArchetype& archetype, const ActorPoolDesc& desc = ActorPoolDesc());
+		ActorPool(const ActorPool&) = delete;
+		ActorPool& operator=(const ActorPool&) = delete;
+		virtual ~ActorPool();
+
+		// Null when the pool is at maxActors
+		physx::PxRigidDynamic* Spawn(const physx::PxTransform& pose, const physx::PxVec3& linear_velocity = physx::PxVec3(0.0f), const physx::PxVec3& angular_velocity = physx::PxVec3(0.0f));
+
+		// Only for bodies this pool spawned, anything else or a second despawn of the same body is ignored
+		void Despawn(physx::PxRigidDynamic* actor);
+
+		// Adds count parked bodies
+		void Grow(size_t count);
+
+		inline const ActorPoolStats& GetStats() const { return m_Stats; }
+		inline const ActorArchetype& GetArchetype() const { return m_Archetype; }
+
+	private:
+		Physics& m_Physics;
+		ActorArchetype m_Archetype;
+		ActorPoolDesc m_Desc;
+		ActorPoolStats m_Stats;
+
+		// From the shape registry, every body in the pool shares them
+		physx::PxMaterial* m_Material = nullptr;
+		physx::PxShape* m_Shape = nullptr;
+
+		std::vector<physx::PxRigidDynamic*> m_Actors;
+		std::vector<physx::PxRigidDynamic*> m_Free;
+
+		// Bodies out of the pool right now, so a body can't go back twice and end up with two owners
+		std::unordered_set<physx::PxRigidDynamic*> m_Spawned;
+
+		void Park(physx::PxRigidDynamic& actor);
+	};
+}
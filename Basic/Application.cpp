@@ -1,5 +1,7 @@
 #include "Application.h"
 #include "DxLineManager.h"
+#include "GeometryGenerator.h"
+#include "PrimitiveFit.h"
 
 #include <string>
 #include <iostream>
@@ -21,14 +23,45 @@ int Applicataion::Execute()
 
     // Create physics
     m_Physics = std::make_unique<PX::Physics>();
+    m_Physics->SetPvdDesc(m_PvdDesc);
     m_Physics->Setup();
+    m_Physics->SetFixedTimestep(1.0 / 60.0);
+    m_Physics->SetPipelined(true);
+
+    // F9 records a trace of the next few frames, F10 streams the step statistics to a file
+    PX::Profiler& profiler = m_Physics->GetProfiler();
+
+    // Create the entities, every box draws the one unit box mesh
+    m_MeshLibrary = std::make_unique<DX::MeshLibrary>(m_DxRenderer.get());
+    DX::MeshData box_data;
+    GeometryGenerator::CreateBox(1.0f, 1.0f, 1.0f, &box_data);
+    m_BoxMesh = m_MeshLibrary->Add(box_data);
+
+    m_BodyArchetype = m_Entities.AddArchetype({ "Body", true });
+    m_DebrisArchetype = m_Entities.AddArchetype({ "Debris", true });
+    CreateBody(0.0f, 5.0f, 0.0f);
 
     // Create models
-    m_DynamicModel = std::make_unique<DX::DynamicModel>(m_DxRenderer.get(), m_Physics.get());
-    m_DynamicModel->Create(0.0f, 5.0f, 0.0f);
 
-    m_PlaneModel = std::make_unique<DX::PlaneModel>(m_DxRenderer.get(), m_Physics.get());
-    m_PlaneModel->Create();
+    if (m_UseTerrain)
+    {
+        m_TerrainModel = std::make_unique<DX::TerrainModel>(m_DxRenderer.get(), m_Physics.get());
+        m_TerrainModel->Create();
+    }
+    else
+    {
+        m_PlaneModel = std::make_unique<DX::PlaneModel>(m_DxRenderer.get(), m_Physics.get());
+        m_PlaneModel->Create();
+    }
+
+    if (m_DebrisRate > 0)
+    {
+        // Enough for about two seconds of debris up front, the pool grows if they live longer
+        PX::ActorPoolDesc pool_desc;
+        pool_desc.prewarm = static_cast<size_t>(m_DebrisRate) * 2;
+        pool_desc.deactivation = PX::PoolDeactivation::DisableSimulation;
+        m_DebrisPool = std::make_unique<PX::ActorPool>(*m_Physics, PX::ActorArchetype(), pool_desc);
+    }
 
     // Starts the timer
     m_Timer.Start();
@@ -72,12 +105,60 @@ int Applicataion::Execute()
                 // Update world constant buffer with new camera view and perspective
                 SetCameraBuffer();
             }
+            else if (e.type == SDL_KEYDOWN)
+            {
+                if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+                {
+                    profiler.Capture(120, "PhysXTrace.json");
+                }
+                else if (e.key.keysym.scancode == SDL_SCANCODE_F10)
+                {
+                    // Toggle streaming the per step statistics
+                    PX::StatsRecorder& stats = m_Physics->GetStatsRecorder();
+                    if (stats.IsStreaming())
+                        stats.StopStream();
+                    else
+                        stats.StartStream("PhysXStats.csv", PX::StatsFormat::Csv);
+                }
+            }
         }
         else
         {
             m_Timer.Tick();
+
+            // Collect the step started last frame before reading anything back
+            m_Physics->FetchResults();
+            profiler.NextFrame();
             CalculateFramesPerSecond();
 
+            // Read back the poses while the scene is idle. Only the awake entities are handed theirs, the store then
+            // converts those in one batch across the workers
+            {
+                PX::ProfileZone zone(profiler, "Update");
+                m_Physics->SyncActiveActors();
+                m_Entities.Update(*m_Physics);
+            }
+
+            // Tiles follow the body, they're added and evicted here while the scene is idle
+            if (m_TerrainModel)
+            {
+                PX::ProfileZone zone(profiler, "Terrain");
+                physx::PxVec3 focus = m_Body->getGlobalPose().p;
+                m_TerrainModel->Update(DirectX::XMFLOAT3(focus.x, focus.y, focus.z));
+            }
+
+            if (m_DebrisPool)
+            {
+                PX::ProfileZone zone(profiler, "Debris");
+                UpdateDebris(m_Timer.DeltaTime());
+            }
+
+            {
+                PX::ProfileZone zone(profiler, "LineManager");
+                line_manager->AddSceneLine(m_Physics.get());
+            }
+
+            // Start the next step, it runs on the PhysX workers while we record the frame
             m_Physics->Simulate(m_Timer.DeltaTime());
 
             // Clear the buffers
@@ -86,33 +167,116 @@ int Applicataion::Execute()
             // Bind the shader to the pipeline
             m_DxShader->Use();
 
-            // Render the model
-            m_DynamicModel->Update();
-            m_DxShader->UpdateWorldBuffer(m_DynamicModel->World, m_DynamicModel->Colour);
-            m_DynamicModel->Render();
+            // Render the entities
+            RenderEntities();
 
             // Render the floor
-            m_DxShader->UpdateWorldBuffer(m_PlaneModel->World, m_PlaneModel->Colour);
-            m_PlaneModel->Render();
-
-            // Render lines
-            line_manager->AddSceneLine(m_Physics.get());
+            if (m_TerrainModel)
+            {
+                m_DxShader->UpdateWorldBuffer(m_TerrainModel->World, m_TerrainModel->Colour);
+                m_TerrainModel->Render();
+            }
+            else
+            {
+                m_DxShader->UpdateWorldBuffer(m_PlaneModel->World, m_PlaneModel->Colour);
+                m_PlaneModel->Render();
+            }
 
             // Apply shader
             m_DxLineShader->Use();
             m_DxLineShader->UpdateModel(DirectX::XMMatrixIdentity());
 
-            line_manager->Render();
-            line_manager->ClearLines();
+            {
+                PX::ProfileZone zone(profiler, "LineManager");
+                line_manager->Render();
+                line_manager->ClearLines();
+            }
 
             // Display the rendered scene
-            m_DxRenderer->Present();
+            {
+                PX::ProfileZone zone(profiler, "Present");
+                m_DxRenderer->Present();
+            }
         }
     }
 
     return 0;
 }
 
+void Applicataion::UpdateDebris(double delta_time)
+{
+    constexpr double lifetime = 3.0;
+
+    // Oldest first, so the expired ones are always at the front
+    for (Debris& debris : m_Debris)
+    {
+        debris.age += delta_time;
+    }
+
+    while (!m_Debris.empty() && m_Debris.front().age > lifetime)
+    {
+        m_Entities.Destroy(m_Debris.front().entity);
+        m_DebrisPool->Despawn(m_Debris.front().actor);
+        m_Debris.pop_front();
+    }
+
+    // Fired out of the top of the body in a random direction. A new one starts from its spawn pose, the previous
+    // poses are read when the next step starts so nothing of where it was parked is blended in
+    std::uniform_real_distribution<float> spread(-4.0f, 4.0f);
+    physx::PxTransform origin(m_Body->getGlobalPose().p + physx::PxVec3(0.0f, 2.0f, 0.0f));
+
+    m_DebrisDue += m_DebrisRate * delta_time;
+    while (m_DebrisDue >= 1.0)
+    {
+        m_DebrisDue -= 1.0;
+
+        physx::PxVec3 velocity(spread(m_DebrisRandom), 6.0f + spread(m_DebrisRandom), spread(m_DebrisRandom));
+        physx::PxRigidDynamic* actor = m_DebrisPool->Spawn(origin, velocity);
+        if (actor != nullptr)
+        {
+            // Drawn from its spawn pose this frame, the store reads it back from the next update on
+            PX::EntityHandle entity = m_Entities.Create(m_DebrisArchetype, actor, m_BoxMesh, physx::PxVec4(1.0f, 0.6f, 0.0f, 1.0f));
+            m_Debris.push_back({ actor, entity, 0.0 });
+        }
+    }
+}
+
+void Applicataion::CreateBody(float x, float y, float z)
+{
+    // Every box of the same size shares one material and one shape through the registry
+    PX::ShapeRegistry& registry = m_Physics->GetShapeRegistry();
+    physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+
+    // Collide as the cheapest primitive that fits the render mesh, or the tighter box when none fits closely enough
+    PX::PrimitiveFitResult fit = PX::FitPrimitives(m_MeshLibrary->GetMeshData(m_BoxMesh));
+    const PX::PrimitiveFit& primitive = fit.GetPrimitive();
+    physx::PxShape* shape = registry.AcquireShape(primitive.geometry.any(), *material, primitive.localPose);
+
+    m_Body = m_Physics->GetPhysics()->createRigidDynamic(physx::PxTransform(physx::PxVec3(x, y, z)));
+    m_Body->attachShape(*shape);
+    physx::PxRigidBodyExt::updateMassAndInertia(*m_Body, 100.0f);
+    m_Physics->GetScene()->addActor(*m_Body);
+
+    m_Entities.Create(m_BodyArchetype, m_Body, m_BoxMesh, physx::PxVec4(1.0f, 0.0f, 0.0f, 1.0f));
+}
+
+void Applicataion::RenderEntities()
+{
+    // The floor bound its own buffers last frame
+    m_MeshLibrary->ResetBinding();
+
+    for (PX::ArchetypeId archetype = 0; archetype < m_Entities.GetArchetypeCount(); ++archetype)
+    {
+        PX::EntityView view = m_Entities.GetView(archetype);
+        for (size_t i = 0; i < view.count; ++i)
+        {
+            const physx::PxVec4& colour = view.colours[i];
+            m_DxShader->UpdateWorldBuffer(view.world[i], view.normal[i], DirectX::XMFLOAT4(colour.x, colour.y, colour.z, colour.w));
+            m_MeshLibrary->Draw(view.meshes[i]);
+        }
+    }
+}
+
 void Applicataion::DirectXSetup()
 {
     // Initialise SDL subsystems and creates the window
@@ -208,20 +372,37 @@ void Applicataion::SDLCleanup()
 
 void Applicataion::CalculateFramesPerSecond()
 {
-    // Changes the window title to show the frames per second and average frame time every second
+    // Changes the window title to show the frames per second, average frame time and how much of the physics step overlapped the frame and the heap allocations per step before and after the scratch block every second
 
     static double time = 0;
     static int frameCount = 0;
+    static double overlap = 0;
+    static int stepCount = 0;
 
     frameCount++;
     time += m_Timer.DeltaTime();
+
+    const PX::PipelineStats& stats = m_Physics->GetPipelineStats();
+    if (stats.fetched)
+    {
+        overlap += stats.overlapRatio;
+        stepCount++;
+    }
+
     if (time > 1.0f)
     {
         auto fps = frameCount;
+        auto overlap_percent = stepCount > 0 ? static_cast<int>(100.0 * overlap / stepCount) : 0;
         time = 0.0f;
         frameCount = 0;
-
-        auto title = "PhysX Samples - Testing - FPS: " + std::to_string(fps) + " (" + std::to_string(1000.0f / fps) + " ms)";
+        overlap = 0.0;
+        stepCount = 0;
+
+        const PX::ScratchStats& scratch = m_Physics->GetScratchStats();
+        const PX::ActiveActorStats& active = m_Physics->GetActiveActorStats();
+        auto title = "PhysX Samples - Testing - FPS: " + std::to_string(fps) + " (" + std::to_string(1000.0f / fps) + " ms) - Physics overlap: " + std::to_string(overlap_percent) + "%"
+            + " - Allocs/step: " + std::to_string(static_cast<int>(scratch.baselineAllocations)) + " -> " + std::to_string(scratch.stepAllocations)
+            + " - Active: " + std::to_string(active.active) + "/" + std::to_string(active.total);
         SDL_SetWindowTitle(m_SdlWindow, title.c_str());
     }
 }
@@ -1,17 +1,22 @@
 #pragma once
 
 #include <iostream>
+#include <deque>
 #include <memory>
+#include <random>
 #include <SDL_video.h>
 #include "Timer.h"
 #include "DxRenderer.h"
 #include "DxShader.h"
 #include "DxLineShader.h"
 #include "DxCamera.h"
+#include "DxMeshLibrary.h"
 
-#include "DynamicModel.h"
 #include "PlaneModel.h"
+#include "TerrainModel.h"
 
+#include "ActorPool.h"
+#include "EntityStore.h"
 #include "Physics.h"
 
 class Applicataion
@@ -22,6 +27,15 @@ public:
 
 	int Execute();
 
+	// PVD connection for the physics, must be set before Execute
+	inline void SetPvdDesc(const PX::PvdDesc& desc) { m_PvdDesc = desc; }
+
+	// Stream height field terrain around the body instead of the flat plane
+	inline void SetUseTerrain(bool use_terrain) { m_UseTerrain = use_terrain; }
+
+	// Fire this many pooled boxes a second out of the body, each one lives a few seconds
+	inline void SetDebrisRate(int per_second) { m_DebrisRate = per_second; }
+
 private:
 	void DirectXSetup();
 
@@ -38,9 +52,18 @@ private:
 	std::unique_ptr<DX::Renderer> m_DxRenderer = nullptr;
 	
 	// Direct3D 11 model
-	std::unique_ptr<DX::DynamicModel> m_DynamicModel = nullptr;
 	std::unique_ptr<DX::PlaneModel> m_PlaneModel = nullptr;
 
+	// Bodies live in the entity store instead of a model each, the box and the debris are archetypes of their own
+	std::unique_ptr<DX::MeshLibrary> m_MeshLibrary = nullptr;
+	PX::EntityStore m_Entities;
+	PX::ArchetypeId m_BodyArchetype = 0;
+	PX::ArchetypeId m_DebrisArchetype = 0;
+	PX::MeshHandle m_BoxMesh = 0;
+	physx::PxRigidDynamic* m_Body = nullptr;
+	void CreateBody(float x, float y, float z);
+	void RenderEntities();
+
 	// Direct3D 11 shader
 	std::unique_ptr<DX::Shader> m_DxShader = nullptr;
 	std::unique_ptr<DX::LineShader> m_DxLineShader = nullptr;
@@ -55,4 +78,24 @@ private:
 	void SetupDirectionalLight();
 
 	std::unique_ptr<PX::Physics> m_Physics = nullptr;
+	PX::PvdDesc m_PvdDesc;
+
+	// After m_Physics so its tiles are released while the scene still exists
+	std::unique_ptr<DX::TerrainModel> m_TerrainModel = nullptr;
+	bool m_UseTerrain = false;
+
+	// Debris, pooled so the churn never creates or releases a body
+	struct Debris
+	{
+		physx::PxRigidDynamic* actor = nullptr;
+		PX::EntityHandle entity;
+		double age = 0.0;
+	};
+
+	std::unique_ptr<PX::ActorPool> m_DebrisPool = nullptr;
+	std::deque<Debris> m_Debris;
+	std::mt19937 m_DebrisRandom;
+	double m_DebrisDue = 0.0;
+	int m_DebrisRate = 0;
+	void UpdateDebris(double delta_time);
 };
\ No newline at end of file
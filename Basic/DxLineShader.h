@@ -3,7 +3,6 @@
 #include "DxRenderer.h"
 #include "DxShader.h"
 #include <DirectXMath.h>
-#include "DynamicModel.h"
 
 namespace DX
 {
@@ -0,0 +1,58 @@
+#include "DxMeshLibrary.h"
+
+DX::MeshLibrary::MeshLibrary(Renderer* renderer) : m_DxRenderer(renderer)
+{
+}
+
+PX::MeshHandle DX::MeshLibrary::Add(const MeshData& mesh_data)
+{
+	auto d3dDevice = m_DxRenderer->GetDevice();
+
+	Mesh mesh;
+	mesh.meshData = mesh_data;
+
+	// Create vertex buffer
+	D3D11_BUFFER_DESC vertex_buffer_desc = {};
+	vertex_buffer_desc.Usage = D3D11_USAGE_DEFAULT;
+	vertex_buffer_desc.ByteWidth = static_cast<UINT>(sizeof(Vertex) * mesh.meshData.vertices.size());
+	vertex_buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA vertex_subdata = {};
+	vertex_subdata.pSysMem = mesh.meshData.vertices.data();
+
+	DX::Check(d3dDevice->CreateBuffer(&vertex_buffer_desc, &vertex_subdata, mesh.vertexBuffer.ReleaseAndGetAddressOf()));
+
+	// Create index buffer
+	D3D11_BUFFER_DESC index_buffer_desc = {};
+	index_buffer_desc.Usage = D3D11_USAGE_DEFAULT;
+	index_buffer_desc.ByteWidth = static_cast<UINT>(sizeof(UINT) * mesh.meshData.indices.size());
+	index_buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA index_subdata = {};
+	index_subdata.pSysMem = mesh.meshData.indices.data();
+
+	DX::Check(d3dDevice->CreateBuffer(&index_buffer_desc, &index_subdata, mesh.indexBuffer.ReleaseAndGetAddressOf()));
+
+	m_Meshes.push_back(std::move(mesh));
+	return static_cast<PX::MeshHandle>(m_Meshes.size() - 1);
+}
+
+void DX::MeshLibrary::Draw(PX::MeshHandle mesh_handle)
+{
+	auto d3dDeviceContext = m_DxRenderer->GetDeviceContext();
+	const Mesh& mesh = m_Meshes[mesh_handle];
+
+	// Entities of one mesh follow each other in an archetype, so most draws skip the binding
+	if (m_Bound != mesh_handle)
+	{
+		UINT vertex_stride = sizeof(Vertex);
+		auto vertex_offset = 0u;
+
+		d3dDeviceContext->IASetVertexBuffers(0, 1, mesh.vertexBuffer.GetAddressOf(), &vertex_stride, &vertex_offset);
+		d3dDeviceContext->IASetIndexBuffer(mesh.indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		d3dDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		m_Bound = mesh_handle;
+	}
+
+	d3dDeviceContext->DrawIndexed(static_cast<UINT>(mesh.meshData.indices.size()), 0, 0);
+}
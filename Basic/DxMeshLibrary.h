@@ -0,0 +1,41 @@
+#pragma once
+
+#include "DxRenderer.h"
+#include <vector>
+#include "Vertex.h"
+#include "EntityStore.h"
+
+namespace DX
+{
+	// GPU buffers for each mesh the entities draw, created once and shared by every entity with the same handle
+	class MeshLibrary
+	{
+	public:
+		MeshLibrary(Renderer* renderer);
+		virtual ~MeshLibrary() = default;
+
+		// Uploads the mesh, the handle is its place in the library
+		PX::MeshHandle Add(const MeshData& mesh_data);
+
+		// Binds the mesh's buffers unless they're bound already, then draws it
+		void Draw(PX::MeshHandle mesh);
+
+		// Forget what's bound, call it when something else has bound its own buffers
+		inline void ResetBinding() { m_Bound = UINT32_MAX; }
+
+		// CPU copy of a mesh, for fitting its collision shape
+		inline const MeshData& GetMeshData(PX::MeshHandle mesh) const { return m_Meshes[mesh].meshData; }
+
+	private:
+		struct Mesh
+		{
+			ComPtr<ID3D11Buffer> vertexBuffer = nullptr;
+			ComPtr<ID3D11Buffer> indexBuffer = nullptr;
+			MeshData meshData;
+		};
+
+		Renderer* m_DxRenderer = nullptr;
+		std::vector<Mesh> m_Meshes;
+		PX::MeshHandle m_Bound = UINT32_MAX;
+	};
+}
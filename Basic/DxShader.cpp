@@ -1,4 +1,5 @@
 #include "DxShader.h"
+#include <cstring>
 #include <fstream>
 #include <vector>
 
@@ -74,13 +75,28 @@ void DX::Shader::UpdateCameraBuffer(const CameraBuffer& buffer)
 
 void DX::Shader::UpdateWorldBuffer(const DirectX::XMMATRIX& world, const DirectX::XMFLOAT4& colour)
 {
-	auto d3dDeviceContext = m_DxRenderer->GetDeviceContext();
-
 	DX::WorldBuffer buffer = {};
 	buffer.world = DirectX::XMMatrixTranspose(world);
 	buffer.worldInverse = DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(nullptr, world));
 	buffer.colour = colour;
 
+	WriteWorldBuffer(buffer);
+}
+
+void DX::Shader::UpdateWorldBuffer(const PX::ShaderMatrix& world, const PX::ShaderMatrix& normal, const DirectX::XMFLOAT4& colour)
+{
+	DX::WorldBuffer buffer = {};
+	std::memcpy(&buffer.world, &world, sizeof(PX::ShaderMatrix));
+	std::memcpy(&buffer.worldInverse, &normal, sizeof(PX::ShaderMatrix));
+	buffer.colour = colour;
+
+	WriteWorldBuffer(buffer);
+}
+
+void DX::Shader::WriteWorldBuffer(const WorldBuffer& buffer)
+{
+	auto d3dDeviceContext = m_DxRenderer->GetDeviceContext();
+
 	// We use Map/Unmap here over UpdateSubresource for performance
 	D3D11_MAPPED_SUBRESOURCE resource = {};
 	DX::Check(d3dDeviceContext->Map(m_d3dWorldConstantBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &resource));
@@ -2,7 +2,7 @@
 
 #include "DxRenderer.h"
 #include <DirectXMath.h>
-#include "DynamicModel.h"
+#include "TransformBatch.h"
 #include <string>
 
 namespace DX
@@ -48,6 +48,9 @@ namespace DX
 		// Set world constant buffer from camera
 		void UpdateWorldBuffer(const DirectX::XMMATRIX& world, const DirectX::XMFLOAT4& colour);
 
+		// Set world constant buffer from matrices PX::PosesToMatrices already transposed and inverted
+		void UpdateWorldBuffer(const PX::ShaderMatrix& world, const PX::ShaderMatrix& normal, const DirectX::XMFLOAT4& colour);
+
 		// Update camera buffer
 		void UpdateDirectionalLightBuffer(const DirectionalLightBuffer& buffer);
 
@@ -70,6 +73,7 @@ namespace DX
 		// World constant buffer
 		ComPtr<ID3D11Buffer> m_d3dWorldConstantBuffer = nullptr;
 		void CreateWorldConstantBuffer();
+		void WriteWorldBuffer(const WorldBuffer& buffer);
 
 		// Light constant buffer
 		ComPtr<ID3D11Buffer> m_d3dDirectionalLightConstantBuffer = nullptr;
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+#include "TransformBatch.h"
+
+namespace PX
+{
+	// Index into whatever holds the GPU buffers, the store only carries it along
+	using MeshHandle = std::uint32_t;
+	using ArchetypeId = std::uint32_t;
+
+	// Stays valid while the entity lives, a destroyed entity's handle is refused even once its slot is reused
+	struct EntityHandle
+	{
+		std::uint32_t index = UINT32_MAX;
+		std::uint32_t generation = 0;
+
+		inline bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	struct ArchetypeDesc
+	{
+		std::string name;
+
+		// Dynamic archetypes take the poses SyncActiveActors hands over, static ones keep the pose they were created with
+		bool dynamic = true;
+	};
+
+	// One archetype's entities, the arrays are in step and valid until the next create or destroy
+	struct EntityView
+	{
+		size_t count = 0;
+		const physx::PxTransform* poses = nullptr;
+		const ShaderMatrix* world = nullptr;
+		const ShaderMatrix* normal = nullptr;
+		const physx::PxVec4* colours = nullptr;
+		const MeshHandle* meshes = nullptr;
+		physx::PxRigidActor* const* actors = nullptr;
+	};
+
+	// Bodies kept as structure-of-arrays per archetype instead of an object each: pose, shader matrices, colour,
+	// mesh and actor side by side, so an update is a walk down contiguous arrays. Destroying swaps the last
+	// entity into the hole and the handle's slot follows it. The store doesn't own the actors, but a dynamic
+	// entity's actor has its userData pointed at the store for as long as the entity lives, so only the
+	// entities Physics::SyncActiveActors finds awake are refreshed
+	class EntityStore
+	{
+	public:
+		EntityStore() = default;
+		EntityStore(const EntityStore&) = delete;
+		EntityStore& operator=(const EntityStore&) = delete;
+
+		ArchetypeId AddArchetype(const ArchetypeDesc& desc);
+		void Reserve(ArchetypeId archetype, size_t count);
+
+		// Matrices start from the actor's current pose
+		EntityHandle Create(ArchetypeId archetype, physx::PxRigidActor* actor, MeshHandle mesh, const physx::PxVec4& colour);
+
+		// False for a handle that is already gone
+		bool Destroy(EntityHandle handle);
+
+		bool IsAlive(EntityHandle handle) const;
+		physx::PxRigidActor* GetActor(EntityHandle handle) const;
+		void SetColour(EntityHandle handle, const physx::PxVec4& colour);
+
+		// Converts the poses SyncActiveActors handed over since the last update in one batch across the job system,
+		// call it straight after SyncActiveActors while the scene is idle
+		void Update(Physics& physics, size_t grain_size = 1024);
+
+		EntityView GetView(ArchetypeId archetype) const;
+		inline size_t GetArchetypeCount() const { return m_Archetypes.size(); }
+		size_t GetCount() const;
+
+		// Bytes held by the arrays and the handle table, capacity included
+		size_t GetMemoryBytes() const;
+
+		// Forgets every entity, handles handed out so far stop being alive
+		void Clear();
+
+	private:
+		struct Archetype
+		{
+			ArchetypeDesc desc;
+			std::vector<physx::PxTransform> poses;
+			std::vector<ShaderMatrix> world;
+			std::vector<ShaderMatrix> normal;
+			std::vector<physx::PxVec4> colours;
+			std::vector<MeshHandle> meshes;
+			std::vector<physx::PxRigidActor*> actors;
+
+			// Handle slot of each entity, so a swap can point the moved entity's slot at its new place
+			std::vector<std::uint32_t> slots;
+		};
+
+		struct Slot
+		{
+			ArchetypeId archetype = 0;
+			std::uint32_t dense = 0;
+			std::uint32_t generation = 0;
+			bool alive = false;
+		};
+
+		// What a dynamic entity's userData points at, one per slot in a deque so they stay put as slots are added
+		class SlotOwner : public ActorOwner
+		{
+		public:
+			SlotOwner(EntityStore& store, std::uint32_t slot) : m_Store(store), m_Slot(slot) {}
+			void SyncTransform(const physx::PxTransform& pose) override { m_Store.Sync(m_Slot, pose); }
+
+		private:
+			EntityStore& m_Store;
+			std::uint32_t m_Slot = 0;
+		};
+
+		std::vector<Archetype> m_Archetypes;
+		std::vector<Slot> m_Slots;
+		std::vector<std::uint32_t> m_FreeSlots;
+		std::deque<SlotOwner> m_Owners;
+
+		// Slots synced since the last update, and the batch their poses are converted through
+		std::vector<std::uint32_t> m_Synced;
+		std::vector<physx::PxTransform> m_SyncedPoses;
+		std::vector<ShaderMatrix> m_SyncedWorld;
+		std::vector<ShaderMatrix> m_SyncedNormal;
+
+		const Slot* Find(EntityHandle handle) const;
+		void Sync(std::uint32_t slot, const physx::PxTransform& pose);
+	};
+}
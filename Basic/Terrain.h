@@ -0,0 +1,123 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+#include "Vertex.h"
+
+namespace PX
+{
+	struct TerrainDesc
+	{
+		// Samples along each side of a tile, neighbouring tiles share their edge samples
+		int tileSamples = 65;
+		physx::PxReal sampleSpacing = 1.0f;
+
+		// Hills reach heightScale above and below baseHeight, which sits where PlaneModel's ground is
+		physx::PxReal heightScale = 4.0f;
+		physx::PxReal baseHeight = -1.0f;
+
+		// Tiles within loadRadius of the focus tile are loaded, ones past evictRadius are released
+		int loadRadius = 2;
+		int evictRadius = 3;
+
+		// Cook each tile as a triangle mesh over the same samples instead of a height field, for comparison
+		bool triangleMesh = false;
+	};
+
+	using TerrainTileKey = std::pair<int, int>;
+
+	struct TerrainTile
+	{
+		TerrainTileKey key;
+
+		// World heights, tileSamples * tileSamples with x running down the rows
+		std::vector<physx::PxReal> heights;
+		physx::PxVec3 origin = physx::PxVec3(0.0f);
+
+		physx::PxRigidStatic* actor = nullptr;
+		size_t cookedBytes = 0;
+		double cookMs = 0.0;
+	};
+
+	struct TerrainStats
+	{
+		size_t loadedTiles = 0;
+		size_t pendingTiles = 0;
+		std::uint64_t loads = 0;
+		std::uint64_t evictions = 0;
+
+		// Of the loaded tiles, the samples are kept for the render grids
+		size_t cookedBytes = 0;
+		size_t sampleBytes = 0;
+		double cookMs = 0.0;
+	};
+
+	// Streams terrain tiles around a focus point. Tiles are generated and cooked on a thread of their own so a long
+	// cook never holds up the PhysX workers, and are added to or removed from the scene in Update on the calling thread
+	class Terrain
+	{
+	public:
+		Terrain(Physics& physics, const TerrainDesc& desc = TerrainDesc());
+		virtual ~Terrain();
+
+		// Queues the missing tiles around position, nearest first
+		void SetFocus(const physx::PxVec3& position);
+
+		// Adds the tiles cooked since the last call and evicts the far ones, call while the scene isn't simulating.
+		// Returns true when the loaded set changed
+		bool Update();
+
+		// Blocks until everything queued has been cooked, then runs Update
+		void Flush();
+
+		// Height of the terrain anywhere, the tiles sample this
+		physx::PxReal GetHeight(physx::PxReal x, physx::PxReal z) const;
+
+		// Render grid over every step-th sample of a tile, in world space
+		void BuildRenderGrid(const TerrainTile& tile, int step, DX::MeshData* mesh_data) const;
+
+		inline const std::map<TerrainTileKey, std::unique_ptr<TerrainTile>>& GetTiles() const { return m_Tiles; }
+		inline const TerrainDesc& GetDesc() const { return m_Desc; }
+		inline physx::PxReal GetTileSize() const { return static_cast<physx::PxReal>(m_Desc.tileSamples - 1) * m_Desc.sampleSpacing; }
+		TerrainTileKey GetTileKey(const physx::PxVec3& position) const;
+		TerrainStats GetStats() const;
+
+	private:
+		Physics& m_Physics;
+		TerrainDesc m_Desc;
+		physx::PxMaterial* m_Material = nullptr;
+
+		// Owned by the calling thread
+		std::map<TerrainTileKey, std::unique_ptr<TerrainTile>> m_Tiles;
+		TerrainTileKey m_Focus = TerrainTileKey(0, 0);
+		std::uint64_t m_Loads = 0;
+		std::uint64_t m_Evictions = 0;
+
+		// Shared with the streaming thread
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		std::condition_variable m_Idle;
+		std::deque<TerrainTileKey> m_Requests;
+		std::vector<TerrainTileKey> m_Queued;
+		std::vector<std::unique_ptr<TerrainTile>> m_Cooked;
+		int m_InFlight = 0;
+		bool m_Stop = false;
+		std::thread m_Thread;
+
+		void StreamTiles();
+		std::unique_ptr<TerrainTile> CookTile(const TerrainTileKey& key);
+		physx::PxShape* CreateHeightFieldShape(const TerrainTile& tile, physx::PxDefaultMemoryOutputStream& stream);
+		physx::PxShape* CreateTriangleMeshShape(const TerrainTile& tile, physx::PxDefaultMemoryOutputStream& stream);
+		void ReleaseTile(TerrainTile& tile);
+		bool IsWithin(const TerrainTileKey& key, int radius) const;
+	};
+}
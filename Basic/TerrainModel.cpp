@@ -0,0 +1,99 @@
+#include "TerrainModel.h"
+#include <algorithm>
+#include <cstdlib>
+
+DX::TerrainModel::TerrainModel(DX::Renderer* renderer, PX::Physics* physics) : m_DxRenderer(renderer), m_Physics(physics)
+{
+	Colour = DirectX::XMFLOAT4(0.45f, 0.6f, 0.35f, 1.0f);
+}
+
+void DX::TerrainModel::Create(const PX::TerrainDesc& desc)
+{
+	m_Terrain = std::make_unique<PX::Terrain>(*m_Physics, desc);
+
+	// The tiles around the origin are cooked up front so the first bodies have something to land on
+	m_Terrain->SetFocus(physx::PxVec3(0.0f, 0.0f, 0.0f));
+	m_Terrain->Flush();
+	Update(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+}
+
+void DX::TerrainModel::Update(const DirectX::XMFLOAT3& focus)
+{
+	m_Terrain->SetFocus(physx::PxVec3(focus.x, focus.y, focus.z));
+	m_Terrain->Update();
+
+	const auto& tiles = m_Terrain->GetTiles();
+	PX::TerrainTileKey centre = m_Terrain->GetTileKey(physx::PxVec3(focus.x, focus.y, focus.z));
+
+	// Grids of evicted tiles go with them
+	for (auto it = m_Grids.begin(); it != m_Grids.end();)
+	{
+		it = tiles.find(it->first) == tiles.end() ? m_Grids.erase(it) : std::next(it);
+	}
+
+	// Full resolution on the focus tile, halved for each ring after it
+	for (const auto& entry : tiles)
+	{
+		int distance = std::max(std::abs(entry.first.first - centre.first), std::abs(entry.first.second - centre.second));
+		int step = 1 << std::min(distance, 3);
+
+		TileGrid& grid = m_Grids[entry.first];
+		if (grid.step != step)
+		{
+			CreateGrid(*entry.second, step, grid);
+		}
+	}
+}
+
+void DX::TerrainModel::CreateGrid(const PX::TerrainTile& tile, int step, TileGrid& grid)
+{
+	MeshData mesh_data;
+	m_Terrain->BuildRenderGrid(tile, step, &mesh_data);
+
+	auto d3dDevice = m_DxRenderer->GetDevice();
+
+	// Create vertex buffer
+	D3D11_BUFFER_DESC vertex_buffer_desc = {};
+	vertex_buffer_desc.Usage = D3D11_USAGE_DEFAULT;
+	vertex_buffer_desc.ByteWidth = static_cast<UINT>(sizeof(Vertex) * mesh_data.vertices.size());
+	vertex_buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA vertex_subdata = {};
+	vertex_subdata.pSysMem = mesh_data.vertices.data();
+
+	DX::Check(d3dDevice->CreateBuffer(&vertex_buffer_desc, &vertex_subdata, grid.vertexBuffer.ReleaseAndGetAddressOf()));
+
+	// Create index buffer
+	D3D11_BUFFER_DESC index_buffer_desc = {};
+	index_buffer_desc.Usage = D3D11_USAGE_DEFAULT;
+	index_buffer_desc.ByteWidth = static_cast<UINT>(sizeof(UINT) * mesh_data.indices.size());
+	index_buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA index_subdata = {};
+	index_subdata.pSysMem = mesh_data.indices.data();
+
+	DX::Check(d3dDevice->CreateBuffer(&index_buffer_desc, &index_subdata, grid.indexBuffer.ReleaseAndGetAddressOf()));
+
+	grid.indexCount = static_cast<UINT>(mesh_data.indices.size());
+	grid.step = step;
+}
+
+void DX::TerrainModel::Render()
+{
+	auto d3dDeviceContext = m_DxRenderer->GetDeviceContext();
+
+	// We need the stride and offset for the vertex
+	UINT vertex_stride = sizeof(Vertex);
+	auto vertex_offset = 0u;
+
+	// Bind the geometry topology to the Input Assembler
+	d3dDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	for (const auto& entry : m_Grids)
+	{
+		const TileGrid& grid = entry.second;
+		d3dDeviceContext->IASetVertexBuffers(0, 1, grid.vertexBuffer.GetAddressOf(), &vertex_stride, &vertex_offset);
+		d3dDeviceContext->IASetIndexBuffer(grid.indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		d3dDeviceContext->DrawIndexed(grid.indexCount, 0, 0);
+	}
+}
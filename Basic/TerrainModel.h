@@ -0,0 +1,55 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include "DxRenderer.h"
+#include <DirectXMath.h>
+#include "Vertex.h"
+#include "Physics.h"
+#include "Terrain.h"
+
+namespace DX
+{
+	class TerrainModel
+	{
+	public:
+		TerrainModel(DX::Renderer* renderer, PX::Physics* physics);
+		virtual ~TerrainModel() = default;
+
+		// Create device
+		void Create(const PX::TerrainDesc& desc = PX::TerrainDesc());
+
+		// Stream tiles around focus and rebuild the grids whose level of detail changed, call while the scene isn't simulating
+		void Update(const DirectX::XMFLOAT3& focus);
+
+		// Render the model
+		void Render();
+
+		// World, the grids are already in world space
+		DirectX::XMMATRIX World = DirectX::XMMatrixIdentity();
+
+		// Colour
+		DirectX::XMFLOAT4 Colour = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+
+		inline PX::Terrain* GetTerrain() { return m_Terrain.get(); }
+
+	private:
+		DX::Renderer* m_DxRenderer = nullptr;
+
+		// One grid per loaded tile, step is how many samples each grid cell spans
+		struct TileGrid
+		{
+			ComPtr<ID3D11Buffer> vertexBuffer = nullptr;
+			ComPtr<ID3D11Buffer> indexBuffer = nullptr;
+			UINT indexCount = 0;
+			int step = 0;
+		};
+
+		std::map<PX::TerrainTileKey, TileGrid> m_Grids;
+		void CreateGrid(const PX::TerrainTile& tile, int step, TileGrid& grid);
+
+		// Physics
+		PX::Physics* m_Physics = nullptr;
+		std::unique_ptr<PX::Terrain> m_Terrain = nullptr;
+	};
+}
@@ -0,0 +1,150 @@
+#include "TransformBatch.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PX_TRANSFORM_BATCH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+void PX::PoseToMatrices(const physx::PxTransform& pose, ShaderMatrix& world, ShaderMatrix& normal)
+{
+	const physx::PxQuat& q = pose.q;
+	float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+	float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+	float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+	float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+	// Rows are the rotated axes, as XMMatrixRotationQuaternion lays them out
+	float r[3][3] =
+	{
+		{ 1.0f - (yy + zz), xy + wz, xz - wy },
+		{ xy - wz, 1.0f - (xx + zz), yz + wx },
+		{ xz + wy, yz - wx, 1.0f - (xx + yy) }
+	};
+
+	const float p[3] = { pose.p.x, pose.p.y, pose.p.z };
+
+	for (int i = 0; i < 3; ++i)
+	{
+		world.m[i][0] = r[0][i];
+		world.m[i][1] = r[1][i];
+		world.m[i][2] = r[2][i];
+		world.m[i][3] = p[i];
+
+		normal.m[i][0] = r[i][0];
+		normal.m[i][1] = r[i][1];
+		normal.m[i][2] = r[i][2];
+		normal.m[i][3] = -(p[0] * r[i][0] + p[1] * r[i][1] + p[2] * r[i][2]);
+	}
+
+	world.m[3][0] = world.m[3][1] = world.m[3][2] = 0.0f;
+	world.m[3][3] = 1.0f;
+	normal.m[3][0] = normal.m[3][1] = normal.m[3][2] = 0.0f;
+	normal.m[3][3] = 1.0f;
+}
+
+void PX::PosesToMatrices(const physx::PxTransform* poses, size_t count, ShaderMatrix* world, ShaderMatrix* normal)
+{
+	size_t i = 0;
+
+#ifdef PX_TRANSFORM_BATCH_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 last_row = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const physx::PxTransform* t = poses + i;
+
+		// Gathered from the PxTransform array into one register per component
+		__m128 qx = _mm_setr_ps(t[0].q.x, t[1].q.x, t[2].q.x, t[3].q.x);
+		__m128 qy = _mm_setr_ps(t[0].q.y, t[1].q.y, t[2].q.y, t[3].q.y);
+		__m128 qz = _mm_setr_ps(t[0].q.z, t[1].q.z, t[2].q.z, t[3].q.z);
+		__m128 qw = _mm_setr_ps(t[0].q.w, t[1].q.w, t[2].q.w, t[3].q.w);
+		__m128 px = _mm_setr_ps(t[0].p.x, t[1].p.x, t[2].p.x, t[3].p.x);
+		__m128 py = _mm_setr_ps(t[0].p.y, t[1].p.y, t[2].p.y, t[3].p.y);
+		__m128 pz = _mm_setr_ps(t[0].p.z, t[1].p.z, t[2].p.z, t[3].p.z);
+
+		__m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+		__m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+		__m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+		__m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+
+		__m128 r00 = _mm_sub_ps(one, _mm_add_ps(yy, zz)), r01 = _mm_add_ps(xy, wz), r02 = _mm_sub_ps(xz, wy);
+		__m128 r10 = _mm_sub_ps(xy, wz), r11 = _mm_sub_ps(one, _mm_add_ps(xx, zz)), r12 = _mm_add_ps(yz, wx);
+		__m128 r20 = _mm_add_ps(xz, wy), r21 = _mm_sub_ps(yz, wx), r22 = _mm_sub_ps(one, _mm_add_ps(xx, yy));
+
+		// Minus the translation dotted with each rotated axis
+		__m128 t0 = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r00), _mm_mul_ps(py, r01)), _mm_mul_ps(pz, r02)));
+		__m128 t1 = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r10), _mm_mul_ps(py, r11)), _mm_mul_ps(pz, r12)));
+		__m128 t2 = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, r20), _mm_mul_ps(py, r21)), _mm_mul_ps(pz, r22)));
+
+		// Each transpose turns one row across the four lanes into that row of each of the four matrices
+		__m128 a = r00, b = r10, c = r20, d = px;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(world[i].m[0], a);
+		_mm_store_ps(world[i + 1].m[0], b);
+		_mm_store_ps(world[i + 2].m[0], c);
+		_mm_store_ps(world[i + 3].m[0], d);
+
+		a = r01, b = r11, c = r21, d = py;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(world[i].m[1], a);
+		_mm_store_ps(world[i + 1].m[1], b);
+		_mm_store_ps(world[i + 2].m[1], c);
+		_mm_store_ps(world[i + 3].m[1], d);
+
+		a = r02, b = r12, c = r22, d = pz;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(world[i].m[2], a);
+		_mm_store_ps(world[i + 1].m[2], b);
+		_mm_store_ps(world[i + 2].m[2], c);
+		_mm_store_ps(world[i + 3].m[2], d);
+
+		a = r00, b = r01, c = r02, d = t0;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(normal[i].m[0], a);
+		_mm_store_ps(normal[i + 1].m[0], b);
+		_mm_store_ps(normal[i + 2].m[0], c);
+		_mm_store_ps(normal[i + 3].m[0], d);
+
+		a = r10, b = r11, c = r12, d = t1;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(normal[i].m[1], a);
+		_mm_store_ps(normal[i + 1].m[1], b);
+		_mm_store_ps(normal[i + 2].m[1], c);
+		_mm_store_ps(normal[i + 3].m[1], d);
+
+		a = r20, b = r21, c = r22, d = t2;
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_store_ps(normal[i].m[2], a);
+		_mm_store_ps(normal[i + 1].m[2], b);
+		_mm_store_ps(normal[i + 2].m[2], c);
+		_mm_store_ps(normal[i + 3].m[2], d);
+
+		for (size_t j = 0; j < 4; ++j)
+		{
+			_mm_store_ps(world[i + j].m[3], last_row);
+			_mm_store_ps(normal[i + j].m[3], last_row);
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		PoseToMatrices(poses[i], world[i], normal[i]);
+	}
+}
+
+void PX::PosesToMatrices(JobSystem& jobs, const physx::PxTransform* poses, size_t count, ShaderMatrix* world, ShaderMatrix* normal, size_t grain_size)
+{
+	// Too few to be worth waking the workers for
+	if (count <= grain_size)
+	{
+		PosesToMatrices(poses, count, world, normal);
+		return;
+	}
+
+	jobs.ParallelFor(count, grain_size, [=](size_t begin, size_t end)
+	{
+		PosesToMatrices(poses + begin, end - begin, world + begin, normal + begin);
+	});
+}
@@ -1,5 +1,8 @@
 #include "Application.h"
+#include <cstdlib>
+#include <iostream>
 #include <memory>
+#include <string>
 
 // SDL is needed to handle our main function
 #include <SDL.h>
@@ -15,5 +18,38 @@ int main(int argc, char** argv)
 #endif
 
 	auto application = std::make_unique<Applicataion>();
+
+	// PVD is off unless asked for, --pvd socket|file [--pvd-flags debug,profile,memory]
+	// --terrain streams height field tiles around the box instead of the flat plane
+	// --debris n fires n pooled boxes a second out of the body
+	PX::PvdDesc pvd_desc;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		bool valid = false;
+		if (arg == "--terrain")
+		{
+			application->SetUseTerrain(true);
+			valid = true;
+		}
+		else if (arg == "--debris" && has_value)
+		{
+			int rate = std::atoi(argv[++i]);
+			application->SetDebrisRate(rate > 0 ? rate : 0);
+			valid = true;
+		}
+		else if (arg == "--pvd" && has_value)
+			valid = PX::ParsePvdTransport(argv[++i], pvd_desc.transport);
+		else if (arg == "--pvd-flags" && has_value)
+			valid = PX::ParsePvdFlags(argv[++i], pvd_desc.flags);
+
+		if (!valid)
+		{
+			std::cout << "Ignoring " << arg << '\n';
+		}
+	}
+
+	application->SetPvdDesc(pvd_desc);
 	return application->Execute();
 }
\ No newline at end of file
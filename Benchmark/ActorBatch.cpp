@@ -0,0 +1,137 @@
+#include "ActorBatch.h"
+#include <chrono>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+}
+
+PX::ActorBatch::ActorBatch(Physics& physics, const ActorBatchDesc& desc) : m_Physics(physics), m_Desc(desc)
+{
+}
+
+void PX::ActorBatch::Reserve(size_t count)
+{
+	m_Entries.reserve(count);
+}
+
+void PX::ActorBatch::AddStatic(const physx::PxTransform& pose, physx::PxShape& shape)
+{
+	Entry entry;
+	entry.pose = pose;
+	entry.shape = &shape;
+	entry.isStatic = true;
+	m_Entries.push_back(entry);
+}
+
+void PX::ActorBatch::AddDynamic(const physx::PxTransform& pose, physx::PxShape& shape, physx::PxReal density, const physx::PxVec3& linear_velocity)
+{
+	Entry entry;
+	entry.pose = pose;
+	entry.shape = &shape;
+	entry.density = density;
+	entry.linearVelocity = linear_velocity;
+	m_Entries.push_back(entry);
+}
+
+physx::PxRigidActor* PX::ActorBatch::Build(const Entry& entry)
+{
+	physx::PxPhysics* physics = m_Physics.GetPhysics();
+
+	if (entry.isStatic)
+	{
+		physx::PxRigidStatic* actor = physics->createRigidStatic(entry.pose);
+		actor->attachShape(*entry.shape);
+		return actor;
+	}
+
+	physx::PxRigidDynamic* actor = physics->createRigidDynamic(entry.pose);
+	actor->attachShape(*entry.shape);
+	physx::PxRigidBodyExt::updateMassAndInertia(*actor, entry.density);
+	actor->setLinearVelocity(entry.linearVelocity);
+	return actor;
+}
+
+const std::vector<physx::PxRigidActor*>& PX::ActorBatch::Spawn()
+{
+	m_Stats = ActorBatchStats();
+	m_Actors.assign(m_Entries.size(), nullptr);
+
+	auto start = Clock::now();
+
+	// Every entry writes its own slot, and a shared shape's reference count is atomic
+	if (m_Desc.parallel && m_Physics.GetJobSystem() != nullptr)
+	{
+		m_Physics.GetJobSystem()->ParallelFor(m_Entries.size(), m_Desc.grainSize, [this](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				m_Actors[i] = Build(m_Entries[i]);
+			}
+		});
+	}
+	else
+	{
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+		{
+			m_Actors[i] = Build(m_Entries[i]);
+		}
+	}
+
+	m_Stats.buildMs = ElapsedMs(start);
+
+	std::vector<physx::PxActor*> statics;
+	std::vector<physx::PxActor*> dynamics;
+	for (size_t i = 0; i < m_Entries.size(); ++i)
+	{
+		(m_Entries[i].isStatic ? statics : dynamics).push_back(m_Actors[i]);
+	}
+
+	m_Stats.statics = statics.size();
+	m_Stats.dynamics = dynamics.size();
+
+	physx::PxScene* scene = m_Physics.GetScene();
+
+	// The statics' scene query tree is built here, off the scene, so adding it is a merge instead of an insert per shape
+	physx::PxPruningStructure* pruning_structure = nullptr;
+	if (m_Desc.pruningStructure && !statics.empty())
+	{
+		auto pruning_start = Clock::now();
+		std::vector<physx::PxRigidActor*> rigid_statics;
+		rigid_statics.reserve(statics.size());
+		for (physx::PxActor* actor : statics)
+		{
+			rigid_statics.push_back(static_cast<physx::PxRigidActor*>(actor));
+		}
+
+		pruning_structure = m_Physics.GetPhysics()->createPruningStructure(rigid_statics.data(), static_cast<physx::PxU32>(rigid_statics.size()));
+		m_Stats.pruningMs = ElapsedMs(pruning_start);
+	}
+
+	auto insert_start = Clock::now();
+	if (pruning_structure != nullptr)
+	{
+		scene->addActors(*pruning_structure);
+		pruning_structure->release();
+	}
+	else
+	{
+		dynamics.insert(dynamics.end(), statics.begin(), statics.end());
+	}
+
+	if (!dynamics.empty())
+	{
+		scene->addActors(dynamics.data(), static_cast<physx::PxU32>(dynamics.size()));
+	}
+
+	m_Stats.insertMs = ElapsedMs(insert_start);
+	m_Stats.totalMs = ElapsedMs(start);
+
+	m_Entries.clear();
+	return m_Actors;
+}
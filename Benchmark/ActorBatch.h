@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+
+namespace PX
+{
+	struct ActorBatchDesc
+	{
+		// Build the actors across the job system, bodies per job
+		bool parallel = true;
+		size_t grainSize = 256;
+
+		// Hand the statics to the scene as one pre-built PxPruningStructure instead of inserting them one by one
+		bool pruningStructure = true;
+	};
+
+	struct ActorBatchStats
+	{
+		size_t statics = 0;
+		size_t dynamics = 0;
+
+		// Creating the actors, building the pruning structure and the addActors calls
+		double buildMs = 0.0;
+		double pruningMs = 0.0;
+		double insertMs = 0.0;
+		double totalMs = 0.0;
+	};
+
+	// Collects actors for a level load and spawns them together. Creation runs on the workers, PhysX object creation is
+	// thread safe, then everything goes into the scene in one addActors call rather than an addActor per model.
+	// Call Spawn while the scene isn't simulating
+	class ActorBatch
+	{
+	public:
+		ActorBatch(Physics& physics, const ActorBatchDesc& desc = ActorBatchDesc());
+
+		void Reserve(size_t count);
+
+		// The shape is shared, attach it to as many actors as you like
+		void AddStatic(const physx::PxTransform& pose, physx::PxShape& shape);
+		void AddDynamic(const physx::PxTransform& pose, physx::PxShape& shape, physx::PxReal density, const physx::PxVec3& linear_velocity = physx::PxVec3(0.0f));
+
+		// Builds and inserts everything added since the last call, the actors come back in the order they were added
+		const std::vector<physx::PxRigidActor*>& Spawn();
+
+		inline size_t GetCount() const { return m_Entries.size(); }
+		inline const ActorBatchStats& GetStats() const { return m_Stats; }
+
+	private:
+		struct Entry
+		{
+			physx::PxTransform pose;
+			physx::PxShape* shape = nullptr;
+			physx::PxReal density = 0.0f;
+			physx::PxVec3 linearVelocity = physx::PxVec3(0.0f);
+			bool isStatic = false;
+		};
+
+		Physics& m_Physics;
+		ActorBatchDesc m_Desc;
+		ActorBatchStats m_Stats;
+
+		std::vector<Entry> m_Entries;
+		std::vector<physx::PxRigidActor*> m_Actors;
+
+		physx::PxRigidActor* Build(const Entry& entry);
+	};
+}
@@ -0,0 +1,203 @@
+#include "ConvexDecomposition.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	using Polygon = std::vector<physx::PxVec3>;
+
+	struct Piece
+	{
+		std::vector<Polygon> polygons;
+		physx::PxBounds3 bounds = physx::PxBounds3::empty();
+	};
+
+	void UpdateBounds(Piece& piece)
+	{
+		piece.bounds = physx::PxBounds3::empty();
+		for (const Polygon& polygon : piece.polygons)
+		{
+			for (const physx::PxVec3& point : polygon)
+			{
+				piece.bounds.include(point);
+			}
+		}
+	}
+
+	// Sutherland-Hodgman against one side of an axis aligned plane, the points on the plane become the cut face of the hull
+	Polygon Clip(const Polygon& polygon, int axis, physx::PxReal value, bool keep_below)
+	{
+		Polygon result;
+		for (size_t i = 0; i < polygon.size(); ++i)
+		{
+			const physx::PxVec3& a = polygon[i];
+			const physx::PxVec3& b = polygon[(i + 1) % polygon.size()];
+
+			physx::PxReal da = keep_below ? value - a[axis] : a[axis] - value;
+			physx::PxReal db = keep_below ? value - b[axis] : b[axis] - value;
+
+			if (da >= 0.0f)
+			{
+				result.push_back(a);
+			}
+
+			if ((da >= 0.0f) != (db >= 0.0f))
+			{
+				physx::PxReal t = da / (da - db);
+				result.push_back(a + (b - a) * t);
+			}
+		}
+
+		return result;
+	}
+
+	void Split(const Piece& piece, int axis, physx::PxReal value, Piece& below, Piece& above)
+	{
+		for (const Polygon& polygon : piece.polygons)
+		{
+			Polygon lower = Clip(polygon, axis, value, true);
+			if (lower.size() >= 3)
+			{
+				below.polygons.push_back(std::move(lower));
+			}
+
+			Polygon upper = Clip(polygon, axis, value, false);
+			if (upper.size() >= 3)
+			{
+				above.polygons.push_back(std::move(upper));
+			}
+		}
+
+		UpdateBounds(below);
+		UpdateBounds(above);
+	}
+
+	physx::PxReal Volume(const physx::PxBounds3& bounds)
+	{
+		physx::PxVec3 extents = bounds.getDimensions();
+		return extents.x * extents.y * extents.z;
+	}
+}
+
+void PX::ConvexCompound::Release()
+{
+	for (physx::PxConvexMesh* hull : hulls)
+	{
+		hull->release();
+	}
+
+	hulls.clear();
+}
+
+PX::ConvexDecomposer::ConvexDecomposer(Physics& physics) : m_Physics(physics)
+{
+}
+
+PX::ConvexCompound PX::ConvexDecomposer::Decompose(const DX::MeshData& mesh, const ConvexDecompositionDesc& desc)
+{
+	ConvexCompound compound;
+	auto start = std::chrono::steady_clock::now();
+
+	Piece whole;
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		Polygon triangle;
+		for (size_t j = 0; j < 3; ++j)
+		{
+			const DX::Vertex& vertex = mesh.vertices[mesh.indices[i + j]];
+			triangle.push_back(physx::PxVec3(vertex.x, vertex.y, vertex.z));
+		}
+
+		whole.polygons.push_back(std::move(triangle));
+	}
+
+	UpdateBounds(whole);
+
+	// Halve the biggest piece across its longest side until there are enough pieces or none is worth cutting
+	std::vector<Piece> pieces;
+	pieces.push_back(std::move(whole));
+	while (pieces.size() < desc.maxHulls)
+	{
+		size_t biggest = pieces.size();
+		for (size_t i = 0; i < pieces.size(); ++i)
+		{
+			physx::PxVec3 extents = pieces[i].bounds.getDimensions();
+			if (extents.maxElement() <= desc.minExtent)
+			{
+				continue;
+			}
+
+			if (biggest == pieces.size() || Volume(pieces[i].bounds) > Volume(pieces[biggest].bounds))
+			{
+				biggest = i;
+			}
+		}
+
+		if (biggest == pieces.size())
+		{
+			break;
+		}
+
+		physx::PxVec3 extents = pieces[biggest].bounds.getDimensions();
+		int axis = extents.x >= extents.y && extents.x >= extents.z ? 0 : (extents.y >= extents.z ? 1 : 2);
+		physx::PxReal value = pieces[biggest].bounds.getCenter()[axis];
+
+		Piece below;
+		Piece above;
+		Split(pieces[biggest], axis, value, below, above);
+
+		pieces[biggest] = std::move(below);
+		pieces.push_back(std::move(above));
+	}
+
+	compound.decomposeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Hulls cook independently, so they spread across the workers
+	auto cook_start = std::chrono::steady_clock::now();
+	std::vector<physx::PxConvexMesh*> hulls(pieces.size(), nullptr);
+	physx::PxPhysics* physics = m_Physics.GetPhysics();
+
+	m_Physics.GetJobSystem()->ParallelFor(pieces.size(), 1, [&](size_t begin, size_t end)
+	{
+		physx::PxTolerancesScale scale;
+		physx::PxCookingParams params(scale);
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			std::vector<physx::PxVec3> points;
+			for (const Polygon& polygon : pieces[i].polygons)
+			{
+				points.insert(points.end(), polygon.begin(), polygon.end());
+			}
+
+			physx::PxConvexMeshDesc convex_desc;
+			convex_desc.points.count = static_cast<physx::PxU32>(points.size());
+			convex_desc.points.stride = sizeof(physx::PxVec3);
+			convex_desc.points.data = points.data();
+			convex_desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+			convex_desc.vertexLimit = std::max<physx::PxU16>(8, desc.vertexLimit);
+
+			// A flat sliver has no volume and won't cook, it's dropped
+			hulls[i] = PxCreateConvexMesh(params, convex_desc, physics->getPhysicsInsertionCallback());
+		}
+	});
+
+	for (physx::PxConvexMesh* hull : hulls)
+	{
+		if (hull != nullptr)
+		{
+			compound.hulls.push_back(hull);
+		}
+	}
+
+	compound.cookMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cook_start).count();
+	return compound;
+}
+
+void PX::ConvexDecomposer::AttachCompound(physx::PxRigidActor& actor, const ConvexCompound& compound, const physx::PxMaterial& material)
+{
+	for (physx::PxConvexMesh* hull : compound.hulls)
+	{
+		physx::PxRigidActorExt::createExclusiveShape(actor, physx::PxConvexMeshGeometry(hull), material);
+	}
+}
@@ -0,0 +1,99 @@
+#include "Cooking.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include "CookingService.h"
+#include "GeometryGenerator.h"
+#include "Physics.h"
+
+Benchmark::CookingResult Benchmark::RunCooking(const CookingOptions& options)
+{
+	CookingResult result;
+	result.meshes = options.meshes;
+	result.convex = options.convex;
+	result.directInsertion = options.directInsertion;
+
+	PX::JobSystemDesc job_desc;
+	job_desc.workerCount = options.threads;
+
+	PX::Physics physics;
+	physics.SetJobSystemDesc(job_desc);
+	physics.Setup();
+	result.threads = physics.GetJobSystem()->getWorkerCount();
+
+	std::vector<PX::CookJob> jobs(static_cast<size_t>(options.meshes));
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		float scale = 1.0f + 0.001f * static_cast<float>(i);
+		GeometryGenerator::CreatePyramid(scale, scale * 0.5f, scale * 0.75f, &jobs[i].mesh);
+
+		jobs[i].type = options.convex ? PX::CookType::ConvexMesh : PX::CookType::TriangleMesh;
+		jobs[i].directInsertion = options.directInsertion;
+		jobs[i].params.meshWeldTolerance = 0.001f;
+		jobs[i].params.meshPreprocessParams = physx::PxMeshPreprocessingFlags(physx::PxMeshPreprocessingFlag::eWELD_VERTICES);
+	}
+
+	// Created meshes are released as they arrive, only the cooking is being measured
+	auto start = std::chrono::steady_clock::now();
+	{
+		PX::CookingService service(*physics.GetPhysics(), *physics.GetJobSystem());
+		std::vector<std::future<PX::CookResult>> futures = service.CookBatch(std::move(jobs));
+
+		for (std::future<PX::CookResult>& future : futures)
+		{
+			PX::CookResult cooked = future.get();
+			if (cooked.triangleMesh != nullptr) cooked.triangleMesh->release();
+			if (cooked.convexMesh != nullptr) cooked.convexMesh->release();
+		}
+
+		PX::CookingStats stats = service.GetStats();
+		result.failed = static_cast<int>(stats.failed);
+		result.summedJobMs = stats.cookMs;
+	}
+
+	result.batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (result.batchMs > 0.0)
+	{
+		result.meshesPerSecond = static_cast<double>(result.meshes) * 1000.0 / result.batchMs;
+	}
+
+	return result;
+}
+
+void Benchmark::PrintCooking(std::ostream& stream, const std::vector<CookingResult>& results)
+{
+	stream << std::left << std::setw(10) << "Type" << std::right
+		<< std::setw(8) << "Meshes"
+		<< std::setw(8) << "Threads"
+		<< std::setw(8) << "Direct"
+		<< std::setw(8) << "Failed"
+		<< std::setw(12) << "Batch ms"
+		<< std::setw(12) << "Job ms"
+		<< std::setw(12) << "Meshes/s"
+		<< std::setw(10) << "Speedup" << '\n';
+
+	for (const CookingResult& result : results)
+	{
+		// Baseline is the fewest threads with the same kind of batch
+		double baseline_ms = result.batchMs;
+		unsigned int baseline_threads = result.threads;
+		for (const CookingResult& other : results)
+		{
+			if (other.convex == result.convex && other.directInsertion == result.directInsertion && other.meshes == result.meshes && other.threads < baseline_threads)
+			{
+				baseline_threads = other.threads;
+				baseline_ms = other.batchMs;
+			}
+		}
+
+		stream << std::left << std::setw(10) << (result.convex ? "convex" : "trimesh") << std::right << std::fixed
+			<< std::setw(8) << result.meshes
+			<< std::setw(8) << result.threads
+			<< std::setw(8) << (result.directInsertion ? "yes" : "no")
+			<< std::setw(8) << result.failed
+			<< std::setprecision(2) << std::setw(12) << result.batchMs
+			<< std::setw(12) << result.summedJobMs
+			<< std::setprecision(1) << std::setw(12) << result.meshesPerSecond
+			<< std::setprecision(2) << std::setw(9) << (result.batchMs > 0.0 ? baseline_ms / result.batchMs : 0.0) << 'x' << '\n';
+	}
+}
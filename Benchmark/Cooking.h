@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	struct CookingOptions
+	{
+		// Unique meshes per batch, each a pyramid of slightly different size so none of them can share a cook
+		int meshes = 1000;
+
+		bool convex = false;
+		bool directInsertion = false;
+
+		// Zero sizes the pool from the hardware
+		unsigned int threads = 0;
+	};
+
+	struct CookingResult
+	{
+		int meshes = 0;
+		unsigned int threads = 0;
+		bool convex = false;
+		bool directInsertion = false;
+		int failed = 0;
+
+		// Wall time from submitting the batch to the last future, and the cook time of every job added up
+		double batchMs = 0.0;
+		double summedJobMs = 0.0;
+		double meshesPerSecond = 0.0;
+	};
+
+	// Cooks a batch through PX::CookingService with the mesh cache off, so every mesh is really cooked
+	CookingResult RunCooking(const CookingOptions& options);
+
+	// Speedup is against the run with the fewest threads
+	void PrintCooking(std::ostream& stream, const std::vector<CookingResult>& results);
+}
@@ -0,0 +1,138 @@
+#include "CookingService.h"
+#include <chrono>
+#include <memory>
+
+PX::CookingService::CookingService(physx::PxPhysics& physics, JobSystem& job_system, MeshCache* mesh_cache) : m_Physics(physics), m_JobSystem(job_system), m_MeshCache(mesh_cache)
+{
+}
+
+PX::CookingService::~CookingService()
+{
+	// Jobs still queued hold a pointer to us
+	Wait();
+}
+
+std::future<PX::CookResult> PX::CookingService::Cook(CookJob job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stats.submitted++;
+		m_Pending++;
+	}
+
+	// std::function has to be copyable, so the promise and job live behind shared pointers
+	auto promise = std::make_shared<std::promise<CookResult>>();
+	auto shared_job = std::make_shared<CookJob>(std::move(job));
+	std::future<CookResult> future = promise->get_future();
+
+	m_JobSystem.Submit([this, promise, shared_job]()
+	{
+		CookResult result = Run(*shared_job);
+		promise->set_value(result);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stats.completed++;
+		m_Stats.cookMs += result.cookMs;
+		if (result.triangleMesh == nullptr && result.convexMesh == nullptr)
+		{
+			m_Stats.failed++;
+		}
+
+		if (--m_Pending == 0)
+		{
+			m_Idle.notify_all();
+		}
+	});
+
+	return future;
+}
+
+std::vector<std::future<PX::CookResult>> PX::CookingService::CookBatch(std::vector<CookJob> jobs)
+{
+	std::vector<std::future<CookResult>> futures;
+	futures.reserve(jobs.size());
+
+	for (CookJob& job : jobs)
+	{
+		futures.push_back(Cook(std::move(job)));
+	}
+
+	return futures;
+}
+
+void PX::CookingService::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Idle.wait(lock, [this]() { return m_Pending == 0; });
+}
+
+PX::CookingStats PX::CookingService::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+PX::CookResult PX::CookingService::Run(const CookJob& job)
+{
+	auto start = std::chrono::steady_clock::now();
+	CookResult result;
+
+	physx::PxBoundedData points;
+	points.count = static_cast<physx::PxU32>(job.mesh.vertices.size());
+	points.stride = sizeof(DX::Vertex);
+	points.data = job.mesh.vertices.data();
+
+	if (job.type == CookType::ConvexMesh)
+	{
+		physx::PxConvexMeshDesc desc;
+		desc.points = points;
+		desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+
+		if (job.directInsertion)
+		{
+			result.convexMesh = PxCreateConvexMesh(job.params, desc, m_Physics.getPhysicsInsertionCallback());
+		}
+		else
+		{
+			physx::PxDefaultMemoryOutputStream output;
+			if (PxCookConvexMesh(job.params, desc, output))
+			{
+				MappedInputData input(output.getData(), output.getSize());
+				result.convexMesh = m_Physics.createConvexMesh(input);
+			}
+		}
+	}
+	else
+	{
+		// A copy, PhysX writes its results into the SDF desc while cooking
+		physx::PxSDFDesc sdf_desc = job.sdfDesc;
+
+		physx::PxTriangleMeshDesc desc;
+		desc.points = points;
+		desc.triangles.count = static_cast<physx::PxU32>(job.mesh.indices.size() / 3);
+		desc.triangles.stride = 3 * sizeof(UINT);
+		desc.triangles.data = job.mesh.indices.data();
+		desc.sdfDesc = job.sdf ? &sdf_desc : nullptr;
+
+		if (job.directInsertion)
+		{
+			result.triangleMesh = PxCreateTriangleMesh(job.params, desc, m_Physics.getPhysicsInsertionCallback());
+		}
+		else if (m_MeshCache != nullptr)
+		{
+			result.triangleMesh = m_MeshCache->CreateTriangleMesh(m_Physics, job.params, desc);
+		}
+		else
+		{
+			physx::PxDefaultMemoryOutputStream output;
+			if (PxCookTriangleMesh(job.params, desc, output))
+			{
+				MappedInputData input(output.getData(), output.getSize());
+				result.triangleMesh = m_Physics.createTriangleMesh(input);
+			}
+		}
+	}
+
+	result.cookMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "JobSystem.h"
+#include "MeshCache.h"
+#include "Vertex.h"
+
+namespace PX
+{
+	enum class CookType
+	{
+		TriangleMesh,
+		ConvexMesh
+	};
+
+	// One mesh to cook, the job owns its copy of the mesh so the caller can let go of theirs
+	struct CookJob
+	{
+		DX::MeshData mesh;
+		CookType type = CookType::TriangleMesh;
+		physx::PxCookingParams params { physx::PxTolerancesScale() };
+
+		// Triangle meshes only
+		bool sdf = false;
+		physx::PxSDFDesc sdfDesc;
+
+		// Build the mesh in place without a cooked stream, for meshes generated at runtime that are never worth keeping
+		bool directInsertion = false;
+	};
+
+	// Exactly one of the meshes is set, neither when cooking failed
+	struct CookResult
+	{
+		physx::PxTriangleMesh* triangleMesh = nullptr;
+		physx::PxConvexMesh* convexMesh = nullptr;
+		double cookMs = 0.0;
+	};
+
+	struct CookingStats
+	{
+		std::uint64_t submitted = 0;
+		std::uint64_t completed = 0;
+		std::uint64_t failed = 0;
+
+		// Summed over every job, against the wall time of a batch this shows how much ran in parallel
+		double cookMs = 0.0;
+	};
+
+	// Cooks meshes on the job system's workers, triangle meshes go through the mesh cache unless they ask for direct insertion
+	class CookingService
+	{
+	public:
+		CookingService(physx::PxPhysics& physics, JobSystem& job_system, MeshCache* mesh_cache = nullptr);
+		~CookingService();
+
+		CookingService(const CookingService&) = delete;
+		CookingService& operator=(const CookingService&) = delete;
+
+		std::future<CookResult> Cook(CookJob job);
+		std::vector<std::future<CookResult>> CookBatch(std::vector<CookJob> jobs);
+
+		// Blocks until every job submitted so far has finished
+		void Wait();
+
+		CookingStats GetStats() const;
+
+	private:
+		physx::PxPhysics& m_Physics;
+		JobSystem& m_JobSystem;
+		MeshCache* m_MeshCache = nullptr;
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_Idle;
+		CookingStats m_Stats;
+		int m_Pending = 0;
+
+		CookResult Run(const CookJob& job);
+	};
+}
@@ -0,0 +1,225 @@
+#include "EntityBench.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include "ActorBatch.h"
+#include "EntityStore.h"
+#include "GeometryGenerator.h"
+#include "Scenes.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedUs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	}
+
+	// What a DX::DynamicModel keeps per body without its GPU side: the matrix and colour, its own copy of the
+	// mesh and the two buffer pointers. Updated the way DynamicModel::Update builds World
+	class BodyObject
+	{
+	public:
+		BodyObject(PX::Physics& physics, physx::PxRigidActor* body, const DX::MeshData& mesh_data) : m_Physics(physics), m_Body(body), m_MeshData(mesh_data)
+		{
+		}
+
+		virtual ~BodyObject() = default;
+
+		void Update()
+		{
+			physx::PxTransform pose = m_Physics.GetInterpolatedPose(m_Body);
+			m_Position = pose.p;
+
+			// Identity times rotation times translation, each a full 4x4 multiply like the XMMATRIX operators
+			physx::PxMat44 world(physx::PxIdentity);
+			world = world * physx::PxMat44(pose.q);
+			world = physx::PxMat44(physx::PxMat33(physx::PxIdentity), m_Position) * world;
+			m_World = world;
+		}
+
+		size_t GetMemoryBytes() const
+		{
+			return sizeof(BodyObject) + m_MeshData.vertices.capacity() * sizeof(DX::Vertex) + m_MeshData.indices.capacity() * sizeof(UINT);
+		}
+
+	private:
+		PX::Physics& m_Physics;
+		physx::PxRigidActor* m_Body = nullptr;
+
+		physx::PxMat44 m_World = physx::PxMat44(physx::PxIdentity);
+		physx::PxVec4 m_Colour = physx::PxVec4(1.0f, 0.0f, 0.0f, 1.0f);
+		physx::PxVec3 m_Position = physx::PxVec3(0.0f);
+		physx::PxVec3 m_Dimensions = physx::PxVec3(1.0f);
+
+		DX::MeshData m_MeshData;
+		void* m_VertexBuffer = nullptr;
+		void* m_IndexBuffer = nullptr;
+	};
+
+	// A square of boxes stacked a few high above the plane, so the poses are still moving while they're timed
+	void CreateBodies(PX::Physics& physics, int count)
+	{
+		PX::ShapeRegistry& registry = physics.GetShapeRegistry();
+		physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = registry.AcquireShape(physx::PxBoxGeometry(0.5f, 0.5f, 0.5f), *material);
+
+		constexpr int layers = 4;
+		int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count) / layers))));
+
+		PX::ActorBatch batch(physics);
+		batch.Reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			int layer = i / (side * side);
+			int x = i % side;
+			int z = (i / side) % side;
+			physx::PxTransform pose(physx::PxVec3(x * 2.0f - side, 2.0f + layer * 2.0f, z * 2.0f - side));
+			batch.AddDynamic(pose, *shape, 100.0f);
+		}
+
+		batch.Spawn();
+		registry.ReleaseShape(shape);
+		registry.ReleaseMaterial(material);
+	}
+}
+
+const char* Benchmark::GetEntityPathName(EntityPath path)
+{
+	switch (path)
+	{
+	case EntityPath::Objects: return "objects";
+	case EntityPath::Store: return "store";
+	case EntityPath::StoreParallel: return "store-parallel";
+	}
+
+	return "unknown";
+}
+
+std::vector<Benchmark::EntityResult> Benchmark::RunEntities(const EntityOptions& options)
+{
+	std::vector<EntityResult> results;
+
+	for (int count : options.counts)
+	{
+		count = std::max(1, count);
+
+		PX::JobSystemDesc job_desc;
+		job_desc.workerCount = options.threads;
+
+		PX::Physics physics;
+		physics.SetJobSystemDesc(job_desc);
+		physics.Setup();
+		Benchmark::CreatePlane(physics);
+		CreateBodies(physics, count);
+
+		std::vector<physx::PxActor*> actors(physics.GetScene()->getNbActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC));
+		physics.GetScene()->getActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC, actors.data(), static_cast<physx::PxU32>(actors.size()));
+
+		DX::MeshData box_data;
+		GeometryGenerator::CreateBox(1.0f, 1.0f, 1.0f, &box_data);
+
+		// Both designs over the same bodies
+		std::vector<std::unique_ptr<BodyObject>> objects;
+		objects.reserve(actors.size());
+		size_t object_bytes = objects.capacity() * sizeof(std::unique_ptr<BodyObject>);
+
+		PX::EntityStore store;
+		PX::ArchetypeId archetype = store.AddArchetype({ "Box", true });
+		store.Reserve(archetype, actors.size());
+
+		for (physx::PxActor* actor : actors)
+		{
+			physx::PxRigidActor* body = static_cast<physx::PxRigidActor*>(actor);
+			objects.push_back(std::make_unique<BodyObject>(physics, body, box_data));
+			object_bytes += objects.back()->GetMemoryBytes();
+			store.Create(archetype, body, 0, physx::PxVec4(1.0f, 0.0f, 0.0f, 1.0f));
+		}
+
+		for (int step = 0; step < options.warmupSteps; ++step)
+		{
+			physics.Simulate(options.stepSize);
+		}
+
+		double objects_us = 0.0;
+		double store_us = 0.0;
+		double parallel_us = 0.0;
+
+		for (int step = 0; step < options.steps; ++step)
+		{
+			physics.Simulate(options.stepSize);
+
+			auto start = Clock::now();
+			for (const std::unique_ptr<BodyObject>& object : objects)
+			{
+				object->Update();
+			}
+			objects_us += ElapsedUs(start);
+
+			// The store only hears about awake bodies through the active actor sync, so each pass pays for it
+			start = Clock::now();
+			physics.SyncActiveActors();
+			store.Update(physics, std::numeric_limits<size_t>::max());
+			store_us += ElapsedUs(start);
+
+			start = Clock::now();
+			physics.SyncActiveActors();
+			store.Update(physics);
+			parallel_us += ElapsedUs(start);
+		}
+
+		double bodies = static_cast<double>(actors.size());
+		double steps = static_cast<double>(std::max(1, options.steps));
+		double store_bytes = static_cast<double>(store.GetMemoryBytes()) / bodies;
+
+		auto add = [&](EntityPath path, double bytes, double total_us)
+		{
+			EntityResult result;
+			result.path = path;
+			result.bodies = static_cast<int>(actors.size());
+			result.bytesPerBody = bytes;
+			result.meanUpdateUs = total_us / steps;
+			result.nsPerBody = result.meanUpdateUs * 1000.0 / bodies;
+			results.push_back(result);
+		};
+
+		add(EntityPath::Objects, static_cast<double>(object_bytes) / bodies, objects_us);
+		add(EntityPath::Store, store_bytes, store_us);
+		add(EntityPath::StoreParallel, store_bytes, parallel_us);
+	}
+
+	return results;
+}
+
+void Benchmark::PrintEntities(std::ostream& stream, const std::vector<EntityResult>& results)
+{
+	stream << std::left << std::setw(16) << "Path" << std::right
+		<< std::setw(10) << "Bodies"
+		<< std::setw(12) << "Bytes/body"
+		<< std::setw(13) << "Update us"
+		<< std::setw(10) << "ns/body"
+		<< std::setw(10) << "Speedup" << '\n';
+
+	for (const EntityResult& result : results)
+	{
+		double baseline = 0.0;
+		for (const EntityResult& other : results)
+		{
+			if (other.path == EntityPath::Objects && other.bodies == result.bodies)
+			{
+				baseline = other.meanUpdateUs;
+			}
+		}
+
+		stream << std::left << std::setw(16) << GetEntityPathName(result.path) << std::right << std::fixed
+			<< std::setw(10) << result.bodies
+			<< std::setprecision(1) << std::setw(12) << result.bytesPerBody
+			<< std::setw(13) << result.meanUpdateUs
+			<< std::setprecision(2) << std::setw(10) << result.nsPerBody
+			<< std::setw(9) << (result.meanUpdateUs > 0.0 ? baseline / result.meanUpdateUs : 0.0) << "x\n";
+	}
+}
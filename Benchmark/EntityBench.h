@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	enum class EntityPath
+	{
+		// A heap object per body holding its matrix, colour, mesh copy and buffers, updated one by one the way
+		// the samples' DynamicModel::Update does
+		Objects,
+
+		// PX::EntityStore fed by Physics::SyncActiveActors, converted on the calling thread and split across the
+		// job system
+		Store,
+		StoreParallel
+	};
+
+	const char* GetEntityPathName(EntityPath path);
+
+	struct EntityOptions
+	{
+		// Bodies in the scene, a list sweeps them
+		std::vector<int> counts = { 1000, 10000, 100000 };
+
+		// Every path updates after each of these steps, so they all read the same poses
+		int steps = 120;
+		int warmupSteps = 10;
+		double stepSize = 1.0 / 60.0;
+
+		unsigned int threads = 0;
+	};
+
+	struct EntityResult
+	{
+		EntityPath path = EntityPath::Objects;
+		int bodies = 0;
+
+		// CPU bytes each body costs its renderer side, the actor itself not counted
+		double bytesPerBody = 0.0;
+
+		double meanUpdateUs = 0.0;
+		double nsPerBody = 0.0;
+	};
+
+	// Every count down every path, the paths share one scene per count
+	std::vector<EntityResult> RunEntities(const EntityOptions& options);
+
+	// Speedup is the object path's update over each path's at the same count
+	void PrintEntities(std::ostream& stream, const std::vector<EntityResult>& results);
+}
@@ -0,0 +1,278 @@
+#include "EntityStore.h"
+#include <algorithm>
+
+PX::ArchetypeId PX::EntityStore::AddArchetype(const ArchetypeDesc& desc)
+{
+	Archetype archetype;
+	archetype.desc = desc;
+	m_Archetypes.push_back(std::move(archetype));
+	return static_cast<ArchetypeId>(m_Archetypes.size() - 1);
+}
+
+void PX::EntityStore::Reserve(ArchetypeId archetype_id, size_t count)
+{
+	Archetype& archetype = m_Archetypes[archetype_id];
+	archetype.poses.reserve(count);
+	archetype.world.reserve(count);
+	archetype.normal.reserve(count);
+	archetype.colours.reserve(count);
+	archetype.meshes.reserve(count);
+	archetype.actors.reserve(count);
+	archetype.slots.reserve(count);
+}
+
+PX::EntityHandle PX::EntityStore::Create(ArchetypeId archetype_id, physx::PxRigidActor* actor, MeshHandle mesh, const physx::PxVec4& colour)
+{
+	Archetype& archetype = m_Archetypes[archetype_id];
+
+	std::uint32_t index = 0;
+	if (!m_FreeSlots.empty())
+	{
+		index = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<std::uint32_t>(m_Slots.size());
+		m_Slots.emplace_back();
+		m_Owners.emplace_back(*this, index);
+	}
+
+	Slot& slot = m_Slots[index];
+	slot.archetype = archetype_id;
+	slot.dense = static_cast<std::uint32_t>(archetype.actors.size());
+	slot.alive = true;
+
+	physx::PxTransform pose = actor->getGlobalPose();
+	archetype.poses.push_back(pose);
+	archetype.world.emplace_back();
+	archetype.normal.emplace_back();
+	PoseToMatrices(pose, archetype.world.back(), archetype.normal.back());
+	archetype.colours.push_back(colour);
+	archetype.meshes.push_back(mesh);
+	archetype.actors.push_back(actor);
+	archetype.slots.push_back(index);
+
+	if (archetype.desc.dynamic)
+	{
+		actor->userData = static_cast<ActorOwner*>(&m_Owners[index]);
+	}
+
+	return { index, slot.generation };
+}
+
+bool PX::EntityStore::Destroy(EntityHandle handle)
+{
+	if (Find(handle) == nullptr)
+	{
+		return false;
+	}
+
+	Slot& slot = m_Slots[handle.index];
+	Archetype& archetype = m_Archetypes[slot.archetype];
+
+	// The actor may go back to a pool and live on, it mustn't keep syncing into a slot that gets reused
+	std::uint32_t dense = slot.dense;
+	if (archetype.actors[dense]->userData == static_cast<ActorOwner*>(&m_Owners[handle.index]))
+	{
+		archetype.actors[dense]->userData = nullptr;
+	}
+
+	// The last entity moves into the hole, its slot follows it
+	std::uint32_t last = static_cast<std::uint32_t>(archetype.actors.size() - 1);
+	if (dense != last)
+	{
+		archetype.poses[dense] = archetype.poses[last];
+		archetype.world[dense] = archetype.world[last];
+		archetype.normal[dense] = archetype.normal[last];
+		archetype.colours[dense] = archetype.colours[last];
+		archetype.meshes[dense] = archetype.meshes[last];
+		archetype.actors[dense] = archetype.actors[last];
+		archetype.slots[dense] = archetype.slots[last];
+		m_Slots[archetype.slots[dense]].dense = dense;
+	}
+
+	archetype.poses.pop_back();
+	archetype.world.pop_back();
+	archetype.normal.pop_back();
+	archetype.colours.pop_back();
+	archetype.meshes.pop_back();
+	archetype.actors.pop_back();
+	archetype.slots.pop_back();
+
+	slot.alive = false;
+	slot.generation++;
+	m_FreeSlots.push_back(handle.index);
+	return true;
+}
+
+bool PX::EntityStore::IsAlive(EntityHandle handle) const
+{
+	return Find(handle) != nullptr;
+}
+
+physx::PxRigidActor* PX::EntityStore::GetActor(EntityHandle handle) const
+{
+	const Slot* slot = Find(handle);
+	return slot != nullptr ? m_Archetypes[slot->archetype].actors[slot->dense] : nullptr;
+}
+
+void PX::EntityStore::SetColour(EntityHandle handle, const physx::PxVec4& colour)
+{
+	if (const Slot* slot = Find(handle))
+	{
+		m_Archetypes[slot->archetype].colours[slot->dense] = colour;
+	}
+}
+
+void PX::EntityStore::Update(Physics& physics, size_t grain_size)
+{
+	// Entities destroyed since they were synced have nothing left to convert
+	m_Synced.erase(std::remove_if(m_Synced.begin(), m_Synced.end(), [this](std::uint32_t slot) { return !m_Slots[slot].alive; }), m_Synced.end());
+
+	size_t count = m_Synced.size();
+	if (count == 0)
+	{
+		return;
+	}
+
+	m_SyncedPoses.resize(count);
+	m_SyncedWorld.resize(count);
+	m_SyncedNormal.resize(count);
+
+	// Each chunk gathers its poses into one run, converts them together and scatters the matrices back
+	auto update = [this](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Slot& slot = m_Slots[m_Synced[i]];
+			m_SyncedPoses[i] = m_Archetypes[slot.archetype].poses[slot.dense];
+		}
+
+		PosesToMatrices(m_SyncedPoses.data() + begin, end - begin, m_SyncedWorld.data() + begin, m_SyncedNormal.data() + begin);
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Slot& slot = m_Slots[m_Synced[i]];
+			Archetype& archetype = m_Archetypes[slot.archetype];
+			archetype.world[slot.dense] = m_SyncedWorld[i];
+			archetype.normal[slot.dense] = m_SyncedNormal[i];
+		}
+	};
+
+	JobSystem* jobs = physics.GetJobSystem();
+	if (jobs != nullptr && count > grain_size)
+	{
+		jobs->ParallelFor(count, grain_size, update);
+	}
+	else
+	{
+		update(0, count);
+	}
+
+	m_Synced.clear();
+}
+
+PX::EntityView PX::EntityStore::GetView(ArchetypeId archetype_id) const
+{
+	const Archetype& archetype = m_Archetypes[archetype_id];
+
+	EntityView view;
+	view.count = archetype.actors.size();
+	view.poses = archetype.poses.data();
+	view.world = archetype.world.data();
+	view.normal = archetype.normal.data();
+	view.colours = archetype.colours.data();
+	view.meshes = archetype.meshes.data();
+	view.actors = archetype.actors.data();
+	return view;
+}
+
+size_t PX::EntityStore::GetCount() const
+{
+	size_t count = 0;
+	for (const Archetype& archetype : m_Archetypes)
+	{
+		count += archetype.actors.size();
+	}
+
+	return count;
+}
+
+size_t PX::EntityStore::GetMemoryBytes() const
+{
+	size_t bytes = m_Slots.capacity() * sizeof(Slot) + m_FreeSlots.capacity() * sizeof(std::uint32_t) + m_Owners.size() * sizeof(SlotOwner)
+		+ m_Synced.capacity() * sizeof(std::uint32_t) + m_SyncedPoses.capacity() * sizeof(physx::PxTransform)
+		+ (m_SyncedWorld.capacity() + m_SyncedNormal.capacity()) * sizeof(ShaderMatrix);
+	for (const Archetype& archetype : m_Archetypes)
+	{
+		bytes += archetype.poses.capacity() * sizeof(physx::PxTransform)
+			+ archetype.world.capacity() * sizeof(ShaderMatrix)
+			+ archetype.normal.capacity() * sizeof(ShaderMatrix)
+			+ archetype.colours.capacity() * sizeof(physx::PxVec4)
+			+ archetype.meshes.capacity() * sizeof(MeshHandle)
+			+ archetype.actors.capacity() * sizeof(physx::PxRigidActor*)
+			+ archetype.slots.capacity() * sizeof(std::uint32_t);
+	}
+
+	return bytes;
+}
+
+void PX::EntityStore::Clear()
+{
+	for (Archetype& archetype : m_Archetypes)
+	{
+		for (std::uint32_t slot : archetype.slots)
+		{
+			if (archetype.actors[m_Slots[slot].dense]->userData == static_cast<ActorOwner*>(&m_Owners[slot]))
+			{
+				archetype.actors[m_Slots[slot].dense]->userData = nullptr;
+			}
+		}
+
+		archetype.poses.clear();
+		archetype.world.clear();
+		archetype.normal.clear();
+		archetype.colours.clear();
+		archetype.meshes.clear();
+		archetype.actors.clear();
+		archetype.slots.clear();
+	}
+
+	// Slots are kept with a new generation so old handles can't find anything
+	m_Synced.clear();
+	m_FreeSlots.clear();
+	for (std::uint32_t i = 0; i < m_Slots.size(); ++i)
+	{
+		if (m_Slots[i].alive)
+		{
+			m_Slots[i].alive = false;
+			m_Slots[i].generation++;
+		}
+
+		m_FreeSlots.push_back(i);
+	}
+}
+
+const PX::EntityStore::Slot* PX::EntityStore::Find(EntityHandle handle) const
+{
+	if (handle.index >= m_Slots.size())
+	{
+		return nullptr;
+	}
+
+	const Slot& slot = m_Slots[handle.index];
+	return slot.alive && slot.generation == handle.generation ? &slot : nullptr;
+}
+
+void PX::EntityStore::Sync(std::uint32_t slot_index, const physx::PxTransform& pose)
+{
+	const Slot& slot = m_Slots[slot_index];
+	if (!slot.alive)
+	{
+		return;
+	}
+
+	m_Archetypes[slot.archetype].poses[slot.dense] = pose;
+	m_Synced.push_back(slot_index);
+}
@@ -0,0 +1,218 @@
+#include "EventsBench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <thread>
+#include "ActorBatch.h"
+#include "Scenes.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// A square of boxes resting on the plane with a gap between each, kept awake so every box and the plane stay
+	// a touching pair every step
+	void CreateBodies(PX::Physics& physics, int count)
+	{
+		PX::ShapeRegistry& registry = physics.GetShapeRegistry();
+		physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = registry.AcquireShape(physx::PxBoxGeometry(0.5f, 0.5f, 0.5f), *material);
+
+		int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))));
+
+		PX::ActorBatch batch(physics);
+		batch.Reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			int x = i % side;
+			int z = i / side;
+			physx::PxTransform pose(physx::PxVec3(x * 1.5f - side * 0.75f, -0.5f, z * 1.5f - side * 0.75f));
+			batch.AddDynamic(pose, *shape, 100.0f);
+		}
+
+		for (physx::PxRigidActor* actor : batch.Spawn())
+		{
+			static_cast<physx::PxRigidDynamic*>(actor)->setSleepThreshold(0.0f);
+		}
+
+		registry.ReleaseShape(shape);
+		registry.ReleaseMaterial(material);
+	}
+
+	PX::SimulationEventDesc GetDesc(Benchmark::EventPath path, const Benchmark::EventOptions& options)
+	{
+		PX::SimulationEventDesc desc;
+		desc.reportContacts = path != Benchmark::EventPath::Off;
+		desc.reportPersists = desc.reportContacts;
+
+		if (path == Benchmark::EventPath::Throttled)
+		{
+			desc.pairThrottleSteps = options.throttleSteps;
+		}
+		else if (path == Benchmark::EventPath::Filtered)
+		{
+			desc.minImpulse = options.minImpulse;
+		}
+
+		return desc;
+	}
+
+	Benchmark::EventResult RunPath(Benchmark::EventPath path, int count, const Benchmark::EventOptions& options)
+	{
+		PX::JobSystemDesc job_desc;
+		job_desc.workerCount = options.threads;
+
+		PX::Physics physics;
+		physics.SetJobSystemDesc(job_desc);
+		physics.SetSimulationEventDesc(GetDesc(path, options));
+		physics.SetParallelCallbacks(path == Benchmark::EventPath::EveryParallel);
+		physics.Setup();
+		Benchmark::CreatePlane(physics);
+		CreateBodies(physics, count);
+
+		PX::SimulationEvents& events = physics.GetSimulationEvents();
+		for (int step = 0; step < options.warmupSteps; ++step)
+		{
+			physics.Simulate(options.stepSize);
+		}
+
+		// Frames published during the warm up are still queued, the consumer takes them but only counts the timed steps
+		PX::SimulationEventStats start_stats = events.GetStats();
+		std::uint64_t first_step = start_stats.steps;
+
+		std::atomic<bool> done{ false };
+		std::atomic<unsigned long long> consumed{ 0 };
+		std::thread consumer([&]()
+		{
+			unsigned long long pairs = 0;
+			while (true)
+			{
+				bool finished = done.load(std::memory_order_acquire);
+				const PX::SimulationEventFrame* frame = events.Acquire();
+				if (frame == nullptr)
+				{
+					if (finished)
+					{
+						break;
+					}
+
+					std::this_thread::yield();
+					continue;
+				}
+
+				if (frame->step >= first_step)
+				{
+					pairs += frame->contacts.Size();
+				}
+
+				events.Release(frame);
+			}
+
+			consumed.store(pairs, std::memory_order_relaxed);
+		});
+
+		double fetch_ms = 0.0;
+		double process_ms = 0.0;
+
+		auto start = Clock::now();
+		for (int step = 0; step < options.steps; ++step)
+		{
+			physics.Simulate(options.stepSize);
+			fetch_ms += physics.GetFetchStats().totalMs;
+			process_ms += physics.GetFetchStats().callbacksMs;
+		}
+		double total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		done.store(true, std::memory_order_release);
+		consumer.join();
+
+		const PX::SimulationEventStats& stats = events.GetStats();
+		double steps = static_cast<double>(std::max(1, options.steps));
+
+		Benchmark::EventResult result;
+		result.path = path;
+		result.bodies = count;
+		result.meanStepMs = total_ms / steps;
+		result.callbackUsPerStep = (stats.totalCallbackUs - start_stats.totalCallbackUs) / steps;
+		result.meanFetchMs = fetch_ms / steps;
+		result.meanProcessMs = process_ms / steps;
+		result.reportedPerStep = static_cast<double>(stats.contacts - start_stats.contacts) / steps;
+		result.droppedPerStep = static_cast<double>(stats.contactsThrottled - start_stats.contactsThrottled
+			+ stats.contactsBelowImpulse - start_stats.contactsBelowImpulse + stats.contactsCapped - start_stats.contactsCapped) / steps;
+		result.consumedPerStep = static_cast<double>(consumed.load(std::memory_order_relaxed)) / steps;
+		result.stalls = stats.stalls - start_stats.stalls;
+		return result;
+	}
+}
+
+const char* Benchmark::GetEventPathName(EventPath path)
+{
+	switch (path)
+	{
+	case EventPath::Off: return "off";
+	case EventPath::Every: return "every";
+	case EventPath::EveryParallel: return "every-parallel";
+	case EventPath::Throttled: return "throttled";
+	case EventPath::Filtered: return "filtered";
+	}
+
+	return "unknown";
+}
+
+std::vector<Benchmark::EventResult> Benchmark::RunEvents(const EventOptions& options)
+{
+	std::vector<EventResult> results;
+
+	for (int count : options.counts)
+	{
+		count = std::max(1, count);
+		for (EventPath path : { EventPath::Off, EventPath::Every, EventPath::EveryParallel, EventPath::Throttled, EventPath::Filtered })
+		{
+			results.push_back(RunPath(path, count, options));
+		}
+	}
+
+	return results;
+}
+
+void Benchmark::PrintEvents(std::ostream& stream, const std::vector<EventResult>& results)
+{
+	stream << std::left << std::setw(16) << "Path" << std::right
+		<< std::setw(10) << "Bodies"
+		<< std::setw(10) << "Step ms"
+		<< std::setw(10) << "Fetch ms"
+		<< std::setw(12) << "Process ms"
+		<< std::setw(14) << "Callback us"
+		<< std::setw(11) << "Reported"
+		<< std::setw(10) << "Dropped"
+		<< std::setw(11) << "Consumed"
+		<< std::setw(8) << "Stalls"
+		<< std::setw(8) << "Cost" << '\n';
+
+	for (const EventResult& result : results)
+	{
+		double baseline = 0.0;
+		for (const EventResult& other : results)
+		{
+			if (other.path == EventPath::Off && other.bodies == result.bodies)
+			{
+				baseline = other.meanStepMs;
+			}
+		}
+
+		stream << std::left << std::setw(16) << GetEventPathName(result.path) << std::right << std::fixed
+			<< std::setw(10) << result.bodies
+			<< std::setprecision(3) << std::setw(10) << result.meanStepMs
+			<< std::setw(10) << result.meanFetchMs
+			<< std::setw(12) << result.meanProcessMs
+			<< std::setprecision(1) << std::setw(14) << result.callbackUsPerStep
+			<< std::setw(11) << result.reportedPerStep
+			<< std::setw(10) << result.droppedPerStep
+			<< std::setw(11) << result.consumedPerStep
+			<< std::setw(8) << result.stalls
+			<< std::setprecision(2) << std::setw(7) << (baseline > 0.0 ? result.meanStepMs / baseline : 0.0) << "x\n";
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	enum class EventPath
+	{
+		// The scene's callback set but no contact reports asked of the filter shader
+		Off,
+
+		// Found, lost and every persisting pair each step, run inside fetchResults and spread over the workers
+		// with Physics::SetParallelCallbacks
+		Every,
+		EveryParallel,
+
+		// Persisting pairs at most once per EventOptions::throttleSteps
+		Throttled,
+
+		// Persisting pairs dropped below EventOptions::minImpulse
+		Filtered
+	};
+
+	const char* GetEventPathName(EventPath path);
+
+	struct EventOptions
+	{
+		// Boxes resting apart on the plane, about one touching pair each, a list sweeps them
+		std::vector<int> counts = { 10000 };
+
+		int steps = 300;
+		int warmupSteps = 30;
+		double stepSize = 1.0 / 60.0;
+
+		int throttleSteps = 10;
+
+		// A resting box of the benchmark's density pushes about 16 per step at 60Hz, so this drops them
+		float minImpulse = 20.0f;
+
+		unsigned int threads = 0;
+	};
+
+	struct EventResult
+	{
+		EventPath path = EventPath::Off;
+		int bodies = 0;
+
+		double meanStepMs = 0.0;
+		double callbackUsPerStep = 0.0;
+
+		// The whole fetch, and the processCallbacks part of it when the callbacks run in parallel
+		double meanFetchMs = 0.0;
+		double meanProcessMs = 0.0;
+
+		// Pairs kept into frames and pairs the throttle or impulse threshold dropped, per step
+		double reportedPerStep = 0.0;
+		double droppedPerStep = 0.0;
+
+		// Pairs the consumer thread read per step, and frames the producer dropped because none was free
+		double consumedPerStep = 0.0;
+		unsigned long long stalls = 0;
+	};
+
+	// Every count down every path, each path in its own scene since the filter shader is fixed at creation.
+	// A consumer thread drains the frames while the scene steps
+	std::vector<EventResult> RunEvents(const EventOptions& options);
+
+	// Cost is each path's step time over the off path's at the same count
+	void PrintEvents(std::ostream& stream, const std::vector<EventResult>& results);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Vertex.h"
+
+namespace GeometryGenerator
+{
+	void CreateBox(float width, float height, float depth, DX::MeshData* meshData);
+
+	void CreatePyramid(float width, float height, float depth, DX::MeshData* meshData);
+
+	void CreatePlane(float width, float depth, DX::MeshData* meshData);
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "LevelLoad.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include "ActorBatch.h"
+#include "Scenes.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	constexpr float HALF_EXTENT = 0.5f;
+	constexpr float GROUND_Y = -1.0f;
+	constexpr float DENSITY = 100.0f;
+
+	// A square of pillars with a box resting on top of each one, statics first
+	std::vector<physx::PxTransform> LevelPoses(int count, int statics)
+	{
+		std::vector<physx::PxTransform> poses;
+		poses.reserve(count);
+
+		int columns = std::max(statics, count - statics);
+		int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(columns)))));
+		float spacing = 2.0f;
+		float offset = static_cast<float>(side - 1) * spacing * 0.5f;
+
+		for (int i = 0; i < count; ++i)
+		{
+			bool is_static = i < statics;
+			int column = is_static ? i : i - statics;
+
+			float y = GROUND_Y + HALF_EXTENT + (is_static ? 0.0f : 2.0f * HALF_EXTENT);
+			poses.push_back(physx::PxTransform(physx::PxVec3(static_cast<float>(column % side) * spacing - offset, y, static_cast<float>(column / side) * spacing - offset)));
+		}
+
+		return poses;
+	}
+
+	Benchmark::LevelLoadResult RunOne(const Benchmark::LevelLoadOptions& options, int count, Benchmark::LoadPath path)
+	{
+		Benchmark::LevelLoadResult result;
+		result.path = path;
+		result.actors = count;
+
+		PX::JobSystemDesc job_desc;
+		job_desc.workerCount = options.threads;
+
+		PX::Physics physics;
+		physics.SetJobSystemDesc(job_desc);
+		physics.Setup();
+		Benchmark::CreatePlane(physics);
+
+		PX::ShapeRegistry& registry = physics.GetShapeRegistry();
+		physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = registry.AcquireShape(physx::PxBoxGeometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT), *material);
+
+		int statics = static_cast<int>(static_cast<float>(count) * std::clamp(options.staticFraction, 0.0f, 1.0f));
+		std::vector<physx::PxTransform> poses = LevelPoses(count, statics);
+
+		if (path == Benchmark::LoadPath::Serial)
+		{
+			auto start = Clock::now();
+			for (int i = 0; i < count; ++i)
+			{
+				physx::PxRigidActor* actor = nullptr;
+				if (i < statics)
+				{
+					actor = physics.GetPhysics()->createRigidStatic(poses[i]);
+					actor->attachShape(*shape);
+				}
+				else
+				{
+					physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(poses[i]);
+					body->attachShape(*shape);
+					physx::PxRigidBodyExt::updateMassAndInertia(*body, DENSITY);
+					actor = body;
+				}
+
+				physics.GetScene()->addActor(*actor);
+			}
+
+			result.totalMs = ElapsedMs(start);
+			result.buildMs = result.totalMs;
+		}
+		else
+		{
+			PX::ActorBatchDesc desc;
+			desc.pruningStructure = path == Benchmark::LoadPath::BatchPruned;
+
+			// Gathering the entries is the level file's job, it isn't part of the load time
+			PX::ActorBatch batch(physics, desc);
+			batch.Reserve(count);
+			for (int i = 0; i < count; ++i)
+			{
+				if (i < statics)
+					batch.AddStatic(poses[i], *shape);
+				else
+					batch.AddDynamic(poses[i], *shape, DENSITY);
+			}
+
+			batch.Spawn();
+
+			const PX::ActorBatchStats& stats = batch.GetStats();
+			result.buildMs = stats.buildMs;
+			result.pruningMs = stats.pruningMs;
+			result.insertMs = stats.insertMs;
+			result.totalMs = stats.totalMs;
+		}
+
+		auto step_start = Clock::now();
+		physics.Simulate(1.0 / 60.0);
+		result.firstStepMs = ElapsedMs(step_start);
+
+		registry.ReleaseShape(shape);
+		registry.ReleaseMaterial(material);
+		return result;
+	}
+}
+
+const char* Benchmark::GetLoadPathName(LoadPath path)
+{
+	switch (path)
+	{
+	case LoadPath::Serial: return "serial";
+	case LoadPath::Batch: return "batch";
+	case LoadPath::BatchPruned: return "batch-pruned";
+	}
+
+	return "unknown";
+}
+
+std::vector<Benchmark::LevelLoadResult> Benchmark::RunLevelLoad(const LevelLoadOptions& options)
+{
+	std::vector<LevelLoadResult> results;
+	for (int count : options.counts)
+	{
+		for (LoadPath path : { LoadPath::Serial, LoadPath::Batch, LoadPath::BatchPruned })
+		{
+			results.push_back(RunOne(options, std::max(1, count), path));
+		}
+	}
+
+	return results;
+}
+
+void Benchmark::PrintLevelLoad(std::ostream& stream, const std::vector<LevelLoadResult>& results)
+{
+	stream << std::left << std::setw(14) << "Path" << std::right
+		<< std::setw(10) << "Actors"
+		<< std::setw(11) << "Build ms"
+		<< std::setw(12) << "Pruning ms"
+		<< std::setw(11) << "Insert ms"
+		<< std::setw(11) << "Load ms"
+		<< std::setw(13) << "1st step ms"
+		<< std::setw(10) << "Speedup" << '\n';
+
+	for (const LevelLoadResult& result : results)
+	{
+		double baseline = 0.0;
+		for (const LevelLoadResult& serial : results)
+		{
+			if (serial.path == LoadPath::Serial && serial.actors == result.actors)
+			{
+				baseline = serial.totalMs + serial.firstStepMs;
+			}
+		}
+
+		double total = result.totalMs + result.firstStepMs;
+
+		stream << std::left << std::setw(14) << GetLoadPathName(result.path) << std::right << std::fixed
+			<< std::setw(10) << result.actors
+			<< std::setprecision(2) << std::setw(11) << result.buildMs
+			<< std::setw(12) << result.pruningMs
+			<< std::setw(11) << result.insertMs
+			<< std::setw(11) << result.totalMs
+			<< std::setw(13) << result.firstStepMs
+			<< std::setw(9) << (total > 0.0 ? baseline / total : 0.0) << "x\n";
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	enum class LoadPath
+	{
+		// Each actor built and added on the main thread, the way the models do it
+		Serial,
+
+		// PX::ActorBatch built on the workers and added in one call, with and without the statics' pruning structure
+		Batch,
+		BatchPruned
+	};
+
+	const char* GetLoadPathName(LoadPath path);
+
+	struct LevelLoadOptions
+	{
+		// Actors per level, a list sweeps them
+		std::vector<int> counts = { 10000, 100000 };
+
+		// Share of the level that is static scenery, the rest are boxes resting on it
+		float staticFraction = 0.5f;
+
+		unsigned int threads = 0;
+	};
+
+	struct LevelLoadResult
+	{
+		LoadPath path = LoadPath::Serial;
+		int actors = 0;
+
+		double buildMs = 0.0;
+		double pruningMs = 0.0;
+		double insertMs = 0.0;
+		double totalMs = 0.0;
+
+		// The first step has to finish the broadphase setup the insert left for it
+		double firstStepMs = 0.0;
+	};
+
+	// Every count down every path, each in a fresh PX::Physics
+	std::vector<LevelLoadResult> RunLevelLoad(const LevelLoadOptions& options);
+
+	// Speedup is the serial load plus first step over each path's at the same count
+	void PrintLevelLoad(std::ostream& stream, const std::vector<LevelLoadResult>& results);
+}
@@ -0,0 +1,381 @@
+#include "MeshCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	// Bump when the file layout changes, old entries then fail to validate and are cooked again
+	constexpr std::uint32_t FORMAT_VERSION = 1;
+	constexpr char MAGIC[4] = { 'P', 'X', 'M', 'C' };
+
+	struct FileHeader
+	{
+		char magic[4];
+		std::uint32_t formatVersion;
+		std::uint32_t physxVersion;
+		std::uint32_t padding;
+		std::uint64_t key;
+		std::uint64_t size;
+		std::uint64_t checksum;
+	};
+
+	// 64 bit FNV-1a, only has to tell meshes apart, not stand up to anyone trying to collide it
+	class Hasher
+	{
+	public:
+		void AddBytes(const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i)
+			{
+				m_Value = (m_Value ^ bytes[i]) * 1099511628211ull;
+			}
+		}
+
+		template <typename T>
+		void Add(const T& value)
+		{
+			AddBytes(&value, sizeof(T));
+		}
+
+		// Bounded data may be strided, only element_size bytes of each element are hashed
+		void AddStrided(const void* data, physx::PxU32 count, physx::PxU32 stride, size_t element_size)
+		{
+			Add(count);
+			if (data == nullptr)
+			{
+				return;
+			}
+
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (physx::PxU32 i = 0; i < count; ++i)
+			{
+				AddBytes(bytes + static_cast<size_t>(i) * stride, element_size);
+			}
+		}
+
+		inline std::uint64_t GetValue() const { return m_Value; }
+
+	private:
+		std::uint64_t m_Value = 14695981039346656037ull;
+	};
+
+	double ElapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+PX::MeshCache::MeshCache(const std::string& directory) : m_Directory(directory)
+{
+}
+
+void PX::MeshCache::SetDirectory(const std::string& directory)
+{
+	ClosePack();
+	m_Directory = directory;
+}
+
+std::uint64_t PX::MeshCache::ComputeKey(const physx::PxCookingParams& params, const physx::PxTriangleMeshDesc& desc)
+{
+	Hasher hasher;
+	hasher.Add(static_cast<std::uint32_t>(PX_PHYSICS_VERSION));
+	hasher.Add(FORMAT_VERSION);
+
+	// Mesh
+	hasher.AddStrided(desc.points.data, desc.points.count, desc.points.stride, sizeof(physx::PxVec3));
+
+	bool small_indices = desc.flags.isSet(physx::PxMeshFlag::e16_BIT_INDICES);
+	size_t index_size = small_indices ? sizeof(physx::PxU16) : sizeof(physx::PxU32);
+	hasher.AddStrided(desc.triangles.data, desc.triangles.count, desc.triangles.stride, 3 * index_size);
+	hasher.AddStrided(desc.materialIndices.data, desc.materialIndices.data != nullptr ? desc.triangles.count : 0, desc.materialIndices.stride, sizeof(physx::PxMaterialTableIndex));
+	hasher.Add(static_cast<physx::PxU32>(desc.flags));
+
+	// Cooking params, field by field so padding doesn't leak into the key
+	hasher.Add(params.areaTestEpsilon);
+	hasher.Add(params.planeTolerance);
+	hasher.Add(static_cast<std::uint32_t>(params.convexMeshCookingType));
+	hasher.Add(params.suppressTriangleMeshRemapTable);
+	hasher.Add(params.buildTriangleAdjacencies);
+	hasher.Add(params.buildGPUData);
+	hasher.Add(params.scale.length);
+	hasher.Add(params.scale.speed);
+	hasher.Add(static_cast<physx::PxU32>(params.meshPreprocessParams));
+	hasher.Add(params.meshWeldTolerance);
+	hasher.Add(params.gaussMapLimit);
+	hasher.Add(params.maxWeightRatioInTet);
+
+	physx::PxMeshMidPhase::Enum midphase = params.midphaseDesc.getType();
+	hasher.Add(static_cast<std::uint32_t>(midphase));
+	if (midphase == physx::PxMeshMidPhase::eBVH33)
+	{
+		hasher.Add(params.midphaseDesc.mBVH33Desc.meshSizePerformanceTradeOff);
+		hasher.Add(static_cast<std::uint32_t>(params.midphaseDesc.mBVH33Desc.meshCookingHint));
+	}
+	else
+	{
+		hasher.Add(params.midphaseDesc.mBVH34Desc.numPrimsPerLeaf);
+		hasher.Add(static_cast<std::uint32_t>(params.midphaseDesc.mBVH34Desc.buildStrategy));
+		hasher.Add(params.midphaseDesc.mBVH34Desc.quantized);
+	}
+
+	// SDF, the thread count only changes how fast it cooks so it stays out of the key
+	const physx::PxSDFDesc* sdf = desc.sdfDesc;
+	hasher.Add(sdf != nullptr);
+	if (sdf != nullptr)
+	{
+		hasher.Add(sdf->spacing);
+		hasher.Add(sdf->subgridSize);
+		hasher.Add(static_cast<std::uint32_t>(sdf->bitsPerSubgridPixel));
+		hasher.Add(sdf->sdfBounds.minimum);
+		hasher.Add(sdf->sdfBounds.maximum);
+		hasher.Add(sdf->narrowBandThicknessRelativeToSdfBoundsDiagonal);
+		hasher.Add(sdf->dims.x);
+		hasher.Add(sdf->dims.y);
+		hasher.Add(sdf->dims.z);
+		hasher.Add(sdf->meshLower);
+		hasher.AddStrided(sdf->sdf.data, sdf->sdf.count, sdf->sdf.stride, sizeof(physx::PxReal));
+	}
+
+	return hasher.GetValue();
+}
+
+physx::PxTriangleMesh* PX::MeshCache::CreateTriangleMesh(physx::PxPhysics& physics, const physx::PxCookingParams& params, const physx::PxTriangleMeshDesc& desc)
+{
+	std::uint64_t key = 0;
+	if (m_Enabled)
+	{
+		key = ComputeKey(params, desc);
+
+		auto load_start = std::chrono::steady_clock::now();
+
+		// The pack first, then a loose entry, both are created straight from the mapped file
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_PackOpened)
+			{
+				m_Pack.Open(GetPackPath());
+				m_PackOpened = true;
+			}
+
+			physx::PxTriangleMesh* mesh = m_Pack.IsOpen() ? m_Pack.GetTriangleMesh(physics, key) : nullptr;
+			if (mesh != nullptr)
+			{
+				m_Stats.hits++;
+				m_Stats.packHits++;
+				m_Stats.loadMs += ElapsedMs(load_start);
+				return mesh;
+			}
+		}
+
+		MappedFile file;
+		const unsigned char* blob = nullptr;
+		size_t size = 0;
+		if (Read(key, file, blob, size))
+		{
+			MappedInputData input(blob, size);
+			physx::PxTriangleMesh* mesh = physics.createTriangleMesh(input);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (mesh != nullptr)
+			{
+				m_Stats.hits++;
+				m_Stats.bytesRead += size;
+				m_Stats.loadMs += ElapsedMs(load_start);
+				return mesh;
+			}
+
+			m_Stats.invalid++;
+		}
+	}
+
+	// Cooking runs unlocked, the cooking service has several of these going at once
+	auto cook_start = std::chrono::steady_clock::now();
+	physx::PxDefaultMemoryOutputStream output;
+	physx::PxTriangleMeshCookingResult::Enum result;
+	bool cooked = PxCookTriangleMesh(params, desc, output, &result);
+	double cook_ms = ElapsedMs(cook_start);
+
+	bool written = cooked && m_Enabled && Write(key, output.getData(), output.getSize());
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stats.misses++;
+		m_Stats.cookMs += cook_ms;
+		if (written)
+		{
+			m_Stats.bytesWritten += output.getSize();
+		}
+	}
+
+	if (!cooked)
+	{
+		return nullptr;
+	}
+
+	MappedInputData input(output.getData(), output.getSize());
+	return physics.createTriangleMesh(input);
+}
+
+PX::MeshCacheStats PX::MeshCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+void PX::MeshCache::ResetStats()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats = MeshCacheStats();
+}
+
+void PX::MeshCache::PrintStats(std::ostream& stream) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	stream << "Mesh cache " << m_Directory << ": "
+		<< m_Stats.hits << " hits (" << m_Stats.packHits << " from the pack), " << m_Stats.misses << " misses (" << m_Stats.invalid << " invalid), "
+		<< std::fixed << std::setprecision(2) << m_Stats.cookMs << " ms cooking, " << m_Stats.loadMs << " ms loading, "
+		<< m_Stats.bytesRead / 1024 << " KB read, " << m_Stats.bytesWritten / 1024 << " KB written\n";
+}
+
+void PX::MeshCache::ClosePack()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Pack.Close();
+	m_PackOpened = false;
+}
+
+bool PX::MeshCache::WritePack()
+{
+	// Every loose entry that still validates, the pack replaces them without removing them
+	PackWriter writer;
+	std::error_code error;
+	for (const auto& item : std::filesystem::directory_iterator(m_Directory, error))
+	{
+		if (item.path().extension() != ".pxmesh")
+		{
+			continue;
+		}
+
+		// Anything not named by a key isn't ours
+		std::string stem = item.path().stem().string();
+		char* end = nullptr;
+		std::uint64_t key = std::strtoull(stem.c_str(), &end, 16);
+		if (stem.empty() || *end != '\0')
+		{
+			continue;
+		}
+
+		MappedFile file;
+		const unsigned char* blob = nullptr;
+		size_t size = 0;
+		if (Read(key, file, blob, size))
+		{
+			writer.Add(key, PackEntryType::TriangleMesh, blob, size);
+		}
+	}
+
+	if (error || writer.GetEntryCount() == 0)
+	{
+		return false;
+	}
+
+	// A mapped pack can't be replaced underneath us on Windows
+	ClosePack();
+	return writer.Write(GetPackPath());
+}
+
+void PX::MeshCache::CountInvalid()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.invalid++;
+}
+
+std::string PX::MeshCache::GetPackPath() const
+{
+	return (std::filesystem::path(m_Directory) / "Meshes.pxpack").string();
+}
+
+std::string PX::MeshCache::GetPath(std::uint64_t key) const
+{
+	std::ostringstream name;
+	name << std::hex << std::setw(16) << std::setfill('0') << key << ".pxmesh";
+	return (std::filesystem::path(m_Directory) / name.str()).string();
+}
+
+bool PX::MeshCache::Read(std::uint64_t key, MappedFile& file, const unsigned char*& blob, size_t& size)
+{
+	if (!file.Open(GetPath(key)))
+	{
+		return false;
+	}
+
+	FileHeader header = {};
+	if (file.GetSize() < sizeof(header))
+	{
+		CountInvalid();
+		return false;
+	}
+
+	std::memcpy(&header, file.GetData(), sizeof(header));
+
+	// A different PhysX can't read the blob, a different key means a hash collision or a renamed file and a bad size a truncated one
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.formatVersion != FORMAT_VERSION
+		|| header.physxVersion != PX_PHYSICS_VERSION || header.key != key || header.size > file.GetSize() - sizeof(header))
+	{
+		CountInvalid();
+		return false;
+	}
+
+	blob = file.GetData() + sizeof(header);
+	size = static_cast<size_t>(header.size);
+	if (Checksum(blob, size) != header.checksum)
+	{
+		CountInvalid();
+		return false;
+	}
+
+	return true;
+}
+
+bool PX::MeshCache::Write(std::uint64_t key, const void* data, size_t size)
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_Directory, error);
+
+	FileHeader header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.formatVersion = FORMAT_VERSION;
+	header.physxVersion = PX_PHYSICS_VERSION;
+	header.key = key;
+	header.size = size;
+
+	header.checksum = Checksum(data, size);
+
+	// Written to the side and renamed over, a crash mid write never leaves a truncated entry behind and two threads cooking the same mesh don't share a temp file
+	std::string path = GetPath(key);
+	std::string temp_path = path + "." + std::to_string(m_TempCounter.fetch_add(1)) + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) || !file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)))
+		{
+			file.close();
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temp_path, path, error);
+	if (error)
+	{
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,442 @@
+#include "Runner.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point start, Clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	// Nearest rank on an already sorted list
+	// Stands in for a model, rebuilds the matrix a model would from the pose
+	class TransformSink : public PX::ActorOwner
+	{
+	public:
+		void SyncTransform(const physx::PxTransform& pose) override { m_World = physx::PxMat44(pose); }
+
+	private:
+		physx::PxMat44 m_World = physx::PxMat44(physx::PxIdentity);
+	};
+
+	double ElapsedUs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	}
+
+	double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+
+		size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+		return sorted[std::min(rank, sorted.size() - 1)];
+	}
+}
+
+Benchmark::Result Benchmark::Run(const Scene& scene, const Options& options)
+{
+	Result result;
+	result.scene = scene.name;
+	result.size = scene.size;
+	result.steps = options.steps;
+
+	PX::JobSystemDesc job_desc;
+	job_desc.workerCount = options.threads;
+
+	auto setup_start = Clock::now();
+
+	PX::Physics physics;
+	physics.SetJobSystemDesc(job_desc);
+	physics.SetPvdDesc(options.pvd);
+	physics.GetMeshCache().SetEnabled(options.meshCache);
+	physics.Setup();
+	scene.create(physics);
+
+	result.setupMs = ElapsedMs(setup_start, Clock::now());
+	result.threads = physics.GetJobSystem()->getWorkerCount();
+	result.pvd = PX::GetPvdTransportName(options.pvd.transport);
+	result.pvdConnected = physics.IsPvdConnected();
+	result.pvdSetupMs = physics.GetPvdSetupMs();
+
+	const PX::MeshCacheStats& cache = physics.GetMeshCache().GetStats();
+	result.cacheHits = cache.hits;
+	result.cacheMisses = cache.misses;
+	result.cookMs = cache.cookMs;
+	result.cacheLoadMs = cache.loadMs;
+
+	PX::ShapeRegistryStats registry = physics.GetShapeRegistry().GetStats();
+	result.liveMaterials = registry.liveMaterials;
+	result.liveShapes = registry.liveShapes;
+
+	// Every dynamic body gets an owner, like each model is the owner of its body
+	std::vector<physx::PxActor*> dynamics(physics.GetScene()->getNbActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC));
+	physics.GetScene()->getActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC, dynamics.data(), static_cast<physx::PxU32>(dynamics.size()));
+	std::vector<TransformSink> sinks(dynamics.size());
+	for (size_t i = 0; i < dynamics.size(); ++i)
+	{
+		dynamics[i]->userData = static_cast<PX::ActorOwner*>(&sinks[i]);
+	}
+
+	// No fixed timestep and no pipelining, every Simulate is exactly one blocking step
+	for (int i = 0; i < options.warmupSteps; ++i)
+	{
+		if (scene.update)
+		{
+			scene.update(physics, options.stepSize);
+		}
+
+		physics.Simulate(options.stepSize);
+	}
+
+	std::vector<double> step_ms;
+	step_ms.reserve(options.steps);
+	double contact_pairs = 0.0;
+	double active_ratio = 0.0;
+	double sync_us = 0.0;
+	double full_sync_us = 0.0;
+
+	auto run_start = Clock::now();
+	for (int i = 0; i < options.steps; ++i)
+	{
+		if (scene.update)
+		{
+			scene.update(physics, options.stepSize);
+		}
+
+		auto step_start = Clock::now();
+		physics.Simulate(options.stepSize);
+		step_ms.push_back(ElapsedMs(step_start, Clock::now()));
+
+		contact_pairs += physics.GetStatsRecorder().GetLatest().discreteContactPairs;
+
+		auto sync_start = Clock::now();
+		physics.SyncActiveActors();
+		sync_us += ElapsedUs(sync_start);
+		active_ratio += physics.GetActiveActorStats().ratio;
+
+		auto full_sync_start = Clock::now();
+		for (size_t j = 0; j < dynamics.size(); ++j)
+		{
+			sinks[j].SyncTransform(physics.GetInterpolatedPose(static_cast<physx::PxRigidActor*>(dynamics[j])));
+		}
+		full_sync_us += ElapsedUs(full_sync_start);
+	}
+
+	result.totalMs = ElapsedMs(run_start, Clock::now());
+
+	if (!step_ms.empty())
+	{
+		double sum = 0.0;
+		for (double ms : step_ms)
+		{
+			sum += ms;
+		}
+
+		result.meanMs = sum / static_cast<double>(step_ms.size());
+		result.meanContactPairs = contact_pairs / static_cast<double>(step_ms.size());
+		result.meanActiveRatio = active_ratio / static_cast<double>(step_ms.size());
+		result.meanSyncUs = sync_us / static_cast<double>(step_ms.size());
+		result.meanFullSyncUs = full_sync_us / static_cast<double>(step_ms.size());
+
+		std::sort(step_ms.begin(), step_ms.end());
+		result.p50Ms = Percentile(step_ms, 50.0);
+		result.p90Ms = Percentile(step_ms, 90.0);
+		result.p99Ms = Percentile(step_ms, 99.0);
+		result.maxMs = step_ms.back();
+	}
+
+	if (result.totalMs > 0.0)
+	{
+		result.stepsPerSecond = static_cast<double>(options.steps) * 1000.0 / result.totalMs;
+		result.realtimeFactor = result.stepsPerSecond * options.stepSize;
+	}
+
+	result.peakBytes = physics.GetAllocator().GetPeakBytes();
+	return result;
+}
+
+void Benchmark::PrintResults(std::ostream& stream, const std::vector<Result>& results)
+{
+	stream << std::left << std::setw(20) << "Scene" << std::right
+		<< std::setw(8) << "N"
+		<< std::setw(8) << "Threads"
+		<< std::setw(8) << "PVD"
+		<< std::setw(8) << "Steps"
+		<< std::setw(11) << "Setup ms"
+		<< std::setw(10) << "Mean ms"
+		<< std::setw(10) << "p50 ms"
+		<< std::setw(10) << "p90 ms"
+		<< std::setw(10) << "p99 ms"
+		<< std::setw(10) << "Max ms"
+		<< std::setw(12) << "Steps/s"
+		<< std::setw(10) << "x Real"
+		<< std::setw(10) << "Contacts"
+		<< std::setw(10) << "Active %"
+		<< std::setw(10) << "Sync us"
+		<< std::setw(10) << "Full us"
+		<< std::setw(14) << "Peak KB"
+		<< std::setw(8) << "Mats"
+		<< std::setw(8) << "Shapes" << '\n';
+
+	for (const Result& result : results)
+	{
+		stream << std::left << std::setw(20) << result.scene << std::right << std::fixed
+			<< std::setw(8) << result.size
+			<< std::setw(8) << result.threads
+			<< std::setw(8) << result.pvd
+			<< std::setw(8) << result.steps
+			<< std::setprecision(2) << std::setw(11) << result.setupMs
+			<< std::setprecision(3) << std::setw(10) << result.meanMs
+			<< std::setw(10) << result.p50Ms
+			<< std::setw(10) << result.p90Ms
+			<< std::setw(10) << result.p99Ms
+			<< std::setw(10) << result.maxMs
+			<< std::setprecision(1) << std::setw(12) << result.stepsPerSecond
+			<< std::setw(10) << result.realtimeFactor
+			<< std::setw(10) << result.meanContactPairs
+			<< std::setw(10) << result.meanActiveRatio * 100.0
+			<< std::setw(10) << result.meanSyncUs
+			<< std::setw(10) << result.meanFullSyncUs
+			<< std::setw(14) << result.peakBytes / 1024
+			<< std::setw(8) << result.liveMaterials
+			<< std::setw(8) << result.liveShapes << '\n';
+	}
+}
+
+bool Benchmark::WriteCsv(const std::string& path, const std::vector<Result>& results)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Error: could not open " << path << '\n';
+		return false;
+	}
+
+	file << "scene,size,threads,pvd,pvd_connected,pvd_setup_ms,steps,setup_ms,total_ms,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,steps_per_second,realtime_factor,contact_pairs,cache_hits,cache_misses,cook_ms,cache_load_ms,peak_bytes,active_ratio,sync_us,full_sync_us,live_materials,live_shapes\n";
+	for (const Result& result : results)
+	{
+		file << result.scene << ',' << result.size << ',' << result.threads << ','
+			<< result.pvd << ',' << result.pvdConnected << ',' << result.pvdSetupMs << ',' << result.steps << ','
+			<< result.setupMs << ',' << result.totalMs << ',' << result.meanMs << ','
+			<< result.p50Ms << ',' << result.p90Ms << ',' << result.p99Ms << ',' << result.maxMs << ','
+			<< result.stepsPerSecond << ',' << result.realtimeFactor << ',' << result.meanContactPairs << ','
+			<< result.cacheHits << ',' << result.cacheMisses << ',' << result.cookMs << ',' << result.cacheLoadMs << ',' << result.peakBytes << ','
+			<< result.meanActiveRatio << ',' << result.meanSyncUs << ',' << result.meanFullSyncUs << ','
+			<< result.liveMaterials << ',' << result.liveShapes << '\n';
+	}
+
+	return static_cast<bool>(file);
+}
+
+void Benchmark::PrintMeshCache(std::ostream& stream, const std::vector<Result>& results)
+{
+	stream << std::left << std::setw(20) << "Scene" << std::right
+		<< std::setw(8) << "Hits"
+		<< std::setw(8) << "Misses"
+		<< std::setw(11) << "Cook ms"
+		<< std::setw(11) << "Load ms"
+		<< std::setw(11) << "Setup ms" << '\n';
+
+	for (const Result& result : results)
+	{
+		if (result.cacheHits + result.cacheMisses == 0)
+		{
+			continue;
+		}
+
+		stream << std::left << std::setw(20) << result.scene << std::right << std::fixed
+			<< std::setw(8) << result.cacheHits
+			<< std::setw(8) << result.cacheMisses
+			<< std::setprecision(2) << std::setw(11) << result.cookMs
+			<< std::setw(11) << result.cacheLoadMs
+			<< std::setw(11) << result.setupMs << '\n';
+	}
+}
+
+void Benchmark::PrintPvdOverhead(std::ostream& stream, const std::vector<Result>& results)
+{
+	stream << std::left << std::setw(20) << "Scene" << std::right
+		<< std::setw(8) << "N"
+		<< std::setw(8) << "Threads"
+		<< std::setw(8) << "PVD"
+		<< std::setw(11) << "Connected"
+		<< std::setw(13) << "PVD setup ms"
+		<< std::setw(10) << "Mean ms"
+		<< std::setw(14) << "Step overhead" << '\n';
+
+	for (const Result& result : results)
+	{
+		if (result.pvd == "none")
+		{
+			continue;
+		}
+
+		auto baseline = std::find_if(results.begin(), results.end(), [&](const Result& other)
+		{
+			return other.pvd == "none" && other.scene == result.scene && other.size == result.size && other.threads == result.threads;
+		});
+
+		stream << std::left << std::setw(20) << result.scene << std::right << std::fixed
+			<< std::setw(8) << result.size
+			<< std::setw(8) << result.threads
+			<< std::setw(8) << result.pvd
+			<< std::setw(11) << (result.pvdConnected ? "yes" : "no")
+			<< std::setprecision(2) << std::setw(13) << result.pvdSetupMs
+			<< std::setprecision(3) << std::setw(10) << result.meanMs;
+
+		if (baseline != results.end() && baseline->meanMs > 0.0)
+		{
+			double overhead = (result.meanMs - baseline->meanMs) / baseline->meanMs * 100.0;
+			stream << std::setprecision(1) << std::setw(13) << std::showpos << overhead << std::noshowpos << '%';
+		}
+		else
+		{
+			stream << std::setw(14) << "-";
+		}
+
+		stream << '\n';
+	}
+}
+
+void Benchmark::PrintCompoundComparison(std::ostream& stream, const std::vector<Result>& results)
+{
+	stream << std::left << std::setw(20) << "Pile" << std::right
+		<< std::setw(8) << "N"
+		<< std::setw(8) << "Threads"
+		<< std::setw(11) << "SDF ms"
+		<< std::setw(11) << "Hulls ms"
+		<< std::setw(10) << "Speedup"
+		<< std::setw(13) << "SDF pairs"
+		<< std::setw(13) << "Hull pairs" << '\n';
+
+	for (const Result& sdf : results)
+	{
+		if (sdf.scene != "sdfpile")
+		{
+			continue;
+		}
+
+		auto hulls = std::find_if(results.begin(), results.end(), [&](const Result& other)
+		{
+			return other.scene == "hullpile" && other.size == sdf.size && other.threads == sdf.threads && other.pvd == sdf.pvd;
+		});
+
+		if (hulls == results.end())
+		{
+			continue;
+		}
+
+		stream << std::left << std::setw(20) << "pyramids" << std::right << std::fixed
+			<< std::setw(8) << sdf.size
+			<< std::setw(8) << sdf.threads
+			<< std::setprecision(3) << std::setw(11) << sdf.meanMs
+			<< std::setw(11) << hulls->meanMs
+			<< std::setprecision(2) << std::setw(9) << (hulls->meanMs > 0.0 ? sdf.meanMs / hulls->meanMs : 0.0) << 'x'
+			<< std::setprecision(1) << std::setw(13) << sdf.meanContactPairs
+			<< std::setw(13) << hulls->meanContactPairs << '\n';
+	}
+}
+
+void Benchmark::PrintScalingTable(std::ostream& stream, const std::vector<Result>& results)
+{
+	std::vector<unsigned int> threads;
+	for (const Result& result : results)
+	{
+		if (std::find(threads.begin(), threads.end(), result.threads) == threads.end())
+		{
+			threads.push_back(result.threads);
+		}
+	}
+
+	std::sort(threads.begin(), threads.end());
+
+	stream << std::left << std::setw(20) << "Scene" << std::right << std::setw(8) << "N";
+	for (unsigned int count : threads)
+	{
+		stream << std::setw(11) << (std::to_string(count) + "T ms") << std::setw(9) << "speedup";
+	}
+
+	stream << '\n';
+
+	// Only compare runs that used the same PVD setting as the first, the overhead table covers the rest
+	const std::string pvd = results.empty() ? std::string("none") : results.front().pvd;
+
+	// One row per scene and size in the order they were run
+	std::vector<std::pair<std::string, int>> rows;
+	for (const Result& result : results)
+	{
+		std::pair<std::string, int> row(result.scene, result.size);
+		if (std::find(rows.begin(), rows.end(), row) == rows.end())
+		{
+			rows.push_back(row);
+		}
+	}
+
+	for (const auto& row : rows)
+	{
+		stream << std::left << std::setw(20) << row.first << std::right << std::setw(8) << row.second << std::fixed;
+
+		double baseline_ms = 0.0;
+		for (unsigned int count : threads)
+		{
+			auto it = std::find_if(results.begin(), results.end(), [&](const Result& result)
+			{
+				return result.scene == row.first && result.size == row.second && result.threads == count && result.pvd == pvd;
+			});
+
+			if (it == results.end())
+			{
+				stream << std::setw(11) << "-" << std::setw(9) << "-";
+				continue;
+			}
+
+			if (baseline_ms == 0.0)
+			{
+				baseline_ms = it->meanMs;
+			}
+
+			double speedup = it->meanMs > 0.0 ? baseline_ms / it->meanMs : 0.0;
+			stream << std::setprecision(3) << std::setw(11) << it->meanMs
+				<< std::setprecision(2) << std::setw(8) << speedup << 'x';
+		}
+
+		stream << '\n';
+	}
+}
+
+std::uint64_t Benchmark::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+	}
+
+	return 0;
+#else
+	// Linux reports kilobytes
+	rusage usage = {};
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Scenes.h"
+
+namespace Benchmark
+{
+	struct Options
+	{
+		int steps = 1000;
+		int warmupSteps = 60;
+		double stepSize = 1.0 / 60.0;
+
+		// Zero sizes the pool from the hardware, same as the samples
+		unsigned int threads = 0;
+
+		// Off unless a sweep asks for it
+		PX::PvdDesc pvd;
+
+		// Read cooked meshes back from disk, off measures a cold start every run
+		bool meshCache = true;
+	};
+
+	struct Result
+	{
+		std::string scene;
+		int size = 0;
+		unsigned int threads = 0;
+		int steps = 0;
+
+		// Transport used and whether it actually connected, setupMs includes pvdSetupMs
+		std::string pvd = "none";
+		bool pvdConnected = false;
+		double pvdSetupMs = 0.0;
+
+		double setupMs = 0.0;
+		double totalMs = 0.0;
+
+		// Wall time of each Simulate call
+		double meanMs = 0.0;
+		double p50Ms = 0.0;
+		double p90Ms = 0.0;
+		double p99Ms = 0.0;
+		double maxMs = 0.0;
+
+		// Steps per wall second, and simulated seconds per wall second
+		double stepsPerSecond = 0.0;
+		double realtimeFactor = 0.0;
+
+		// Discrete contact pairs per timed step from the simulation statistics
+		double meanContactPairs = 0.0;
+
+		// Cooking during setup, hits skip the cook entirely
+		std::uint64_t cacheHits = 0;
+		std::uint64_t cacheMisses = 0;
+		double cookMs = 0.0;
+		double cacheLoadMs = 0.0;
+
+		// PhysX heap through the pool allocator
+		std::int64_t peakBytes = 0;
+
+		// Share of the dynamic bodies awake after each step, and the time to sync the transforms of just those
+		// against walking every dynamic body the way the models' Update did
+		double meanActiveRatio = 0.0;
+		double meanSyncUs = 0.0;
+		double meanFullSyncUs = 0.0;
+
+		// Unique materials and shapes the registry holds once the scene is built
+		size_t liveMaterials = 0;
+		size_t liveShapes = 0;
+	};
+
+	// Build the scene in a fresh PX::Physics and step it as fast as it will go
+	Result Run(const Scene& scene, const Options& options);
+
+	void PrintResults(std::ostream& stream, const std::vector<Result>& results);
+	bool WriteCsv(const std::string& path, const std::vector<Result>& results);
+
+	// Hits, misses and the time setup spent cooking or loading, for the scenes that cook meshes
+	void PrintMeshCache(std::ostream& stream, const std::vector<Result>& results);
+
+	// Setup and mean step time of every PVD run against the same run without PVD
+	void PrintPvdOverhead(std::ostream& stream, const std::vector<Result>& results);
+
+	// sdfpile against hullpile at each size, the same pile as SDF triangle meshes and as convex compounds
+	void PrintCompoundComparison(std::ostream& stream, const std::vector<Result>& results);
+
+	// Mean step time per scene and size against each thread count run, with the speedup over the fewest threads
+	void PrintScalingTable(std::ostream& stream, const std::vector<Result>& results);
+
+	// High water mark of the whole process, in bytes
+	std::uint64_t GetPeakResidentBytes();
+}
@@ -0,0 +1,268 @@
+#include "Scenes.h"
+#include <memory>
+#include "GeometryGenerator.h"
+#include "PrimitiveFit.h"
+#include "SdfTuner.h"
+
+namespace
+{
+	// The models fit their collision to the box mesh they render and share it through the registry
+	physx::PxShape* CreateFittedBox(PX::Physics& physics, const physx::PxVec3& dimensions, const physx::PxMaterial& material)
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreateBox(dimensions.x, dimensions.y, dimensions.z, &mesh_data);
+
+		PX::PrimitiveFitResult fit = PX::FitPrimitives(mesh_data);
+		const PX::PrimitiveFit& primitive = fit.GetPrimitive();
+		return physics.GetShapeRegistry().AcquireShape(primitive.geometry.any(), material, primitive.localPose);
+	}
+
+	// DynamicModel, DynamicLockedModel and the box KinematicModel
+	physx::PxRigidDynamic* CreateDynamicBox(PX::Physics& physics, const physx::PxVec3& position, const physx::PxVec3& dimensions, float friction, float restitution, bool kinematic = false)
+	{
+		physx::PxMaterial* material = physics.GetShapeRegistry().AcquireMaterial(friction, friction, restitution);
+		physx::PxShape* shape = CreateFittedBox(physics, dimensions, *material);
+
+		physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(physx::PxTransform(position));
+		body->attachShape(*shape);
+		if (kinematic)
+		{
+			body->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
+		}
+
+		physx::PxRigidBodyExt::updateMassAndInertia(*body, 100.0f);
+		physics.GetScene()->addActor(*body);
+		return body;
+	}
+
+	// StaticBasic's StaticModel
+	void CreateStaticBox(PX::Physics& physics, const physx::PxVec3& position, const physx::PxVec3& dimensions)
+	{
+		physx::PxMaterial* material = physics.GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = CreateFittedBox(physics, dimensions, *material);
+
+		physx::PxRigidStatic* body = physics.GetPhysics()->createRigidStatic(physx::PxTransform(position));
+		body->attachShape(*shape);
+		physics.GetScene()->addActor(*body);
+	}
+
+	// Cooks a pyramid the way the cooked models do, with an SDF when sdf_desc is set
+	physx::PxTriangleMesh* CookPyramid(PX::Physics& physics, const physx::PxVec3& dimensions, physx::PxSDFDesc* sdf_desc)
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreatePyramid(dimensions.x, dimensions.y, dimensions.z, &mesh_data);
+
+		physx::PxTriangleMeshDesc meshDesc;
+		meshDesc.points.count = static_cast<physx::PxU32>(mesh_data.vertices.size());
+		meshDesc.points.stride = sizeof(DX::Vertex);
+		meshDesc.points.data = mesh_data.vertices.data();
+		meshDesc.triangles.count = static_cast<physx::PxU32>(mesh_data.indices.size() / 3);
+		meshDesc.triangles.stride = 3 * sizeof(UINT);
+		meshDesc.triangles.data = mesh_data.indices.data();
+		meshDesc.sdfDesc = sdf_desc;
+
+		physx::PxTolerancesScale scale;
+		physx::PxCookingParams params(scale);
+		params.meshWeldTolerance = 0.001f;
+		params.meshPreprocessParams = physx::PxMeshPreprocessingFlags(physx::PxMeshPreprocessingFlag::eWELD_VERTICES);
+		params.buildTriangleAdjacencies = false;
+
+		return physics.GetMeshCache().CreateTriangleMesh(*physics.GetPhysics(), params, meshDesc);
+	}
+
+	// StaticCooked's StaticModel and KinematicCooked's KinematicModel
+	physx::PxRigidActor* CreateCookedPyramid(PX::Physics& physics, const physx::PxVec3& position, const physx::PxVec3& dimensions, bool kinematic)
+	{
+		physx::PxTriangleMesh* mesh = CookPyramid(physics, dimensions, nullptr);
+		if (mesh == nullptr)
+		{
+			return nullptr;
+		}
+
+		physx::PxTriangleMeshGeometry geom;
+		geom.triangleMesh = mesh;
+
+		physx::PxMaterial* material = physics.GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+
+		physx::PxRigidActor* body = nullptr;
+		if (kinematic)
+		{
+			physx::PxRigidDynamic* dynamic = physics.GetPhysics()->createRigidDynamic(physx::PxTransform(position));
+			dynamic->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
+			body = dynamic;
+		}
+		else
+		{
+			body = physics.GetPhysics()->createRigidStatic(physx::PxTransform(position));
+		}
+
+		physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*body, geom, *material);
+		shape->setContactOffset(0.1f);
+		shape->setRestOffset(0.02f);
+
+		physics.GetScene()->addActor(*body);
+		return body;
+	}
+
+	// DynamicSDF's DynamicModel, there's no CUDA context here so the SDF contacts run on the CPU
+	void CreateSdfPyramid(PX::Physics& physics, const physx::PxVec3& position)
+	{
+		physx::PxSDFDesc sdfDesc = PX::MakeSdfDesc(PX::SdfSetting());
+
+		physx::PxTriangleMesh* mesh = CookPyramid(physics, physx::PxVec3(1.0f, 1.0f, 1.0f), &sdfDesc);
+		if (mesh == nullptr)
+		{
+			return;
+		}
+
+		physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(physx::PxTransform(position));
+		body->setLinearDamping(0.2f);
+		body->setAngularDamping(0.1f);
+
+		physx::PxTriangleMeshGeometry geom;
+		geom.triangleMesh = mesh;
+
+		physx::PxMaterial* material = physics.GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*body, geom, *material);
+		shape->setContactOffset(0.1f);
+		shape->setRestOffset(0.02f);
+
+		physx::PxRigidBodyExt::updateMassAndInertia(*body, 100.0f);
+		physics.GetScene()->addActor(*body);
+
+		body->setSolverIterationCounts(50, 1);
+		body->setMaxDepenetrationVelocity(5.f);
+	}
+
+	// CharacterKinematicModel, without the behaviour callback
+	physx::PxController* CreateCharacter(PX::Physics& physics, const physx::PxVec3& position)
+	{
+		physx::PxMaterial* material = physics.GetShapeRegistry().AcquireMaterial(0.5f, 0.5f, 0.1f);
+
+		physx::PxCapsuleControllerDesc desc;
+		desc.height = 2.0f;
+		desc.radius = 0.5f;
+		desc.position = physx::PxExtendedVec3(position.x, position.y, position.z);
+		desc.density = 1000.0f;
+		desc.material = material;
+		desc.contactOffset = 0.01f;
+		desc.scaleCoeff = 0.99f;
+
+		return physics.GetControllerManager()->createController(desc);
+	}
+}
+
+void Benchmark::CreatePlane(PX::Physics& physics)
+{
+	physx::PxShapeFlags shapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
+	physx::PxMaterial* materialPtr = physics.GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+
+	physx::PxRigidStatic* rigidStatic = physics.GetPhysics()->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 1.f)));
+	{
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxPlaneGeometry(), &materialPtr, 1, true, shapeFlags);
+		rigidStatic->attachShape(*shape);
+		shape->release();
+	}
+
+	physics.GetScene()->addActor(*rigidStatic);
+}
+
+std::vector<Benchmark::Scene> Benchmark::GetSampleScenes()
+{
+	std::vector<Scene> scenes;
+
+	scenes.push_back({ "Basic", [](PX::Physics& physics)
+	{
+		CreateDynamicBox(physics, physx::PxVec3(0.0f, 5.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.4f, 0.4f);
+		CreatePlane(physics);
+	}, nullptr });
+
+	scenes.push_back({ "DynamicLockedAxis", [](PX::Physics& physics)
+	{
+		CreateDynamicBox(physics, physx::PxVec3(0.0f, 4.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.1f, 0.1f);
+
+		physx::PxRigidDynamic* locked = CreateDynamicBox(physics, physx::PxVec3(0.0f, 1.0f, 4.0f), physx::PxVec3(5.0f, 1.0f, 0.5f), 0.4f, 0.4f);
+		locked->setRigidDynamicLockFlags(physx::PxRigidDynamicLockFlag::eLOCK_LINEAR_X | physx::PxRigidDynamicLockFlag::eLOCK_LINEAR_Z);
+
+		CreatePlane(physics);
+	}, nullptr });
+
+	scenes.push_back({ "DynamicSDF", [](PX::Physics& physics)
+	{
+		CreateSdfPyramid(physics, physx::PxVec3(0.0f, 6.0f, 0.0f));
+		CreateSdfPyramid(physics, physx::PxVec3(0.0f, 12.0f, 0.0f));
+		CreateSdfPyramid(physics, physx::PxVec3(0.0f, 18.0f, 0.0f));
+		CreatePlane(physics);
+	}, nullptr });
+
+	scenes.push_back({ "JointsFixed", [](PX::Physics& physics)
+	{
+		physx::PxRigidDynamic* body1 = CreateDynamicBox(physics, physx::PxVec3(-2.0f, 5.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.4f, 0.4f);
+		physx::PxRigidDynamic* body2 = CreateDynamicBox(physics, physx::PxVec3(2.0f, 3.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.4f, 0.4f);
+		CreatePlane(physics);
+
+		physx::PxFixedJointCreate(*physics.GetPhysics(), body1, physx::PxTransform(physx::PxVec3(-2, 0, 0)), body2, physx::PxTransform(physx::PxVec3(2, 0, 0)));
+	}, nullptr });
+
+	// The sample spins its kinematic pyramid every frame
+	auto kinematic_cooked = std::make_shared<physx::PxRigidDynamic*>(nullptr);
+	scenes.push_back({ "KinematicCooked", [kinematic_cooked](PX::Physics& physics)
+	{
+		CreateDynamicBox(physics, physx::PxVec3(0.0f, 4.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.1f, 0.1f);
+		physx::PxRigidActor* pyramid = CreateCookedPyramid(physics, physx::PxVec3(0.0f, 1.0f, 4.0f), physx::PxVec3(4.0f, 1.0f, 0.5f), true);
+		*kinematic_cooked = pyramid != nullptr ? pyramid->is<physx::PxRigidDynamic>() : nullptr;
+		CreatePlane(physics);
+	}, [kinematic_cooked](PX::Physics&, double step_size)
+	{
+		if (*kinematic_cooked == nullptr)
+		{
+			return;
+		}
+
+		auto pose = (*kinematic_cooked)->getGlobalPose();
+		pose.q *= physx::PxQuat(static_cast<float>(step_size), physx::PxVec3(0.0f, 1.0f, 0.0f));
+		(*kinematic_cooked)->setKinematicTarget(pose);
+	} });
+
+	// The sample slides its kinematic box along x and drops the character under gravity every frame
+	struct KinematicsState
+	{
+		physx::PxRigidDynamic* body = nullptr;
+		physx::PxVec3 position = physx::PxVec3(0.0f, 1.0f, 0.0f);
+		physx::PxController* controller = nullptr;
+	};
+
+	auto kinematics = std::make_shared<KinematicsState>();
+	scenes.push_back({ "Kinematics", [kinematics](PX::Physics& physics)
+	{
+		*kinematics = KinematicsState();
+		kinematics->body = CreateDynamicBox(physics, kinematics->position, physx::PxVec3(2.0f, 0.2f, 2.0f), 0.5f, 0.1f, true);
+		kinematics->controller = CreateCharacter(physics, physx::PxVec3(0.0f, 5.0f, 0.0f));
+		CreatePlane(physics);
+	}, [kinematics](PX::Physics& physics, double step_size)
+	{
+		float delta = static_cast<float>(step_size);
+
+		kinematics->position.x += delta;
+		kinematics->body->setKinematicTarget(physx::PxTransform(kinematics->position));
+
+		physx::PxControllerFilters filters;
+		kinematics->controller->move(physics.GetScene()->getGravity() * delta, 0.0f, delta, filters);
+	} });
+
+	scenes.push_back({ "StaticBasic", [](PX::Physics& physics)
+	{
+		CreateDynamicBox(physics, physx::PxVec3(0.0f, 4.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.1f, 0.1f);
+		CreateStaticBox(physics, physx::PxVec3(0.0f, 1.0f, 4.0f), physx::PxVec3(1.0f, 1.0f, 1.0f));
+		CreatePlane(physics);
+	}, nullptr });
+
+	scenes.push_back({ "StaticCooked", [](PX::Physics& physics)
+	{
+		CreateDynamicBox(physics, physx::PxVec3(0.0f, 4.0f, 0.0f), physx::PxVec3(1.0f, 1.0f, 1.0f), 0.1f, 0.1f);
+		CreateCookedPyramid(physics, physx::PxVec3(0.0f, 1.0f, 4.0f), physx::PxVec3(4.0f, 1.0f, 0.5f), false);
+		CreatePlane(physics);
+	}, nullptr });
+
+	return scenes;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Physics.h"
+
+namespace Benchmark
+{
+	// A sample's actors without any rendering, create builds them and update does what the sample's frame does before each step
+	struct Scene
+	{
+		std::string name;
+
+		std::function<void(PX::Physics& physics)> create;
+		std::function<void(PX::Physics& physics, double step_size)> update;
+
+		// Scale of a stress scene, zero for the sample scenes
+		int size = 0;
+	};
+
+	// PlaneModel's ground, y = -1
+	void CreatePlane(PX::Physics& physics);
+
+	// One scene per sample, set up the same way the sample's Application and models do
+	std::vector<Scene> GetSampleScenes();
+}
@@ -0,0 +1,223 @@
+#include "SdfTuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+	double ElapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+physx::PxU32 PX::GetSdfConstructionThreads()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+physx::PxSDFDesc PX::MakeSdfDesc(const SdfSetting& setting)
+{
+	physx::PxSDFDesc sdf_desc;
+	sdf_desc.spacing = setting.spacing;
+	sdf_desc.subgridSize = setting.subgridSize;
+	sdf_desc.bitsPerSubgridPixel = physx::PxSdfBitsPerSubgridPixel::e16_BIT_PER_PIXEL;
+	sdf_desc.numThreadsForSdfConstruction = GetSdfConstructionThreads();
+	return sdf_desc;
+}
+
+PX::SdfTuner::SdfTuner(Physics& physics) : m_Physics(physics)
+{
+}
+
+std::vector<PX::SdfTuneResult> PX::SdfTuner::Run(const DX::MeshData& mesh, const physx::PxCookingParams& params, const SdfTunerDesc& desc)
+{
+	std::vector<SdfTuneResult> results;
+
+	for (physx::PxReal spacing : desc.spacings)
+	{
+		for (physx::PxU32 subgrid_size : desc.subgridSizes)
+		{
+			SdfTuneResult result;
+			result.setting.spacing = spacing;
+			result.setting.subgridSize = subgrid_size;
+
+			physx::PxSDFDesc sdf_desc = MakeSdfDesc(result.setting);
+
+			physx::PxTriangleMeshDesc mesh_desc;
+			mesh_desc.points.count = static_cast<physx::PxU32>(mesh.vertices.size());
+			mesh_desc.points.stride = sizeof(DX::Vertex);
+			mesh_desc.points.data = mesh.vertices.data();
+			mesh_desc.triangles.count = static_cast<physx::PxU32>(mesh.indices.size() / 3);
+			mesh_desc.triangles.stride = 3 * sizeof(UINT);
+			mesh_desc.triangles.data = mesh.indices.data();
+			mesh_desc.sdfDesc = &sdf_desc;
+
+			// Cooked directly, the mesh cache would hide the cook time
+			auto cook_start = std::chrono::steady_clock::now();
+			physx::PxDefaultMemoryOutputStream output;
+			result.cooked = PxCookTriangleMesh(params, mesh_desc, output);
+			result.cookMs = ElapsedMs(cook_start);
+			result.cookedBytes = output.getSize();
+
+			if (result.cooked)
+			{
+				physx::PxDefaultMemoryInputData input(output.getData(), output.getSize());
+				physx::PxTriangleMesh* triangle_mesh = m_Physics.GetPhysics()->createTriangleMesh(input);
+				if (triangle_mesh != nullptr)
+				{
+					Measure(triangle_mesh, desc, result);
+					triangle_mesh->release();
+				}
+				else
+				{
+					result.cooked = false;
+				}
+			}
+
+			results.push_back(result);
+		}
+	}
+
+	// The finest setting that cooked is the reference the others are held to
+	const SdfTuneResult* reference = nullptr;
+	for (const SdfTuneResult& result : results)
+	{
+		if (result.cooked && (reference == nullptr || result.setting.spacing < reference->setting.spacing
+			|| (result.setting.spacing == reference->setting.spacing && result.setting.subgridSize < reference->setting.subgridSize)))
+		{
+			reference = &result;
+		}
+	}
+
+	for (SdfTuneResult& result : results)
+	{
+		if (result.cooked && reference != nullptr)
+		{
+			result.error = std::fabs(result.restHeight - reference->restHeight);
+			result.withinBound = result.error <= desc.maxError;
+		}
+	}
+
+	return results;
+}
+
+void PX::SdfTuner::Measure(physx::PxTriangleMesh* mesh, const SdfTunerDesc& desc, SdfTuneResult& result)
+{
+	// A scene of its own on the same threads and GPU settings as the main one, so the step cost is comparable
+	physx::PxPhysics* physics = m_Physics.GetPhysics();
+	physx::PxScene* main_scene = m_Physics.GetScene();
+
+	physx::PxSceneDesc scene_desc(physics->getTolerancesScale());
+	scene_desc.gravity = physx::PxVec3(0.0f, -9.81f, 0.0f);
+	scene_desc.cpuDispatcher = m_Physics.GetJobSystem();
+	scene_desc.filterShader = physx::PxDefaultSimulationFilterShader;
+	scene_desc.flags = main_scene->getFlags();
+	scene_desc.cudaContextManager = main_scene->getCudaContextManager();
+
+	physx::PxScene* scene = physics->createScene(scene_desc);
+	if (scene == nullptr)
+	{
+		result.cooked = false;
+		return;
+	}
+
+	physx::PxMaterial* material = physics->createMaterial(0.4f, 0.4f, 0.4f);
+
+	// Same ground as PlaneModel
+	physx::PxRigidStatic* ground = physx::PxCreatePlane(*physics, physx::PxPlane(physx::PxVec3(0.0f, 1.0f, 0.0f), 1.0f), *material);
+	scene->addActor(*ground);
+
+	// Set up like DynamicModel
+	physx::PxRigidDynamic* body = physics->createRigidDynamic(physx::PxTransform(physx::PxVec3(0.0f, 2.0f, 0.0f)));
+	body->setLinearDamping(0.2f);
+	body->setAngularDamping(0.1f);
+
+	physx::PxTriangleMeshGeometry geom;
+	geom.triangleMesh = mesh;
+
+	physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*body, geom, *material);
+	shape->setContactOffset(0.1f);
+	shape->setRestOffset(0.02f);
+
+	physx::PxRigidBodyExt::updateMassAndInertia(*body, 100.0f);
+	scene->addActor(*body);
+	body->setSolverIterationCounts(50, 1);
+	body->setMaxDepenetrationVelocity(5.f);
+
+	physx::PxReal step_size = static_cast<physx::PxReal>(desc.stepSize);
+	for (int i = 0; i < desc.settleSteps; ++i)
+	{
+		scene->simulate(step_size);
+		scene->fetchResults(true);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < desc.timedSteps; ++i)
+	{
+		scene->simulate(step_size);
+		scene->fetchResults(true);
+	}
+
+	result.stepMs = desc.timedSteps > 0 ? ElapsedMs(start) / desc.timedSteps : 0.0;
+	result.restHeight = body->getGlobalPose().p.y;
+
+	scene->release();
+	material->release();
+}
+
+int PX::SdfTuner::PickCheapest(const std::vector<SdfTuneResult>& results)
+{
+	int picked = -1;
+	for (int i = 0; i < static_cast<int>(results.size()); ++i)
+	{
+		const SdfTuneResult& result = results[i];
+		if (!result.withinBound)
+		{
+			continue;
+		}
+
+		if (picked < 0 || result.stepMs < results[picked].stepMs
+			|| (result.stepMs == results[picked].stepMs && result.cookMs < results[picked].cookMs))
+		{
+			picked = i;
+		}
+	}
+
+	return picked;
+}
+
+void PX::SdfTuner::PrintResults(std::ostream& stream, const std::vector<SdfTuneResult>& results)
+{
+	int picked = PickCheapest(results);
+
+	stream << std::right
+		<< std::setw(9) << "Spacing"
+		<< std::setw(9) << "Subgrid"
+		<< std::setw(11) << "Cook ms"
+		<< std::setw(11) << "Size KB"
+		<< std::setw(10) << "Step ms"
+		<< std::setw(10) << "Error" << '\n';
+
+	for (int i = 0; i < static_cast<int>(results.size()); ++i)
+	{
+		const SdfTuneResult& result = results[i];
+		stream << std::fixed << std::setprecision(2)
+			<< std::setw(9) << result.setting.spacing
+			<< std::setw(9) << result.setting.subgridSize;
+
+		if (!result.cooked)
+		{
+			stream << "   failed to cook\n";
+			continue;
+		}
+
+		stream << std::setw(11) << result.cookMs
+			<< std::setw(11) << result.cookedBytes / 1024
+			<< std::setprecision(3) << std::setw(10) << result.stepMs
+			<< std::setprecision(4) << std::setw(10) << result.error
+			<< (i == picked ? "  <- picked" : (result.withinBound ? "" : "  over bound")) << '\n';
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+#include "Vertex.h"
+
+namespace PX
+{
+	struct SdfSetting
+	{
+		physx::PxReal spacing = 0.5f;
+		physx::PxU32 subgridSize = 6;
+	};
+
+	// SDF desc for a setting, construction runs on one thread per core
+	physx::PxSDFDesc MakeSdfDesc(const SdfSetting& setting);
+	physx::PxU32 GetSdfConstructionThreads();
+
+	struct SdfTunerDesc
+	{
+		std::vector<physx::PxReal> spacings = { 0.05f, 0.1f, 0.2f, 0.35f, 0.5f };
+		std::vector<physx::PxU32> subgridSizes = { 4, 6, 8 };
+
+		// Largest difference in resting height from the finest setting that still counts as accurate
+		physx::PxReal maxError = 0.01f;
+
+		// The body falls onto a plane and settles before the timed steps
+		int settleSteps = 180;
+		int timedSteps = 120;
+		double stepSize = 1.0 / 60.0;
+	};
+
+	struct SdfTuneResult
+	{
+		SdfSetting setting;
+		bool cooked = false;
+
+		double cookMs = 0.0;
+		size_t cookedBytes = 0;
+
+		// Mean simulate and fetch of a step with the body resting on the plane
+		double stepMs = 0.0;
+
+		physx::PxReal restHeight = 0.0f;
+		physx::PxReal error = 0.0f;
+		bool withinBound = false;
+	};
+
+	// Cooks one mesh at every spacing and subgrid size, drops each onto a plane and compares cost against accuracy
+	class SdfTuner
+	{
+	public:
+		explicit SdfTuner(Physics& physics);
+
+		std::vector<SdfTuneResult> Run(const DX::MeshData& mesh, const physx::PxCookingParams& params, const SdfTunerDesc& desc = SdfTunerDesc());
+
+		// Cheapest step within the error bound, ties go to the smaller cook, -1 if nothing qualified
+		static int PickCheapest(const std::vector<SdfTuneResult>& results);
+
+		static void PrintResults(std::ostream& stream, const std::vector<SdfTuneResult>& results);
+
+	private:
+		Physics& m_Physics;
+
+		void Measure(physx::PxTriangleMesh* mesh, const SdfTunerDesc& desc, SdfTuneResult& result);
+	};
+}
@@ -0,0 +1,247 @@
+#include "SpawnChurn.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include "ActorPool.h"
+#include "GeometryGenerator.h"
+#include "PrimitiveFit.h"
+#include "Scenes.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedUs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	}
+
+	double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+
+		size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+		return sorted[std::min(rank, sorted.size() - 1)];
+	}
+
+	// Same seed every run so every path fires the same projectiles
+	constexpr unsigned int SEED = 1234;
+
+	// DynamicModel's unit box, fitted the way the model fits it
+	PX::ActorArchetype MakeBoxArchetype()
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreateBox(1.0f, 1.0f, 1.0f, &mesh_data);
+
+		PX::PrimitiveFitResult fit = PX::FitPrimitives(mesh_data);
+		const PX::PrimitiveFit& primitive = fit.GetPrimitive();
+
+		PX::ActorArchetype archetype;
+		archetype.geometry = primitive.geometry;
+		archetype.localPose = primitive.localPose;
+		return archetype;
+	}
+
+	Benchmark::SpawnChurnResult RunPath(const Benchmark::SpawnChurnOptions& options, Benchmark::SpawnPath path)
+	{
+		Benchmark::SpawnChurnResult result;
+		result.path = path;
+
+		PX::JobSystemDesc job_desc;
+		job_desc.workerCount = options.threads;
+
+		PX::Physics physics;
+		physics.SetJobSystemDesc(job_desc);
+		physics.Setup();
+		Benchmark::CreatePlane(physics);
+
+		PX::ActorArchetype archetype = MakeBoxArchetype();
+		int spawns_per_step = std::max(1, options.spawnsPerStep);
+		int lifetime = std::max(1, options.lifetimeSteps);
+
+		std::unique_ptr<PX::ActorPool> pool;
+		physx::PxMaterial* material = nullptr;
+		physx::PxShape* shape = nullptr;
+
+		if (path == Benchmark::SpawnPath::Create)
+		{
+			PX::ShapeRegistry& registry = physics.GetShapeRegistry();
+			material = registry.AcquireMaterial(archetype.staticFriction, archetype.dynamicFriction, archetype.restitution);
+			shape = registry.AcquireShape(archetype.geometry.any(), *material, archetype.localPose);
+		}
+		else
+		{
+			PX::ActorPoolDesc desc;
+			desc.prewarm = static_cast<size_t>(options.prewarm >= 0 ? options.prewarm : spawns_per_step * lifetime / 2);
+			desc.deactivation = path == Benchmark::SpawnPath::PoolDisable ? PX::PoolDeactivation::DisableSimulation : PX::PoolDeactivation::RemoveFromScene;
+			pool = std::make_unique<PX::ActorPool>(physics, archetype, desc);
+		}
+
+		std::mt19937 random(SEED);
+		std::uniform_real_distribution<physx::PxReal> spread(-20.0f, 20.0f);
+		std::uniform_real_distribution<physx::PxReal> speed(-5.0f, 5.0f);
+
+		std::vector<double> spawn_us;
+		spawn_us.reserve(static_cast<size_t>(spawns_per_step) * options.steps);
+		double despawn_us = 0.0;
+		std::uint64_t despawns = 0;
+		double step_ms = 0.0;
+
+		// One batch of projectiles per step, the oldest batch goes once it has lived its lifetime
+		std::deque<std::vector<physx::PxRigidDynamic*>> alive;
+
+		for (int step = 0; step < options.steps; ++step)
+		{
+			if (static_cast<int>(alive.size()) >= lifetime)
+			{
+				for (physx::PxRigidDynamic* actor : alive.front())
+				{
+					auto start = Clock::now();
+					if (pool)
+					{
+						pool->Despawn(actor);
+					}
+					else
+					{
+						physics.OnActorRemoved(actor);
+						actor->release();
+					}
+					despawn_us += ElapsedUs(start);
+					despawns++;
+				}
+
+				alive.pop_front();
+			}
+
+			std::vector<physx::PxRigidDynamic*> batch;
+			batch.reserve(spawns_per_step);
+
+			for (int i = 0; i < spawns_per_step; ++i)
+			{
+				physx::PxTransform pose(physx::PxVec3(spread(random), 10.0f, spread(random)));
+				physx::PxVec3 velocity(speed(random), speed(random), speed(random));
+
+				auto start = Clock::now();
+				physx::PxRigidDynamic* actor = nullptr;
+				if (pool)
+				{
+					actor = pool->Spawn(pose, velocity);
+				}
+				else
+				{
+					actor = physics.GetPhysics()->createRigidDynamic(pose);
+					actor->attachShape(*shape);
+					physx::PxRigidBodyExt::updateMassAndInertia(*actor, archetype.density);
+					physics.GetScene()->addActor(*actor);
+					actor->setLinearVelocity(velocity);
+				}
+				spawn_us.push_back(ElapsedUs(start));
+
+				if (actor != nullptr)
+				{
+					batch.push_back(actor);
+				}
+			}
+
+			alive.push_back(std::move(batch));
+
+			auto step_start = Clock::now();
+			physics.Simulate(options.stepSize);
+			step_ms += ElapsedUs(step_start) / 1000.0;
+		}
+
+		result.spawns = spawn_us.size();
+		if (!spawn_us.empty())
+		{
+			std::sort(spawn_us.begin(), spawn_us.end());
+			result.p50Us = Percentile(spawn_us, 50.0);
+			result.p90Us = Percentile(spawn_us, 90.0);
+			result.p99Us = Percentile(spawn_us, 99.0);
+			result.maxUs = spawn_us.back();
+		}
+
+		result.meanDespawnUs = despawns > 0 ? despawn_us / static_cast<double>(despawns) : 0.0;
+		result.meanStepMs = options.steps > 0 ? step_ms / options.steps : 0.0;
+
+		if (pool)
+		{
+			result.capacity = pool->GetStats().capacity;
+			result.grows = pool->GetStats().grows;
+		}
+		else
+		{
+			physics.GetShapeRegistry().ReleaseShape(shape);
+			physics.GetShapeRegistry().ReleaseMaterial(material);
+		}
+
+		return result;
+	}
+}
+
+const char* Benchmark::GetSpawnPathName(SpawnPath path)
+{
+	switch (path)
+	{
+	case SpawnPath::Create: return "create";
+	case SpawnPath::PoolRemove: return "pool-remove";
+	case SpawnPath::PoolDisable: return "pool-disable";
+	}
+
+	return "unknown";
+}
+
+std::vector<Benchmark::SpawnChurnResult> Benchmark::RunSpawnChurn(const SpawnChurnOptions& options)
+{
+	std::vector<SpawnChurnResult> results;
+	for (SpawnPath path : { SpawnPath::Create, SpawnPath::PoolRemove, SpawnPath::PoolDisable })
+	{
+		results.push_back(RunPath(options, path));
+	}
+
+	return results;
+}
+
+void Benchmark::PrintSpawnChurn(std::ostream& stream, const std::vector<SpawnChurnResult>& results)
+{
+	double baseline = 0.0;
+	for (const SpawnChurnResult& result : results)
+	{
+		if (result.path == SpawnPath::Create)
+		{
+			baseline = result.p50Us;
+		}
+	}
+
+	stream << std::left << std::setw(14) << "Path" << std::right
+		<< std::setw(10) << "Spawns"
+		<< std::setw(10) << "p50 us"
+		<< std::setw(10) << "p90 us"
+		<< std::setw(10) << "p99 us"
+		<< std::setw(10) << "Max us"
+		<< std::setw(12) << "Despawn us"
+		<< std::setw(10) << "Step ms"
+		<< std::setw(10) << "Capacity"
+		<< std::setw(8) << "Grows"
+		<< std::setw(10) << "Speedup" << '\n';
+
+	for (const SpawnChurnResult& result : results)
+	{
+		stream << std::left << std::setw(14) << GetSpawnPathName(result.path) << std::right << std::fixed
+			<< std::setw(10) << result.spawns
+			<< std::setprecision(2) << std::setw(10) << result.p50Us
+			<< std::setw(10) << result.p90Us
+			<< std::setw(10) << result.p99Us
+			<< std::setw(10) << result.maxUs
+			<< std::setw(12) << result.meanDespawnUs
+			<< std::setprecision(3) << std::setw(10) << result.meanStepMs
+			<< std::setw(10) << result.capacity
+			<< std::setw(8) << result.grows
+			<< std::setprecision(2) << std::setw(9) << (result.p50Us > 0.0 ? baseline / result.p50Us : 0.0) << "x\n";
+	}
+}
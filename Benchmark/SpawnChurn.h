@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	enum class SpawnPath
+	{
+		// createRigidDynamic, attachShape, updateMassAndInertia and addActor every spawn, release on despawn
+		Create,
+
+		// PX::ActorPool taking bodies out of the scene, and leaving them in with simulation disabled
+		PoolRemove,
+		PoolDisable
+	};
+
+	const char* GetSpawnPathName(SpawnPath path);
+
+	struct SpawnChurnOptions
+	{
+		// Projectiles fired every step, each one despawned lifetimeSteps later
+		int spawnsPerStep = 500;
+		int lifetimeSteps = 60;
+
+		int steps = 300;
+		double stepSize = 1.0 / 60.0;
+
+		// Bodies the pools start with, half of what's alive at once makes them grow along the way
+		int prewarm = -1;
+
+		unsigned int threads = 0;
+	};
+
+	struct SpawnChurnResult
+	{
+		SpawnPath path = SpawnPath::Create;
+		std::uint64_t spawns = 0;
+
+		// Wall time of each spawn call in microseconds
+		double p50Us = 0.0;
+		double p90Us = 0.0;
+		double p99Us = 0.0;
+		double maxUs = 0.0;
+		double meanDespawnUs = 0.0;
+
+		double meanStepMs = 0.0;
+
+		// Pools only, bodies held at the end and times they ran dry
+		size_t capacity = 0;
+		std::uint64_t grows = 0;
+	};
+
+	// The same churn down every path
+	std::vector<SpawnChurnResult> RunSpawnChurn(const SpawnChurnOptions& options);
+
+	// Speedup is the non-pooled p50 over each path's
+	void PrintSpawnChurn(std::ostream& stream, const std::vector<SpawnChurnResult>& results);
+}
@@ -0,0 +1,421 @@
+#include "StressScenes.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include "GeometryGenerator.h"
+#include "SdfTuner.h"
+
+namespace
+{
+	// Every stress body is about a unit across, boxes sit on the ground at y = -1
+	constexpr float HALF_EXTENT = 0.5f;
+	constexpr float GROUND_Y = -1.0f;
+	constexpr float DENSITY = 100.0f;
+
+	// Same seed every run so a size always builds the same scene
+	constexpr unsigned int SEED = 1234;
+
+	physx::PxRigidDynamic* CreateBody(PX::Physics& physics, const physx::PxTransform& pose, physx::PxShape& shape)
+	{
+		physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(pose);
+		body->attachShape(shape);
+		physx::PxRigidBodyExt::updateMassAndInertia(*body, DENSITY);
+		physics.GetScene()->addActor(*body);
+		return body;
+	}
+
+	// The sample pyramid cooked as a convex hull instead of a triangle mesh, so it can be dynamic
+	physx::PxConvexMesh* CookConvexPyramid(PX::Physics& physics)
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreatePyramid(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT, &mesh_data);
+
+		physx::PxConvexMeshDesc desc;
+		desc.points.count = static_cast<physx::PxU32>(mesh_data.vertices.size());
+		desc.points.stride = sizeof(DX::Vertex);
+		desc.points.data = mesh_data.vertices.data();
+		desc.flags = physx::PxConvexFlag::eCOMPUTE_CONVEX;
+
+		physx::PxTolerancesScale scale;
+		physx::PxCookingParams params(scale);
+
+		physx::PxDefaultMemoryOutputStream writeBuffer;
+		if (!PxCookConvexMesh(params, desc, writeBuffer))
+		{
+			return nullptr;
+		}
+
+		physx::PxDefaultMemoryInputData readBuffer(writeBuffer.getData(), writeBuffer.getSize());
+		return physics.GetPhysics()->createConvexMesh(readBuffer);
+	}
+
+	// Smallest lattice side that fits count bodies in a cube
+	int CubeSide(int count)
+	{
+		return std::max(1, static_cast<int>(std::ceil(std::cbrt(static_cast<double>(count)))));
+	}
+
+	physx::PxQuat RandomRotation(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> angle(-physx::PxPi, physx::PxPi);
+		std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+
+		physx::PxVec3 direction(axis(random), axis(random), axis(random));
+		if (direction.normalize() == 0.0f)
+		{
+			direction = physx::PxVec3(0.0f, 1.0f, 0.0f);
+		}
+
+		return physx::PxQuat(angle(random), direction);
+	}
+
+	void CreateTower(PX::Physics& physics, int height)
+	{
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.5f, 0.5f, 0.0f);
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxBoxGeometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT), *material);
+
+		for (int i = 0; i < height; ++i)
+		{
+			float y = GROUND_Y + HALF_EXTENT + 2.0f * HALF_EXTENT * static_cast<float>(i);
+			CreateBody(physics, physx::PxTransform(physx::PxVec3(0.0f, y, 0.0f)), *shape);
+		}
+
+		shape->release();
+	}
+
+	void CreatePyramid(PX::Physics& physics, int base)
+	{
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.5f, 0.5f, 0.0f);
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxBoxGeometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT), *material);
+
+		for (int row = 0; row < base; ++row)
+		{
+			int count = base - row;
+			float y = GROUND_Y + HALF_EXTENT + 2.0f * HALF_EXTENT * static_cast<float>(row);
+
+			for (int i = 0; i < count; ++i)
+			{
+				float x = 2.0f * HALF_EXTENT * (static_cast<float>(i) - static_cast<float>(count - 1) * 0.5f);
+				CreateBody(physics, physx::PxTransform(physx::PxVec3(x, y, 0.0f)), *shape);
+			}
+		}
+
+		shape->release();
+	}
+
+	// Spread out enough that most of the bodies land on the ground rather than on each other
+	void CreateRain(PX::Physics& physics, int count)
+	{
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.5f, 0.5f, 0.2f);
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxBoxGeometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT), *material);
+
+		std::mt19937 random(SEED);
+		int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count) / 4.0))));
+		float spacing = 2.0f;
+		float offset = static_cast<float>(side - 1) * spacing * 0.5f;
+
+		for (int i = 0; i < count; ++i)
+		{
+			int layer = i / (side * side);
+			int x = i % side;
+			int z = (i / side) % side;
+
+			physx::PxVec3 position(static_cast<float>(x) * spacing - offset, 5.0f + static_cast<float>(layer) * spacing, static_cast<float>(z) * spacing - offset);
+			CreateBody(physics, physx::PxTransform(position, RandomRotation(random)), *shape);
+		}
+
+		shape->release();
+	}
+
+	// A tight lattice of four shape types that collapses into one heap, so every pair type shows up in the narrowphase
+	void CreatePile(PX::Physics& physics, int count)
+	{
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.5f, 0.5f, 0.1f);
+
+		std::vector<physx::PxShape*> shapes;
+		shapes.push_back(physics.GetPhysics()->createShape(physx::PxBoxGeometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT), *material));
+		shapes.push_back(physics.GetPhysics()->createShape(physx::PxSphereGeometry(HALF_EXTENT), *material));
+		shapes.push_back(physics.GetPhysics()->createShape(physx::PxCapsuleGeometry(HALF_EXTENT * 0.5f, HALF_EXTENT), *material));
+
+		physx::PxConvexMesh* convex = CookConvexPyramid(physics);
+		if (convex != nullptr)
+		{
+			shapes.push_back(physics.GetPhysics()->createShape(physx::PxConvexMeshGeometry(convex), *material));
+			convex->release();
+		}
+
+		std::mt19937 random(SEED);
+		std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+
+		int side = CubeSide(count);
+		float spacing = 1.2f;
+		float offset = static_cast<float>(side - 1) * spacing * 0.5f;
+
+		for (int i = 0; i < count; ++i)
+		{
+			int layer = i / (side * side);
+			int x = i % side;
+			int z = (i / side) % side;
+
+			physx::PxVec3 position(static_cast<float>(x) * spacing - offset + jitter(random), 1.0f + static_cast<float>(layer) * spacing, static_cast<float>(z) * spacing - offset + jitter(random));
+			CreateBody(physics, physx::PxTransform(position, RandomRotation(random)), *shapes[i % shapes.size()]);
+		}
+
+		for (physx::PxShape* shape : shapes)
+		{
+			shape->release();
+		}
+	}
+
+	// Set up like DynamicModel, the shapes are already attached
+	void AddMeshBody(PX::Physics& physics, physx::PxRigidDynamic& body)
+	{
+		body.setLinearDamping(0.2f);
+		body.setAngularDamping(0.1f);
+		physx::PxRigidBodyExt::updateMassAndInertia(body, DENSITY);
+		physics.GetScene()->addActor(body);
+		body.setSolverIterationCounts(50, 1);
+		body.setMaxDepenetrationVelocity(5.f);
+	}
+
+	// Both mesh piles drop from the same lattice with the same rotations, only the collision geometry differs
+	std::vector<physx::PxTransform> MeshPilePoses(int count)
+	{
+		std::mt19937 random(SEED);
+
+		int side = CubeSide(count);
+		float spacing = 1.5f;
+		float offset = static_cast<float>(side - 1) * spacing * 0.5f;
+
+		std::vector<physx::PxTransform> poses;
+		for (int i = 0; i < count; ++i)
+		{
+			int layer = i / (side * side);
+			int x = i % side;
+			int z = (i / side) % side;
+
+			physx::PxVec3 position(static_cast<float>(x) * spacing - offset, 1.0f + static_cast<float>(layer) * spacing, static_cast<float>(z) * spacing - offset);
+			poses.push_back(physx::PxTransform(position, RandomRotation(random)));
+		}
+
+		return poses;
+	}
+
+	void CreateSdfPile(PX::Physics& physics, int count)
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreatePyramid(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT, &mesh_data);
+
+		// DynamicModel's resolution scaled down with the pyramid
+		PX::SdfSetting setting;
+		setting.spacing *= HALF_EXTENT;
+		physx::PxSDFDesc sdf_desc = PX::MakeSdfDesc(setting);
+
+		physx::PxTriangleMeshDesc mesh_desc;
+		mesh_desc.points.count = static_cast<physx::PxU32>(mesh_data.vertices.size());
+		mesh_desc.points.stride = sizeof(DX::Vertex);
+		mesh_desc.points.data = mesh_data.vertices.data();
+		mesh_desc.triangles.count = static_cast<physx::PxU32>(mesh_data.indices.size() / 3);
+		mesh_desc.triangles.stride = 3 * sizeof(UINT);
+		mesh_desc.triangles.data = mesh_data.indices.data();
+		mesh_desc.sdfDesc = &sdf_desc;
+
+		physx::PxTolerancesScale scale;
+		physx::PxCookingParams params(scale);
+		params.meshWeldTolerance = 0.001f;
+		params.meshPreprocessParams = physx::PxMeshPreprocessingFlags(physx::PxMeshPreprocessingFlag::eWELD_VERTICES);
+		params.buildTriangleAdjacencies = false;
+
+		physx::PxTriangleMesh* mesh = physics.GetMeshCache().CreateTriangleMesh(*physics.GetPhysics(), params, mesh_desc);
+		if (mesh == nullptr)
+		{
+			return;
+		}
+
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxTriangleMeshGeometry(mesh), *material);
+		shape->setContactOffset(0.1f);
+		shape->setRestOffset(0.02f);
+		mesh->release();
+
+		for (const physx::PxTransform& pose : MeshPilePoses(count))
+		{
+			physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(pose);
+			body->attachShape(*shape);
+			AddMeshBody(physics, *body);
+		}
+
+		shape->release();
+	}
+
+	void CreateHullPile(PX::Physics& physics, int count, const PX::ConvexDecompositionDesc& desc)
+	{
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreatePyramid(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT, &mesh_data);
+
+		// Decomposed once, every body gets its own shapes over the same hulls
+		PX::ConvexDecomposer decomposer(physics);
+		PX::ConvexCompound compound = decomposer.Decompose(mesh_data, desc);
+		if (compound.hulls.empty())
+		{
+			return;
+		}
+
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+		for (const physx::PxTransform& pose : MeshPilePoses(count))
+		{
+			physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(pose);
+			PX::ConvexDecomposer::AttachCompound(*body, compound, *material);
+			AddMeshBody(physics, *body);
+		}
+
+		compound.Release();
+	}
+
+	// The sample models spawning, each body asks for its material and shape the way DynamicModel does. Unshared is how
+	// they did it before the registry, a material and a shape of their own per body that are never released
+	void CreateSpawn(PX::Physics& physics, int count, bool shared)
+	{
+		int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))));
+		float spacing = 1.5f;
+		float offset = static_cast<float>(side - 1) * spacing * 0.5f;
+
+		PX::ShapeRegistry& registry = physics.GetShapeRegistry();
+		physx::PxBoxGeometry geometry(HALF_EXTENT, HALF_EXTENT, HALF_EXTENT);
+
+		for (int i = 0; i < count; ++i)
+		{
+			physx::PxVec3 position(static_cast<float>(i % side) * spacing - offset, GROUND_Y + HALF_EXTENT, static_cast<float>(i / side) * spacing - offset);
+
+			if (shared)
+			{
+				physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+				CreateBody(physics, physx::PxTransform(position), *registry.AcquireShape(geometry, *material));
+			}
+			else
+			{
+				physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+				CreateBody(physics, physx::PxTransform(position), *physics.GetPhysics()->createShape(geometry, *material));
+			}
+		}
+	}
+
+	// Resting boxes with a rolling one percent of them knocked upwards every step, so most of the scene sleeps
+	void KickSleepers(std::vector<physx::PxRigidDynamic*>& bodies, size_t& next)
+	{
+		size_t count = std::max<size_t>(1, bodies.size() / 100);
+		for (size_t i = 0; i < count && !bodies.empty(); ++i)
+		{
+			physx::PxRigidDynamic* body = bodies[next];
+			body->addForce(physx::PxVec3(0.0f, 4.0f, 0.0f), physx::PxForceMode::eVELOCITY_CHANGE);
+			next = (next + 1) % bodies.size();
+		}
+	}
+
+	void CreateSharedSpawn(PX::Physics& physics, int count)
+	{
+		CreateSpawn(physics, count, true);
+	}
+
+	void CreateUnsharedSpawn(PX::Physics& physics, int count)
+	{
+		CreateSpawn(physics, count, false);
+	}
+}
+
+const std::vector<std::string>& Benchmark::GetStressKinds()
+{
+	static const std::vector<std::string> kinds = { "tower", "pyramid", "rain", "pile", "sdfpile", "hullpile", "spawn", "spawn-unshared", "sleepers" };
+	return kinds;
+}
+
+std::vector<int> Benchmark::GetDefaultStressSizes(const std::string& kind)
+{
+	if (kind == "tower" || kind == "pyramid")
+		return { 10, 20, 40 };
+	if (kind == "rain")
+		return { 1000, 4000, 16000 };
+	if (kind == "pile")
+		return { 500, 2000, 8000 };
+	if (kind == "sdfpile" || kind == "hullpile")
+		return { 50, 200, 800 };
+	if (kind == "spawn" || kind == "spawn-unshared" || kind == "sleepers")
+		return { 10000, 100000 };
+
+	return {};
+}
+
+Benchmark::Scene Benchmark::MakeStressScene(const std::string& kind, int size, const PX::ConvexDecompositionDesc& hulls)
+{
+	Scene scene;
+	scene.name = kind;
+	scene.size = size;
+
+	if (kind == "hullpile")
+	{
+		scene.create = [size, hulls](PX::Physics& physics)
+		{
+			CreateHullPile(physics, size, hulls);
+			CreatePlane(physics);
+		};
+
+		return scene;
+	}
+
+	if (kind == "sleepers")
+	{
+		struct Sleepers
+		{
+			std::vector<physx::PxRigidDynamic*> bodies;
+			size_t next = 0;
+		};
+
+		auto sleepers = std::make_shared<Sleepers>();
+		scene.create = [size, sleepers](PX::Physics& physics)
+		{
+			CreateSpawn(physics, size, true);
+			CreatePlane(physics);
+
+			std::vector<physx::PxActor*> actors(physics.GetScene()->getNbActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC));
+			physics.GetScene()->getActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC, actors.data(), static_cast<physx::PxU32>(actors.size()));
+			for (physx::PxActor* actor : actors)
+			{
+				sleepers->bodies.push_back(static_cast<physx::PxRigidDynamic*>(actor));
+			}
+		};
+
+		scene.update = [sleepers](PX::Physics&, double)
+		{
+			KickSleepers(sleepers->bodies, sleepers->next);
+		};
+
+		return scene;
+	}
+
+	void (*create)(PX::Physics&, int) = nullptr;
+	if (kind == "tower")
+		create = CreateTower;
+	else if (kind == "pyramid")
+		create = CreatePyramid;
+	else if (kind == "rain")
+		create = CreateRain;
+	else if (kind == "pile")
+		create = CreatePile;
+	else if (kind == "sdfpile")
+		create = CreateSdfPile;
+	else if (kind == "spawn")
+		create = CreateSharedSpawn;
+	else if (kind == "spawn-unshared")
+		create = CreateUnsharedSpawn;
+	else
+		return scene;
+
+	scene.create = [create, size](PX::Physics& physics)
+	{
+		create(physics, size);
+		CreatePlane(physics);
+	};
+
+	return scene;
+}
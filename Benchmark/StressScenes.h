@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ConvexDecomposition.h"
+#include "Scenes.h"
+
+namespace Benchmark
+{
+	// Scenes built to load the solver and the broadphase rather than to match a sample
+	//   tower   - a single column of size boxes
+	//   pyramid - a 2D pyramid of boxes, size boxes along the base
+	//   rain    - size boxes dropped in a loose grid from above the ground
+	//   pile    - size mixed boxes, spheres, capsules and convex pyramids dropped into one heap
+	//   sdfpile  - size DynamicSDF pyramids with SDF triangle meshes dropped into one heap
+	//   hullpile - the same heap with each pyramid a compound of convex hulls cut from the same mesh
+	//   spawn    - size resting boxes spawned the way the sample models do, sharing a material and shape through the registry
+	//   spawn-unshared - the same boxes with a material and shape created for each one
+	//   sleepers - size resting boxes with one percent of them knocked upwards every step, the rest asleep
+	const std::vector<std::string>& GetStressKinds();
+
+	// Sizes swept when none are given on the command line
+	std::vector<int> GetDefaultStressSizes(const std::string& kind);
+
+	// Returns a scene without a create function when kind isn't one of GetStressKinds, hulls only affects hullpile
+	Scene MakeStressScene(const std::string& kind, int size, const PX::ConvexDecompositionDesc& hulls = PX::ConvexDecompositionDesc());
+}
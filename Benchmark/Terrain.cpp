@@ -0,0 +1,451 @@
+#include "Terrain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	// Height field samples are 16 bit, this many steps cover the range from -heightScale to +heightScale
+	constexpr physx::PxReal SAMPLE_RANGE = 32767.0f;
+}
+
+PX::Terrain::Terrain(Physics& physics, const TerrainDesc& desc) : m_Physics(physics), m_Desc(desc)
+{
+	m_Desc.tileSamples = std::max(2, m_Desc.tileSamples);
+	m_Desc.loadRadius = std::max(0, m_Desc.loadRadius);
+	m_Desc.evictRadius = std::max(m_Desc.loadRadius, m_Desc.evictRadius);
+
+	m_Material = m_Physics.GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+	m_Thread = std::thread(&Terrain::StreamTiles, this);
+}
+
+PX::Terrain::~Terrain()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+		m_Requests.clear();
+	}
+
+	m_Wake.notify_all();
+	m_Thread.join();
+
+	// The scene can't lose actors mid step
+	m_Physics.FetchResults();
+
+	for (auto& entry : m_Tiles)
+	{
+		ReleaseTile(*entry.second);
+	}
+
+	for (std::unique_ptr<TerrainTile>& tile : m_Cooked)
+	{
+		ReleaseTile(*tile);
+	}
+
+	m_Physics.GetShapeRegistry().ReleaseMaterial(m_Material);
+}
+
+PX::TerrainTileKey PX::Terrain::GetTileKey(const physx::PxVec3& position) const
+{
+	physx::PxReal size = GetTileSize();
+	return TerrainTileKey(static_cast<int>(std::floor(position.x / size)), static_cast<int>(std::floor(position.z / size)));
+}
+
+bool PX::Terrain::IsWithin(const TerrainTileKey& key, int radius) const
+{
+	return std::abs(key.first - m_Focus.first) <= radius && std::abs(key.second - m_Focus.second) <= radius;
+}
+
+void PX::Terrain::SetFocus(const physx::PxVec3& position)
+{
+	m_Focus = GetTileKey(position);
+
+	std::vector<TerrainTileKey> missing;
+	for (int x = -m_Desc.loadRadius; x <= m_Desc.loadRadius; ++x)
+	{
+		for (int z = -m_Desc.loadRadius; z <= m_Desc.loadRadius; ++z)
+		{
+			TerrainTileKey key(m_Focus.first + x, m_Focus.second + z);
+			if (m_Tiles.find(key) == m_Tiles.end())
+			{
+				missing.push_back(key);
+			}
+		}
+	}
+
+	// Nearest first so the ground under the focus arrives before the horizon
+	std::sort(missing.begin(), missing.end(), [this](const TerrainTileKey& a, const TerrainTileKey& b)
+	{
+		int da = std::max(std::abs(a.first - m_Focus.first), std::abs(a.second - m_Focus.second));
+		int db = std::max(std::abs(b.first - m_Focus.first), std::abs(b.second - m_Focus.second));
+		return da < db;
+	});
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Requests the focus has moved away from are dropped before they're cooked
+		m_Requests.erase(std::remove_if(m_Requests.begin(), m_Requests.end(), [this](const TerrainTileKey& key)
+		{
+			bool stale = !IsWithin(key, m_Desc.loadRadius);
+			if (stale)
+			{
+				m_Queued.erase(std::remove(m_Queued.begin(), m_Queued.end(), key), m_Queued.end());
+			}
+
+			return stale;
+		}), m_Requests.end());
+
+		for (const TerrainTileKey& key : missing)
+		{
+			if (std::find(m_Queued.begin(), m_Queued.end(), key) == m_Queued.end())
+			{
+				m_Queued.push_back(key);
+				m_Requests.push_back(key);
+			}
+		}
+	}
+
+	m_Wake.notify_one();
+}
+
+bool PX::Terrain::Update()
+{
+	std::vector<std::unique_ptr<TerrainTile>> cooked;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		cooked.swap(m_Cooked);
+		for (const std::unique_ptr<TerrainTile>& tile : cooked)
+		{
+			m_Queued.erase(std::remove(m_Queued.begin(), m_Queued.end(), tile->key), m_Queued.end());
+		}
+	}
+
+	bool changed = false;
+	for (std::unique_ptr<TerrainTile>& tile : cooked)
+	{
+		// The focus may have moved on while it was cooking
+		if (!IsWithin(tile->key, m_Desc.evictRadius) || m_Tiles.find(tile->key) != m_Tiles.end())
+		{
+			ReleaseTile(*tile);
+			continue;
+		}
+
+		m_Physics.GetScene()->addActor(*tile->actor);
+		m_Tiles[tile->key] = std::move(tile);
+		m_Loads++;
+		changed = true;
+	}
+
+	for (auto it = m_Tiles.begin(); it != m_Tiles.end();)
+	{
+		if (IsWithin(it->first, m_Desc.evictRadius))
+		{
+			++it;
+			continue;
+		}
+
+		ReleaseTile(*it->second);
+		it = m_Tiles.erase(it);
+		m_Evictions++;
+		changed = true;
+	}
+
+	return changed;
+}
+
+void PX::Terrain::Flush()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Idle.wait(lock, [this]() { return m_Requests.empty() && m_InFlight == 0; });
+	}
+
+	Update();
+}
+
+PX::TerrainStats PX::Terrain::GetStats() const
+{
+	TerrainStats stats;
+	stats.loadedTiles = m_Tiles.size();
+	stats.loads = m_Loads;
+	stats.evictions = m_Evictions;
+
+	for (const auto& entry : m_Tiles)
+	{
+		stats.cookedBytes += entry.second->cookedBytes;
+		stats.sampleBytes += entry.second->heights.size() * sizeof(physx::PxReal);
+		stats.cookMs += entry.second->cookMs;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	stats.pendingTiles = m_Requests.size() + m_InFlight + m_Cooked.size();
+	return stats;
+}
+
+physx::PxReal PX::Terrain::GetHeight(physx::PxReal x, physx::PxReal z) const
+{
+	// A few octaves of crossed sine waves, smooth and the same at every tile edge
+	physx::PxReal height = 0.5f * std::sin(0.045f * x) * std::cos(0.06f * z)
+		+ 0.3f * std::sin(0.11f * x + 1.3f) * std::sin(0.09f * z + 0.7f)
+		+ 0.2f * std::sin(0.23f * x + 0.31f * z);
+
+	return m_Desc.baseHeight + m_Desc.heightScale * height;
+}
+
+void PX::Terrain::StreamTiles()
+{
+	for (;;)
+	{
+		TerrainTileKey key;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Wake.wait(lock, [this]() { return m_Stop || !m_Requests.empty(); });
+			if (m_Stop)
+			{
+				return;
+			}
+
+			key = m_Requests.front();
+			m_Requests.pop_front();
+			m_InFlight++;
+		}
+
+		std::unique_ptr<TerrainTile> tile = CookTile(key);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_InFlight--;
+		if (tile != nullptr)
+		{
+			m_Cooked.push_back(std::move(tile));
+		}
+		else
+		{
+			m_Queued.erase(std::remove(m_Queued.begin(), m_Queued.end(), key), m_Queued.end());
+		}
+
+		if (m_Requests.empty() && m_InFlight == 0)
+		{
+			m_Idle.notify_all();
+		}
+	}
+}
+
+std::unique_ptr<PX::TerrainTile> PX::Terrain::CookTile(const TerrainTileKey& key)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	auto tile = std::make_unique<TerrainTile>();
+	tile->key = key;
+	tile->origin = physx::PxVec3(static_cast<physx::PxReal>(key.first) * GetTileSize(), 0.0f, static_cast<physx::PxReal>(key.second) * GetTileSize());
+
+	int samples = m_Desc.tileSamples;
+	tile->heights.resize(static_cast<size_t>(samples) * samples);
+	for (int row = 0; row < samples; ++row)
+	{
+		for (int column = 0; column < samples; ++column)
+		{
+			physx::PxReal x = tile->origin.x + static_cast<physx::PxReal>(row) * m_Desc.sampleSpacing;
+			physx::PxReal z = tile->origin.z + static_cast<physx::PxReal>(column) * m_Desc.sampleSpacing;
+			tile->heights[static_cast<size_t>(row) * samples + column] = GetHeight(x, z);
+		}
+	}
+
+	// Cooked to a stream first so the size of what PhysX keeps can be reported
+	physx::PxDefaultMemoryOutputStream stream;
+	physx::PxShape* shape = m_Desc.triangleMesh ? CreateTriangleMeshShape(*tile, stream) : CreateHeightFieldShape(*tile, stream);
+	if (shape == nullptr)
+	{
+		return nullptr;
+	}
+
+	tile->cookedBytes = stream.getSize();
+
+	// Creating actors is thread safe, only adding them to the scene has to wait for Update
+	tile->actor = m_Physics.GetPhysics()->createRigidStatic(physx::PxTransform(tile->origin));
+	tile->actor->attachShape(*shape);
+	shape->release();
+
+	tile->cookMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return tile;
+}
+
+physx::PxShape* PX::Terrain::CreateHeightFieldShape(const TerrainTile& tile, physx::PxDefaultMemoryOutputStream& stream)
+{
+	int samples = m_Desc.tileSamples;
+	physx::PxReal height_scale = std::max(m_Desc.heightScale, 0.001f) / SAMPLE_RANGE;
+
+	// Quantised around baseHeight, the shape is lowered back by the same amount
+	std::vector<physx::PxHeightFieldSample> field(tile.heights.size());
+	for (size_t i = 0; i < field.size(); ++i)
+	{
+		physx::PxReal quantised = (tile.heights[i] - m_Desc.baseHeight) / height_scale;
+		field[i].height = static_cast<physx::PxI16>(std::max(-SAMPLE_RANGE, std::min(SAMPLE_RANGE, std::round(quantised))));
+		field[i].materialIndex0 = 0;
+		field[i].materialIndex1 = 0;
+	}
+
+	physx::PxHeightFieldDesc desc;
+	desc.format = physx::PxHeightFieldFormat::eS16_TM;
+	desc.nbRows = static_cast<physx::PxU32>(samples);
+	desc.nbColumns = static_cast<physx::PxU32>(samples);
+	desc.samples.data = field.data();
+	desc.samples.stride = sizeof(physx::PxHeightFieldSample);
+
+	if (!PxCookHeightField(desc, stream))
+	{
+		return nullptr;
+	}
+
+	physx::PxDefaultMemoryInputData input(stream.getData(), stream.getSize());
+	physx::PxHeightField* height_field = m_Physics.GetPhysics()->createHeightField(input);
+	if (height_field == nullptr)
+	{
+		return nullptr;
+	}
+
+	physx::PxHeightFieldGeometry geometry(height_field, physx::PxMeshGeometryFlags(), height_scale, m_Desc.sampleSpacing, m_Desc.sampleSpacing);
+	physx::PxShape* shape = m_Physics.GetPhysics()->createShape(geometry, *m_Material, true);
+	shape->setLocalPose(physx::PxTransform(physx::PxVec3(0.0f, m_Desc.baseHeight, 0.0f)));
+	height_field->release();
+	return shape;
+}
+
+physx::PxShape* PX::Terrain::CreateTriangleMeshShape(const TerrainTile& tile, physx::PxDefaultMemoryOutputStream& stream)
+{
+	int samples = m_Desc.tileSamples;
+
+	std::vector<physx::PxVec3> points(tile.heights.size());
+	for (int row = 0; row < samples; ++row)
+	{
+		for (int column = 0; column < samples; ++column)
+		{
+			size_t i = static_cast<size_t>(row) * samples + column;
+			points[i] = physx::PxVec3(static_cast<physx::PxReal>(row) * m_Desc.sampleSpacing, tile.heights[i], static_cast<physx::PxReal>(column) * m_Desc.sampleSpacing);
+		}
+	}
+
+	// Same split as the height field's default tessellation, facing up
+	std::vector<physx::PxU32> indices;
+	indices.reserve(static_cast<size_t>(samples - 1) * (samples - 1) * 6);
+	for (int row = 0; row + 1 < samples; ++row)
+	{
+		for (int column = 0; column + 1 < samples; ++column)
+		{
+			physx::PxU32 v00 = static_cast<physx::PxU32>(row * samples + column);
+			physx::PxU32 v01 = v00 + 1;
+			physx::PxU32 v10 = v00 + static_cast<physx::PxU32>(samples);
+			physx::PxU32 v11 = v10 + 1;
+
+			indices.insert(indices.end(), { v00, v01, v10, v10, v01, v11 });
+		}
+	}
+
+	physx::PxTriangleMeshDesc desc;
+	desc.points.count = static_cast<physx::PxU32>(points.size());
+	desc.points.stride = sizeof(physx::PxVec3);
+	desc.points.data = points.data();
+	desc.triangles.count = static_cast<physx::PxU32>(indices.size() / 3);
+	desc.triangles.stride = 3 * sizeof(physx::PxU32);
+	desc.triangles.data = indices.data();
+
+	physx::PxTolerancesScale scale;
+	physx::PxCookingParams params(scale);
+	params.buildTriangleAdjacencies = false;
+
+	if (!PxCookTriangleMesh(params, desc, stream))
+	{
+		return nullptr;
+	}
+
+	physx::PxDefaultMemoryInputData input(stream.getData(), stream.getSize());
+	physx::PxTriangleMesh* mesh = m_Physics.GetPhysics()->createTriangleMesh(input);
+	if (mesh == nullptr)
+	{
+		return nullptr;
+	}
+
+	physx::PxShape* shape = m_Physics.GetPhysics()->createShape(physx::PxTriangleMeshGeometry(mesh), *m_Material, true);
+	mesh->release();
+	return shape;
+}
+
+void PX::Terrain::ReleaseTile(TerrainTile& tile)
+{
+	if (tile.actor == nullptr)
+	{
+		return;
+	}
+
+	m_Physics.OnActorRemoved(tile.actor);
+	if (tile.actor->getScene() != nullptr)
+	{
+		m_Physics.GetScene()->removeActor(*tile.actor);
+	}
+
+	tile.actor->release();
+	tile.actor = nullptr;
+}
+
+void PX::Terrain::BuildRenderGrid(const TerrainTile& tile, int step, DX::MeshData* mesh_data) const
+{
+	int samples = m_Desc.tileSamples;
+	step = std::max(1, std::min(step, samples - 1));
+
+	// Every step-th sample plus the far edge, so neighbouring tiles still meet
+	std::vector<int> lines;
+	for (int i = 0; i < samples - 1; i += step)
+	{
+		lines.push_back(i);
+	}
+
+	lines.push_back(samples - 1);
+	int count = static_cast<int>(lines.size());
+
+	auto height = [&](int row, int column)
+	{
+		row = std::max(0, std::min(row, samples - 1));
+		column = std::max(0, std::min(column, samples - 1));
+		return tile.heights[static_cast<size_t>(row) * samples + column];
+	};
+
+	mesh_data->vertices.clear();
+	mesh_data->indices.clear();
+	mesh_data->vertices.reserve(static_cast<size_t>(count) * count);
+
+	for (int row : lines)
+	{
+		for (int column : lines)
+		{
+			// Normal from central differences over the full resolution samples
+			physx::PxReal dx = (height(row + 1, column) - height(row - 1, column)) / (2.0f * m_Desc.sampleSpacing);
+			physx::PxReal dz = (height(row, column + 1) - height(row, column - 1)) / (2.0f * m_Desc.sampleSpacing);
+			physx::PxVec3 normal = physx::PxVec3(-dx, 1.0f, -dz).getNormalized();
+
+			DX::Vertex vertex;
+			vertex.x = tile.origin.x + static_cast<physx::PxReal>(row) * m_Desc.sampleSpacing;
+			vertex.y = height(row, column);
+			vertex.z = tile.origin.z + static_cast<physx::PxReal>(column) * m_Desc.sampleSpacing;
+			vertex.nx = normal.x;
+			vertex.ny = normal.y;
+			vertex.nz = normal.z;
+			mesh_data->vertices.push_back(vertex);
+		}
+	}
+
+	mesh_data->indices.reserve(static_cast<size_t>(count - 1) * (count - 1) * 6);
+	for (int row = 0; row + 1 < count; ++row)
+	{
+		for (int column = 0; column + 1 < count; ++column)
+		{
+			UINT v00 = static_cast<UINT>(row * count + column);
+			UINT v01 = v00 + 1;
+			UINT v10 = v00 + static_cast<UINT>(count);
+			UINT v11 = v10 + 1;
+
+			mesh_data->indices.insert(mesh_data->indices.end(), { v00, v01, v10, v10, v01, v11 });
+		}
+	}
+}
@@ -0,0 +1,171 @@
+#include "TerrainStreaming.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include "Physics.h"
+#include "Terrain.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// Same seed every run so both terrain types get the same boxes
+	constexpr unsigned int SEED = 1234;
+
+	void DropBoxes(PX::Physics& physics, const PX::Terrain& terrain, int count, physx::PxReal extent)
+	{
+		physx::PxMaterial* material = physics.GetPhysics()->createMaterial(0.5f, 0.5f, 0.1f);
+		physx::PxShape* shape = physics.GetPhysics()->createShape(physx::PxBoxGeometry(0.5f, 0.5f, 0.5f), *material);
+
+		std::mt19937 random(SEED);
+		std::uniform_real_distribution<physx::PxReal> position(-extent, extent);
+
+		for (int i = 0; i < count; ++i)
+		{
+			physx::PxReal x = position(random);
+			physx::PxReal z = position(random);
+			physx::PxReal y = terrain.GetHeight(x, z) + 2.0f + static_cast<physx::PxReal>(i % 4);
+
+			physx::PxRigidDynamic* body = physics.GetPhysics()->createRigidDynamic(physx::PxTransform(physx::PxVec3(x, y, z)));
+			body->attachShape(*shape);
+			physx::PxRigidBodyExt::updateMassAndInertia(*body, 100.0f);
+			physics.GetScene()->addActor(*body);
+		}
+
+		shape->release();
+	}
+
+	Benchmark::TerrainResult RunOne(const Benchmark::TerrainOptions& options, int radius, bool triangle_mesh)
+	{
+		Benchmark::TerrainResult result;
+		result.triangleMesh = triangle_mesh;
+		result.radius = radius;
+
+		PX::JobSystemDesc job_desc;
+		job_desc.workerCount = options.threads;
+
+		PX::Physics physics;
+		physics.SetJobSystemDesc(job_desc);
+		physics.Setup();
+
+		PX::TerrainDesc desc;
+		desc.tileSamples = options.tileSamples;
+		desc.loadRadius = radius;
+		desc.evictRadius = radius;
+		desc.triangleMesh = triangle_mesh;
+
+		{
+			PX::Terrain terrain(physics, desc);
+
+			// Tiles are centred on the focus tile, so start in the middle of tile 0
+			physx::PxReal half_tile = terrain.GetTileSize() * 0.5f;
+			physx::PxVec3 focus(half_tile, 0.0f, half_tile);
+
+			auto load_start = Clock::now();
+			terrain.SetFocus(focus);
+			terrain.Flush();
+			result.loadMs = ElapsedMs(load_start);
+
+			PX::TerrainStats stats = terrain.GetStats();
+			result.tiles = stats.loadedTiles;
+			result.cookMs = stats.cookMs;
+			result.cookedBytes = stats.cookedBytes;
+
+			DropBoxes(physics, terrain, options.bodies, terrain.GetTileSize() * (static_cast<physx::PxReal>(radius) + 0.5f));
+			result.physxBytes = physics.GetAllocator().GetLiveBytes();
+
+			for (int i = 0; i < options.warmupSteps; ++i)
+			{
+				physics.Simulate(options.stepSize);
+			}
+
+			auto run_start = Clock::now();
+			double contact_pairs = 0.0;
+			for (int i = 0; i < options.steps; ++i)
+			{
+				physics.Simulate(options.stepSize);
+				contact_pairs += physics.GetStatsRecorder().GetLatest().discreteContactPairs;
+			}
+
+			if (options.steps > 0)
+			{
+				result.meanStepMs = ElapsedMs(run_start) / options.steps;
+				result.contactPairs = contact_pairs / options.steps;
+			}
+
+			// Walk along x at a steady pace, Update between steps brings in the tiles the stream thread has finished
+			int walk_steps = std::max(1, options.walkTiles) * 60;
+			physx::PxReal walk_speed = terrain.GetTileSize() * static_cast<physx::PxReal>(options.walkTiles) / static_cast<physx::PxReal>(walk_steps);
+
+			auto walk_start = Clock::now();
+			for (int i = 0; i < walk_steps; ++i)
+			{
+				focus.x += walk_speed;
+				terrain.SetFocus(focus);
+				terrain.Update();
+				physics.Simulate(options.stepSize);
+			}
+
+			result.walkStepMs = ElapsedMs(walk_start) / walk_steps;
+
+			terrain.Flush();
+			PX::TerrainStats walked = terrain.GetStats();
+			result.walkLoads = walked.loads - stats.loads;
+			result.walkEvictions = walked.evictions - stats.evictions;
+		}
+
+		return result;
+	}
+}
+
+std::vector<Benchmark::TerrainResult> Benchmark::RunTerrain(const TerrainOptions& options)
+{
+	std::vector<TerrainResult> results;
+	for (int radius : options.radii)
+	{
+		for (bool triangle_mesh : { false, true })
+		{
+			results.push_back(RunOne(options, std::max(0, radius), triangle_mesh));
+		}
+	}
+
+	return results;
+}
+
+void Benchmark::PrintTerrain(std::ostream& stream, const std::vector<TerrainResult>& results)
+{
+	stream << std::left << std::setw(12) << "Tiles as" << std::right
+		<< std::setw(8) << "Radius"
+		<< std::setw(8) << "Tiles"
+		<< std::setw(11) << "Load ms"
+		<< std::setw(11) << "Cook ms"
+		<< std::setw(12) << "Cooked KB"
+		<< std::setw(12) << "PhysX KB"
+		<< std::setw(10) << "Step ms"
+		<< std::setw(10) << "Contacts"
+		<< std::setw(10) << "Walk ms"
+		<< std::setw(8) << "Loads"
+		<< std::setw(8) << "Evicts" << '\n';
+
+	for (const TerrainResult& result : results)
+	{
+		stream << std::left << std::setw(12) << (result.triangleMesh ? "trimesh" : "heightfield") << std::right << std::fixed
+			<< std::setw(8) << result.radius
+			<< std::setw(8) << result.tiles
+			<< std::setprecision(2) << std::setw(11) << result.loadMs
+			<< std::setw(11) << result.cookMs
+			<< std::setw(12) << result.cookedBytes / 1024
+			<< std::setw(12) << result.physxBytes / 1024
+			<< std::setprecision(3) << std::setw(10) << result.meanStepMs
+			<< std::setprecision(1) << std::setw(10) << result.contactPairs
+			<< std::setprecision(3) << std::setw(10) << result.walkStepMs
+			<< std::setw(8) << result.walkLoads
+			<< std::setw(8) << result.walkEvictions << '\n';
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	struct TerrainOptions
+	{
+		// Load radii to sweep, a radius of r keeps (2r + 1)^2 tiles
+		std::vector<int> radii = { 0, 1, 2, 4, 6 };
+		int tileSamples = 65;
+
+		// Boxes dropped across the loaded tiles so the terrain has contacts to generate
+		int bodies = 500;
+
+		int steps = 300;
+		int warmupSteps = 60;
+		double stepSize = 1.0 / 60.0;
+
+		// Tiles the focus walks across after the timed steps, loading and evicting as it goes
+		int walkTiles = 4;
+
+		unsigned int threads = 0;
+	};
+
+	struct TerrainResult
+	{
+		bool triangleMesh = false;
+		int radius = 0;
+		size_t tiles = 0;
+
+		// Wall time to stream the first set in, and the cook time of those tiles added up
+		double loadMs = 0.0;
+		double cookMs = 0.0;
+
+		// What PhysX keeps of the cooked tiles, and the whole PhysX heap with them loaded
+		size_t cookedBytes = 0;
+		std::int64_t physxBytes = 0;
+
+		double meanStepMs = 0.0;
+		double contactPairs = 0.0;
+
+		// Mean step while the focus moves and tiles stream behind it
+		double walkStepMs = 0.0;
+		std::uint64_t walkLoads = 0;
+		std::uint64_t walkEvictions = 0;
+	};
+
+	// Each radius once with height field tiles and once with triangle mesh tiles cooked from the same samples
+	std::vector<TerrainResult> RunTerrain(const TerrainOptions& options);
+
+	void PrintTerrain(std::ostream& stream, const std::vector<TerrainResult>& results);
+}
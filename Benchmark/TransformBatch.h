@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include "PxPhysicsAPI.h"
+#include "JobSystem.h"
+
+namespace PX
+{
+	// Row-major 4x4 laid out the way the world constant buffer takes it, already transposed for HLSL's column-major packing
+	struct alignas(16) ShaderMatrix
+	{
+		float m[4][4];
+	};
+
+	// The world matrix and the inverse the shader transforms normals with, the same pair DX::Shader::UpdateWorldBuffer
+	// builds with XMMatrixTranspose and XMMatrixInverse. A pose is a rotation and a translation, so the inverse is the
+	// transposed rotation and the rotated, negated translation
+	void PoseToMatrices(const physx::PxTransform& pose, ShaderMatrix& world, ShaderMatrix& normal);
+
+	// Four poses at a time in SSE registers, one lane per pose and one register per matrix element, the rest one by one
+	void PosesToMatrices(const physx::PxTransform* poses, size_t count, ShaderMatrix* world, ShaderMatrix* normal);
+
+	// The same split across the job system in chunks of grain_size poses
+	void PosesToMatrices(JobSystem& jobs, const physx::PxTransform* poses, size_t count, ShaderMatrix* world, ShaderMatrix* normal, size_t grain_size = 4096);
+}
@@ -0,0 +1,269 @@
+#include "TransformBench.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include "JobSystem.h"
+#include "TransformBatch.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// Same seed every run so every path converts the same poses
+	constexpr unsigned int SEED = 1234;
+
+	std::vector<physx::PxTransform> RandomPoses(int count)
+	{
+		std::mt19937 random(SEED);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+
+		std::vector<physx::PxTransform> poses;
+		poses.reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			physx::PxQuat q(component(random), component(random), component(random), component(random));
+			if (q.magnitudeSquared() < 1e-4f)
+			{
+				q = physx::PxQuat(physx::PxIdentity);
+			}
+
+			poses.emplace_back(physx::PxVec3(position(random), position(random), position(random)), q.getNormalized());
+		}
+
+		return poses;
+	}
+
+	using Matrix = float[4][4];
+
+	void Multiply(const Matrix& a, const Matrix& b, Matrix& out)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				out[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
+			}
+		}
+	}
+
+	// Cofactor expansion, the work XMMatrixInverse does for any matrix
+	void Inverse(const Matrix& m, Matrix& out)
+	{
+		float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+		float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+		float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		float scale = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+		out[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * scale;
+		out[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * scale;
+		out[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * scale;
+		out[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * scale;
+
+		out[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * scale;
+		out[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * scale;
+		out[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * scale;
+		out[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * scale;
+
+		out[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * scale;
+		out[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * scale;
+		out[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * scale;
+		out[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * scale;
+
+		out[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * scale;
+		out[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * scale;
+		out[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * scale;
+		out[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * scale;
+	}
+
+	void Transpose(const Matrix& m, PX::ShaderMatrix& out)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				out.m[i][j] = m[j][i];
+			}
+		}
+	}
+
+	// DynamicModel::Update's matrix and UpdateWorldBuffer's transposes and inverse, without DirectXMath so it builds here
+	void ScalarToMatrices(const physx::PxTransform& pose, PX::ShaderMatrix& world, PX::ShaderMatrix& normal)
+	{
+		const physx::PxQuat& q = pose.q;
+		Matrix identity = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+		Matrix rotation =
+		{
+			{ 1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.z * q.w), 2.0f * (q.x * q.z - q.y * q.w), 0.0f },
+			{ 2.0f * (q.x * q.y - q.z * q.w), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.x * q.w), 0.0f },
+			{ 2.0f * (q.x * q.z + q.y * q.w), 2.0f * (q.y * q.z - q.x * q.w), 1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0.0f },
+			{ 0.0f, 0.0f, 0.0f, 1.0f }
+		};
+		Matrix translation = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { pose.p.x, pose.p.y, pose.p.z, 1 } };
+
+		Matrix rotated;
+		Matrix combined;
+		Multiply(identity, rotation, rotated);
+		Multiply(rotated, translation, combined);
+
+		Matrix inverse;
+		Inverse(combined, inverse);
+
+		Transpose(combined, world);
+		Transpose(inverse, normal);
+	}
+
+	double MaxError(const std::vector<PX::ShaderMatrix>& a, const std::vector<PX::ShaderMatrix>& b)
+	{
+		double error = 0.0;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				for (int k = 0; k < 4; ++k)
+				{
+					error = std::max(error, static_cast<double>(std::fabs(a[i].m[j][k] - b[i].m[j][k])));
+				}
+			}
+		}
+
+		return error;
+	}
+
+	Benchmark::TransformResult RunPath(PX::JobSystem& jobs, const std::vector<physx::PxTransform>& poses, int passes, Benchmark::TransformPath path,
+		std::vector<PX::ShaderMatrix>& world, std::vector<PX::ShaderMatrix>& normal)
+	{
+		Benchmark::TransformResult result;
+		result.path = path;
+		result.count = static_cast<int>(poses.size());
+		result.passes = passes;
+
+		size_t count = poses.size();
+		auto start = Clock::now();
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			switch (path)
+			{
+			case Benchmark::TransformPath::Scalar:
+				for (size_t i = 0; i < count; ++i)
+				{
+					ScalarToMatrices(poses[i], world[i], normal[i]);
+				}
+				break;
+			case Benchmark::TransformPath::ScalarRigid:
+				for (size_t i = 0; i < count; ++i)
+				{
+					PX::PoseToMatrices(poses[i], world[i], normal[i]);
+				}
+				break;
+			case Benchmark::TransformPath::Simd:
+				PX::PosesToMatrices(poses.data(), count, world.data(), normal.data());
+				break;
+			case Benchmark::TransformPath::SimdParallel:
+				PX::PosesToMatrices(jobs, poses.data(), count, world.data(), normal.data());
+				break;
+			}
+		}
+
+		result.meanMs = ElapsedMs(start) / static_cast<double>(passes);
+		result.nsPerPose = count > 0 ? result.meanMs * 1e6 / static_cast<double>(count) : 0.0;
+		return result;
+	}
+}
+
+const char* Benchmark::GetTransformPathName(TransformPath path)
+{
+	switch (path)
+	{
+	case TransformPath::Scalar: return "scalar";
+	case TransformPath::ScalarRigid: return "scalar-rigid";
+	case TransformPath::Simd: return "simd";
+	case TransformPath::SimdParallel: return "simd-parallel";
+	}
+
+	return "unknown";
+}
+
+std::vector<Benchmark::TransformResult> Benchmark::RunTransforms(const TransformOptions& options)
+{
+	PX::JobSystemDesc job_desc;
+	job_desc.workerCount = options.threads;
+	PX::JobSystem jobs(job_desc);
+
+	std::vector<TransformResult> results;
+	for (int count : options.counts)
+	{
+		count = std::max(1, count);
+		std::vector<physx::PxTransform> poses = RandomPoses(count);
+		int passes = std::max(5, options.targetPoses / count);
+
+		std::vector<PX::ShaderMatrix> reference_world(count);
+		std::vector<PX::ShaderMatrix> reference_normal(count);
+		std::vector<PX::ShaderMatrix> world(count);
+		std::vector<PX::ShaderMatrix> normal(count);
+
+		for (TransformPath path : { TransformPath::Scalar, TransformPath::ScalarRigid, TransformPath::Simd, TransformPath::SimdParallel })
+		{
+			bool reference = path == TransformPath::Scalar;
+			TransformResult result = RunPath(jobs, poses, passes, path, reference ? reference_world : world, reference ? reference_normal : normal);
+			if (!reference)
+			{
+				result.maxError = std::max(MaxError(reference_world, world), MaxError(reference_normal, normal));
+			}
+
+			results.push_back(result);
+		}
+	}
+
+	return results;
+}
+
+void Benchmark::PrintTransforms(std::ostream& stream, const std::vector<TransformResult>& results)
+{
+	stream << std::left << std::setw(16) << "Path" << std::right
+		<< std::setw(10) << "Poses"
+		<< std::setw(9) << "Passes"
+		<< std::setw(12) << "Mean ms"
+		<< std::setw(10) << "ns/pose"
+		<< std::setw(12) << "Max error"
+		<< std::setw(10) << "Speedup" << '\n';
+
+	for (const TransformResult& result : results)
+	{
+		double baseline = 0.0;
+		for (const TransformResult& other : results)
+		{
+			if (other.path == TransformPath::Scalar && other.count == result.count)
+			{
+				baseline = other.meanMs;
+			}
+		}
+
+		stream << std::left << std::setw(16) << GetTransformPathName(result.path) << std::right << std::fixed
+			<< std::setw(10) << result.count
+			<< std::setw(9) << result.passes
+			<< std::setprecision(3) << std::setw(12) << result.meanMs
+			<< std::setprecision(2) << std::setw(10) << result.nsPerPose
+			<< std::scientific << std::setprecision(1) << std::setw(12) << result.maxError << std::fixed
+			<< std::setprecision(2) << std::setw(9) << (result.meanMs > 0.0 ? baseline / result.meanMs : 0.0) << "x\n";
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+namespace Benchmark
+{
+	enum class TransformPath
+	{
+		// One pose at a time, identity times rotation times translation and a general 4x4 inverse, the way
+		// DynamicModel::Update and DX::Shader::UpdateWorldBuffer do it
+		Scalar,
+
+		// PX::PoseToMatrices one pose at a time, the rigid shortcut without SIMD
+		ScalarRigid,
+
+		// PX::PosesToMatrices four lanes at a time on the calling thread, and split across the job system
+		Simd,
+		SimdParallel
+	};
+
+	const char* GetTransformPathName(TransformPath path);
+
+	struct TransformOptions
+	{
+		// Poses converted per pass, a list sweeps them
+		std::vector<int> counts = { 1000, 100000, 1000000 };
+
+		// Passes over the array are repeated until about this many poses are converted
+		int targetPoses = 20000000;
+
+		unsigned int threads = 0;
+	};
+
+	struct TransformResult
+	{
+		TransformPath path = TransformPath::Scalar;
+		int count = 0;
+		int passes = 0;
+
+		double meanMs = 0.0;
+		double nsPerPose = 0.0;
+
+		// Largest element difference from the scalar path's matrices
+		double maxError = 0.0;
+	};
+
+	// Every count down every path on the same random poses
+	std::vector<TransformResult> RunTransforms(const TransformOptions& options);
+
+	// Speedup is the scalar path's mean over each path's at the same count
+	void PrintTransforms(std::ostream& stream, const std::vector<TransformResult>& results);
+}
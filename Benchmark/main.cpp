@@ -0,0 +1,465 @@
+#include "Cooking.h"
+#include "EntityBench.h"
+#include "EventsBench.h"
+#include "Runner.h"
+#include "SdfTuner.h"
+#include "SpawnChurn.h"
+#include "GeometryGenerator.h"
+#include "LevelLoad.h"
+#include "StressScenes.h"
+#include "TerrainStreaming.h"
+#include "TransformBench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cout << "Usage: Benchmark [options]\n"
+			<< "  --scene <name|all>   Scene to run, default all\n"
+			<< "  --steps <n>          Timed steps per scene, default 1000\n"
+			<< "  --warmup <n>         Untimed steps before timing, default 60\n"
+			<< "  --step-size <s>      Seconds per step, default 1/60\n"
+			<< "  --threads <n,n,...>  PhysX worker threads, 0 sizes from the hardware, a list sweeps them\n"
+			<< "  --stress <k,k,...>   Run stress scenes instead: tower, pyramid, rain, pile, sdfpile, hullpile, spawn, spawn-unshared, sleepers or all\n"
+			<< "  --sizes <n,n,...>    Stress scene sizes to sweep, each kind has its own default\n"
+			<< "  --hulls <n>          Most convex hulls per hullpile pyramid, default 8\n"
+			<< "  --hull-verts <n>     Vertex limit of each hull, 8 to 256, default 32\n"
+			<< "  --pvd <t,t,...>      PVD transports to run with: none, socket or file, default none\n"
+			<< "  --pvd-flags <f,...>  PVD instrumentation: debug, profile, memory or all, default debug\n"
+			<< "  --pvd-file <path>    Capture written by the file transport, default PhysX.pxd2\n"
+			<< "  --no-mesh-cache      Cook every mesh instead of reading it back from MeshCache/\n"
+			<< "  --cook <n>           Cook n unique meshes in one batch per thread count instead of stepping scenes\n"
+			<< "  --cook-convex        Cook convex hulls instead of triangle meshes\n"
+			<< "  --cook-direct        Insert the cooked meshes directly, skipping the stream\n"
+			<< "  --churn <n>          Spawn n boxes a step and despawn them later, pooled and not, instead of stepping scenes\n"
+			<< "  --churn-lifetime <n> Steps each churned box lives, default 60\n"
+			<< "  --churn-prewarm <n>  Boxes the pools start with, default half of what's alive at once\n"
+			<< "  --load <n,n,...>     Load levels of n actors serially and through PX::ActorBatch, default 10000,100000\n"
+			<< "  --terrain            Stream terrain tiles at each load radius as height fields and as triangle meshes\n"
+			<< "  --terrain-radii <n,...> Load radii the terrain run sweeps, default 0,1,2,4,6\n"
+			<< "  --entities <n,...>   Update n bodies as an object each and from PX::EntityStore, default 1000,10000,100000\n"
+			<< "  --events <n,...>     Report contacts of n resting boxes every step, in parallel, throttled and filtered, default 10000\n"
+			<< "  --transforms <n,...> Convert n poses to world and normal matrices, scalar and SIMD, default 1000,100000,1000000\n"
+			<< "  --tune-sdf           Cook DynamicSDF's pyramid at each SDF spacing and subgrid size and pick the cheapest\n"
+			<< "  --write-mesh-pack    Gather MeshCache/ into one mapped pack after the runs\n"
+			<< "  --csv <path>         Also write the results as CSV\n"
+			<< "  --list               List the scenes\n";
+	}
+
+	// "1,2,8" to { 1, 2, 8 }, anything that isn't a number is dropped
+	std::vector<int> ParseList(const std::string& text)
+	{
+		std::vector<int> values;
+		std::stringstream stream(text);
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			if (!item.empty() && item.find_first_not_of("0123456789") == std::string::npos)
+			{
+				values.push_back(std::atoi(item.c_str()));
+			}
+		}
+
+		return values;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Benchmark::Options options;
+	std::string scene_name = "all";
+	std::string stress_kind;
+	std::string csv_path;
+	bool write_mesh_pack = false;
+	Benchmark::CookingOptions cooking;
+	bool cook = false;
+	bool tune_sdf = false;
+	Benchmark::SpawnChurnOptions churn;
+	bool run_churn = false;
+	Benchmark::LevelLoadOptions level_load;
+	bool run_load = false;
+	Benchmark::TerrainOptions terrain;
+	bool run_terrain = false;
+	Benchmark::EntityOptions entities;
+	bool run_entities = false;
+	Benchmark::EventOptions events;
+	bool run_events = false;
+	Benchmark::TransformOptions transforms;
+	bool run_transforms = false;
+	std::vector<int> sizes;
+	PX::ConvexDecompositionDesc hull_desc;
+	std::vector<int> thread_counts = { 0 };
+	std::vector<PX::PvdTransport> pvd_transports = { PX::PvdTransport::None };
+	bool pvd_valid = true;
+
+	std::vector<Benchmark::Scene> scenes = Benchmark::GetSampleScenes();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (arg == "--scene" && has_value)
+			scene_name = argv[++i];
+		else if (arg == "--steps" && has_value)
+			options.steps = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--warmup" && has_value)
+			options.warmupSteps = std::max(0, std::atoi(argv[++i]));
+		else if (arg == "--step-size" && has_value)
+			options.stepSize = std::atof(argv[++i]);
+		else if (arg == "--threads" && has_value)
+			thread_counts = ParseList(argv[++i]);
+		else if (arg == "--stress" && has_value)
+			stress_kind = argv[++i];
+		else if (arg == "--sizes" && has_value)
+			sizes = ParseList(argv[++i]);
+		else if (arg == "--hulls" && has_value)
+			hull_desc.maxHulls = static_cast<physx::PxU32>(std::max(1, std::atoi(argv[++i])));
+		else if (arg == "--hull-verts" && has_value)
+			hull_desc.vertexLimit = static_cast<physx::PxU16>(std::min(256, std::max(8, std::atoi(argv[++i]))));
+		else if (arg == "--pvd" && has_value)
+		{
+			pvd_transports.clear();
+			std::stringstream stream(argv[++i]);
+			std::string name;
+			while (std::getline(stream, name, ','))
+			{
+				PX::PvdTransport transport;
+				pvd_valid = pvd_valid && PX::ParsePvdTransport(name, transport);
+				pvd_transports.push_back(transport);
+			}
+		}
+		else if (arg == "--pvd-flags" && has_value)
+			pvd_valid = pvd_valid && PX::ParsePvdFlags(argv[++i], options.pvd.flags);
+		else if (arg == "--pvd-file" && has_value)
+			options.pvd.filePath = argv[++i];
+		else if (arg == "--no-mesh-cache")
+			options.meshCache = false;
+		else if (arg == "--cook" && has_value)
+		{
+			cook = true;
+			cooking.meshes = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--cook-convex")
+			cooking.convex = true;
+		else if (arg == "--cook-direct")
+			cooking.directInsertion = true;
+		else if (arg == "--churn" && has_value)
+		{
+			run_churn = true;
+			churn.spawnsPerStep = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--churn-lifetime" && has_value)
+			churn.lifetimeSteps = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--churn-prewarm" && has_value)
+			churn.prewarm = std::max(0, std::atoi(argv[++i]));
+		else if (arg == "--load")
+		{
+			run_load = true;
+			if (has_value && argv[i + 1][0] != '-')
+				level_load.counts = ParseList(argv[++i]);
+		}
+		else if (arg == "--terrain")
+			run_terrain = true;
+		else if (arg == "--terrain-radii" && has_value)
+			terrain.radii = ParseList(argv[++i]);
+		else if (arg == "--entities")
+		{
+			run_entities = true;
+			if (has_value && argv[i + 1][0] != '-')
+				entities.counts = ParseList(argv[++i]);
+		}
+		else if (arg == "--events")
+		{
+			run_events = true;
+			if (has_value && argv[i + 1][0] != '-')
+				events.counts = ParseList(argv[++i]);
+		}
+		else if (arg == "--transforms")
+		{
+			run_transforms = true;
+			if (has_value && argv[i + 1][0] != '-')
+				transforms.counts = ParseList(argv[++i]);
+		}
+		else if (arg == "--tune-sdf")
+			tune_sdf = true;
+		else if (arg == "--write-mesh-pack")
+			write_mesh_pack = true;
+		else if (arg == "--csv" && has_value)
+			csv_path = argv[++i];
+		else if (arg == "--list")
+		{
+			for (const Benchmark::Scene& scene : scenes)
+			{
+				std::cout << scene.name << '\n';
+			}
+
+			for (const std::string& kind : Benchmark::GetStressKinds())
+			{
+				std::cout << kind << " (--stress)\n";
+			}
+
+			return 0;
+		}
+		else
+		{
+			PrintUsage();
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	if (options.stepSize <= 0.0)
+	{
+		std::cout << "Error: --step-size has to be positive\n";
+		return 1;
+	}
+
+	if (!pvd_valid || pvd_transports.empty())
+	{
+		std::cout << "Error: unknown --pvd transport or --pvd-flags instrumentation, --help lists them\n";
+		return 1;
+	}
+
+	if (thread_counts.empty())
+	{
+		std::cout << "Error: --threads needs a number or a comma separated list\n";
+		return 1;
+	}
+
+	if (tune_sdf)
+	{
+		PX::Physics physics;
+		physics.Setup();
+
+		DX::MeshData mesh_data;
+		GeometryGenerator::CreatePyramid(1.0f, 1.0f, 1.0f, &mesh_data);
+
+		physx::PxTolerancesScale scale;
+		physx::PxCookingParams params(scale);
+		params.meshWeldTolerance = 0.001f;
+		params.meshPreprocessParams = physx::PxMeshPreprocessingFlags(physx::PxMeshPreprocessingFlag::eWELD_VERTICES);
+		params.buildTriangleAdjacencies = false;
+
+		std::cout << "Tuning the SDF with " << PX::GetSdfConstructionThreads() << " construction threads...\n\n";
+		PX::SdfTuner tuner(physics);
+		PX::SdfTuner::PrintResults(std::cout, tuner.Run(mesh_data, params));
+		return 0;
+	}
+
+	if (cook)
+	{
+		std::vector<Benchmark::CookingResult> cook_results;
+		for (int threads : thread_counts)
+		{
+			cooking.threads = static_cast<unsigned int>(threads);
+			std::cout << "Cooking " << cooking.meshes << " meshes with " << (threads > 0 ? std::to_string(threads) : std::string("auto")) << " threads...\n";
+			cook_results.push_back(Benchmark::RunCooking(cooking));
+		}
+
+		std::cout << '\n';
+		Benchmark::PrintCooking(std::cout, cook_results);
+		return 0;
+	}
+
+	if (run_churn)
+	{
+		churn.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Spawning " << churn.spawnsPerStep << " boxes a step for " << churn.steps << " steps down each path...\n\n";
+		Benchmark::PrintSpawnChurn(std::cout, Benchmark::RunSpawnChurn(churn));
+		return 0;
+	}
+
+	if (run_load)
+	{
+		if (level_load.counts.empty())
+		{
+			std::cout << "Error: --load needs a number or a comma separated list\n";
+			return 1;
+		}
+
+		level_load.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Loading levels of " << level_load.counts.size() << " sizes down each path...\n\n";
+		Benchmark::PrintLevelLoad(std::cout, Benchmark::RunLevelLoad(level_load));
+		return 0;
+	}
+
+	if (run_terrain)
+	{
+		if (terrain.radii.empty())
+		{
+			std::cout << "Error: --terrain-radii needs a number or a comma separated list\n";
+			return 1;
+		}
+
+		terrain.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Streaming terrain at " << terrain.radii.size() << " load radii...\n\n";
+		Benchmark::PrintTerrain(std::cout, Benchmark::RunTerrain(terrain));
+		return 0;
+	}
+
+	if (run_entities)
+	{
+		if (entities.counts.empty())
+		{
+			std::cout << "Error: --entities needs a number or a comma separated list\n";
+			return 1;
+		}
+
+		entities.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Updating " << entities.counts.size() << " scene sizes as objects and as entities...\n\n";
+		Benchmark::PrintEntities(std::cout, Benchmark::RunEntities(entities));
+		return 0;
+	}
+
+	if (run_events)
+	{
+		if (events.counts.empty())
+		{
+			std::cout << "Error: --events needs a number or a comma separated list\n";
+			return 1;
+		}
+
+		events.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Reporting contacts at " << events.counts.size() << " scene sizes down each path...\n\n";
+		Benchmark::PrintEvents(std::cout, Benchmark::RunEvents(events));
+		return 0;
+	}
+
+	if (run_transforms)
+	{
+		if (transforms.counts.empty())
+		{
+			std::cout << "Error: --transforms needs a number or a comma separated list\n";
+			return 1;
+		}
+
+		transforms.threads = static_cast<unsigned int>(thread_counts.front());
+		std::cout << "Converting poses at " << transforms.counts.size() << " counts down each path...\n\n";
+		Benchmark::PrintTransforms(std::cout, Benchmark::RunTransforms(transforms));
+		return 0;
+	}
+
+	// A stress run replaces the sample scenes with every kind and size asked for
+	if (!stress_kind.empty())
+	{
+		scenes.clear();
+		scene_name = "all";
+
+		std::vector<std::string> kinds;
+		std::stringstream stream(stress_kind);
+		std::string name;
+		while (std::getline(stream, name, ','))
+		{
+			kinds.push_back(name);
+		}
+
+		for (const std::string& kind : Benchmark::GetStressKinds())
+		{
+			if (std::find(kinds.begin(), kinds.end(), "all") == kinds.end() && std::find(kinds.begin(), kinds.end(), kind) == kinds.end())
+			{
+				continue;
+			}
+
+			for (int size : sizes.empty() ? Benchmark::GetDefaultStressSizes(kind) : sizes)
+			{
+				scenes.push_back(Benchmark::MakeStressScene(kind, std::max(1, size), hull_desc));
+			}
+		}
+
+		if (scenes.empty())
+		{
+			std::cout << "Error: no stress scene called " << stress_kind << ", --list shows them\n";
+			return 1;
+		}
+	}
+
+	std::vector<Benchmark::Result> results;
+	for (const Benchmark::Scene& scene : scenes)
+	{
+		if (scene_name != "all" && scene_name != scene.name)
+		{
+			continue;
+		}
+
+		for (PX::PvdTransport transport : pvd_transports)
+		{
+			options.pvd.transport = transport;
+
+			for (int threads : thread_counts)
+			{
+				options.threads = static_cast<unsigned int>(threads);
+
+				std::cout << "Running " << scene.name;
+				if (scene.size > 0)
+				{
+					std::cout << " N=" << scene.size;
+				}
+
+				std::cout << " with " << (threads > 0 ? std::to_string(threads) : std::string("auto")) << " threads";
+				if (transport != PX::PvdTransport::None)
+				{
+					std::cout << " and PVD over " << PX::GetPvdTransportName(transport);
+				}
+
+				std::cout << "...\n";
+				results.push_back(Benchmark::Run(scene, options));
+			}
+		}
+	}
+
+	if (results.empty())
+	{
+		std::cout << "Error: no scene called " << scene_name << ", --list shows them\n";
+		return 1;
+	}
+
+	std::cout << '\n';
+	Benchmark::PrintResults(std::cout, results);
+
+	bool cooked = std::any_of(results.begin(), results.end(), [](const Benchmark::Result& result) { return result.cacheHits + result.cacheMisses > 0; });
+	if (cooked)
+	{
+		std::cout << '\n';
+		Benchmark::PrintMeshCache(std::cout, results);
+	}
+
+	if (pvd_transports.size() > 1 || pvd_transports.front() != PX::PvdTransport::None)
+	{
+		std::cout << '\n';
+		Benchmark::PrintPvdOverhead(std::cout, results);
+	}
+
+	bool sdf_pile = std::any_of(results.begin(), results.end(), [](const Benchmark::Result& result) { return result.scene == "sdfpile"; });
+	bool hull_pile = std::any_of(results.begin(), results.end(), [](const Benchmark::Result& result) { return result.scene == "hullpile"; });
+	if (sdf_pile && hull_pile)
+	{
+		std::cout << '\n';
+		Benchmark::PrintCompoundComparison(std::cout, results);
+	}
+
+	if (thread_counts.size() > 1 || !stress_kind.empty())
+	{
+		std::cout << '\n';
+		Benchmark::PrintScalingTable(std::cout, results);
+	}
+	std::cout << "\nProcess peak resident memory: " << Benchmark::GetPeakResidentBytes() / 1024 << " KB\n";
+
+	// Later runs then create their cooked meshes straight out of the mapping
+	if (write_mesh_pack)
+	{
+		PX::MeshCache cache;
+		std::cout << (cache.WritePack() ? "Wrote the mesh pack to " : "Error: nothing to pack in ") << cache.GetDirectory() << '\n';
+	}
+
+	if (!csv_path.empty() && !Benchmark::WriteCsv(csv_path, results))
+	{
+		return 1;
+	}
+
+	return 0;
+}
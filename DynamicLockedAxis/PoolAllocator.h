@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	// Memory numbers for one allocation category (PhysX type name and source file)
+	struct AllocationStats
+	{
+		std::string name;
+		std::int64_t liveBytes = 0;
+		std::int64_t peakBytes = 0;
+		std::uint64_t totalAllocations = 0;
+		std::uint64_t frameAllocations = 0;
+		std::uint64_t frameBytes = 0;
+		double allocationsPerSecond = 0.0;
+	};
+
+	// Size-class pooled allocator with thread-local caches that accounts every allocation to the category PhysX passes in
+	class PoolAllocator : public physx::PxAllocatorCallback
+	{
+	public:
+		PoolAllocator();
+		virtual ~PoolAllocator();
+
+		// Called by PhysX
+		virtual void* allocate(size_t size, const char* typeName, const char* filename, int line) override;
+		virtual void deallocate(void* ptr) override;
+
+		// Close the current frame, the frame counters and allocation rate cover the frame just finished
+		void NextFrame(double delta_time);
+
+		// Per category numbers, sorted by live bytes
+		std::vector<AllocationStats> GetStats() const;
+		std::int64_t GetLiveBytes() const { return m_LiveBytes.load(std::memory_order_relaxed); }
+		std::int64_t GetPeakBytes() const { return m_PeakBytes.load(std::memory_order_relaxed); }
+		std::uint64_t GetFrameAllocations() const { return m_LastFrameAllocations; }
+
+		// Running totals since creation, diff two reads to count the allocations made in between
+		std::uint64_t GetTotalAllocations() const { return m_TotalAllocations.load(std::memory_order_relaxed); }
+		std::uint64_t GetTotalAllocatedBytes() const { return m_TotalBytes.load(std::memory_order_relaxed); }
+
+		// Mark the calling thread as running the frame, its allocations stay out of the step totals until it's unmarked.
+		// Physics marks the main thread while a pipelined step runs alongside the frame
+		void SetFrameThread(bool frame);
+
+		// Running totals like the ones above without the frame thread's allocations
+		std::uint64_t GetStepAllocations() const { return m_StepAllocations.load(std::memory_order_relaxed); }
+		std::uint64_t GetStepAllocatedBytes() const { return m_StepBytes.load(std::memory_order_relaxed); }
+
+		// Print the top categories by live bytes
+		void PrintStats(std::ostream& stream, size_t max_categories = 20) const;
+
+	private:
+		static constexpr size_t SizeClassCount = 14;
+		static constexpr size_t MaxCategories = 1024;
+		static constexpr std::uint32_t LargeBlock = 0xffffffff;
+
+		// Sits in front of every block so deallocate knows where it came from
+		struct alignas(16) BlockHeader
+		{
+			std::uint32_t sizeClass;
+			std::uint32_t category;
+			std::uint64_t size;
+		};
+
+		struct alignas(64) Category
+		{
+			std::string name;
+			std::atomic<std::int64_t> liveBytes { 0 };
+			std::atomic<std::int64_t> peakBytes { 0 };
+			std::atomic<std::uint64_t> totalAllocations { 0 };
+			std::atomic<std::uint64_t> frameAllocations { 0 };
+			std::atomic<std::uint64_t> frameBytes { 0 };
+
+			// Written by NextFrame
+			std::uint64_t lastFrameAllocations = 0;
+			std::uint64_t lastFrameBytes = 0;
+			double allocationsPerSecond = 0.0;
+		};
+
+		struct SizeClassPool
+		{
+			std::mutex mutex;
+			std::vector<void*> freeBlocks;
+		};
+
+		struct CategoryKey
+		{
+			const char* typeName;
+			const char* filename;
+			bool operator==(const CategoryKey& other) const { return typeName == other.typeName && filename == other.filename; }
+		};
+
+		struct CategoryKeyHash
+		{
+			size_t operator()(const CategoryKey& key) const { return std::hash<const void*>()(key.typeName) ^ (std::hash<const void*>()(key.filename) << 1); }
+		};
+
+		// Per thread free lists and category lookups, owned by the allocator so threads can exit at any time
+		struct ThreadCache
+		{
+			std::array<std::vector<void*>, SizeClassCount> freeBlocks;
+			std::unordered_map<CategoryKey, std::uint32_t, CategoryKeyHash> categories;
+		};
+
+		const std::uint64_t m_Id;
+
+		// Pools
+		std::array<SizeClassPool, SizeClassCount> m_Pools;
+		std::mutex m_SlabMutex;
+		std::vector<void*> m_Slabs;
+		void* AllocateBlock(std::uint32_t size_class, ThreadCache* cache);
+		void FreeBlock(std::uint32_t size_class, void* block, ThreadCache* cache);
+		void RefillPool(std::uint32_t size_class);
+
+		// Thread caches
+		std::mutex m_CacheMutex;
+		std::vector<std::unique_ptr<ThreadCache>> m_ThreadCaches;
+		ThreadCache* GetThreadCache();
+
+		// Categories
+		mutable std::mutex m_CategoryMutex;
+		std::unordered_map<std::string, std::uint32_t> m_CategoryLookup;
+		std::array<std::unique_ptr<Category>, MaxCategories> m_Categories;
+		std::atomic<std::uint32_t> m_CategoryCount { 0 };
+		std::uint32_t FindCategory(const char* type_name, const char* filename, ThreadCache* cache);
+
+		// Totals
+		std::atomic<std::int64_t> m_LiveBytes { 0 };
+		std::atomic<std::int64_t> m_PeakBytes { 0 };
+		std::atomic<std::uint64_t> m_FrameAllocations { 0 };
+		std::atomic<std::uint64_t> m_TotalAllocations { 0 };
+		std::atomic<std::uint64_t> m_TotalBytes { 0 };
+		std::atomic<std::uint64_t> m_StepAllocations { 0 };
+		std::atomic<std::uint64_t> m_StepBytes { 0 };
+		std::uint64_t m_LastFrameAllocations = 0;
+	};
+}
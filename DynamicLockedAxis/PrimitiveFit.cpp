@@ -0,0 +1,488 @@
+#include "PrimitiveFit.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define FIT_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// PhysX won't take a zero sized box, a flat mesh gets a thin one
+	constexpr physx::PxReal MIN_HALF_EXTENT = 0.001f;
+
+#ifdef FIT_USE_SSE
+	// Four vertices from first split into x, y and z lanes. Vertex is six floats, so loading four floats from x reads
+	// the normal's x into the fourth lane, which the transpose moves into w and drops
+	void LoadLanes(const std::vector<DX::Vertex>& vertices, size_t first, __m128& x, __m128& y, __m128& z)
+	{
+		x = _mm_loadu_ps(&vertices[first].x);
+		y = _mm_loadu_ps(&vertices[first + 1].x);
+		z = _mm_loadu_ps(&vertices[first + 2].x);
+		__m128 w = _mm_loadu_ps(&vertices[first + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+	}
+
+	float HorizontalMin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	float HorizontalMax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	float HorizontalSum(__m128 v)
+	{
+		v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(v);
+	}
+
+	// Offset of each lane along axis
+	__m128 Dot(__m128 x, __m128 y, __m128 z, const physx::PxVec3& axis)
+	{
+		__m128 result = _mm_mul_ps(x, _mm_set1_ps(axis.x));
+		result = _mm_add_ps(result, _mm_mul_ps(y, _mm_set1_ps(axis.y)));
+		return _mm_add_ps(result, _mm_mul_ps(z, _mm_set1_ps(axis.z)));
+	}
+
+	__m128 LengthSquared(__m128 x, __m128 y, __m128 z)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	}
+#endif
+
+	physx::PxVec3 Position(const DX::Vertex& vertex)
+	{
+		return physx::PxVec3(vertex.x, vertex.y, vertex.z);
+	}
+
+	// Smallest and largest offset of the vertices along each of three axes
+	void Project(const DX::MeshData& mesh, const physx::PxVec3 axes[3], physx::PxVec3& min, physx::PxVec3& max)
+	{
+		const std::vector<DX::Vertex>& vertices = mesh.vertices;
+		min = physx::PxVec3(std::numeric_limits<physx::PxReal>::max());
+		max = physx::PxVec3(-std::numeric_limits<physx::PxReal>::max());
+		size_t i = 0;
+
+#ifdef FIT_USE_SSE
+		__m128 lane_min[3];
+		__m128 lane_max[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			lane_min[k] = _mm_set1_ps(min[k]);
+			lane_max[k] = _mm_set1_ps(max[k]);
+		}
+
+		for (; i + 4 <= vertices.size(); i += 4)
+		{
+			__m128 x, y, z;
+			LoadLanes(vertices, i, x, y, z);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				__m128 offset = Dot(x, y, z, axes[k]);
+				lane_min[k] = _mm_min_ps(lane_min[k], offset);
+				lane_max[k] = _mm_max_ps(lane_max[k], offset);
+			}
+		}
+
+		for (int k = 0; k < 3; ++k)
+		{
+			min[k] = HorizontalMin(lane_min[k]);
+			max[k] = HorizontalMax(lane_max[k]);
+		}
+#endif
+
+		for (; i < vertices.size(); ++i)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				physx::PxReal offset = Position(vertices[i]).dot(axes[k]);
+				min[k] = std::min(min[k], offset);
+				max[k] = std::max(max[k], offset);
+			}
+		}
+	}
+
+	physx::PxReal MaxDistanceSquared(const DX::MeshData& mesh, const physx::PxVec3& center)
+	{
+		const std::vector<DX::Vertex>& vertices = mesh.vertices;
+		physx::PxReal result = 0.0f;
+		size_t i = 0;
+
+#ifdef FIT_USE_SSE
+		__m128 lane_max = _mm_setzero_ps();
+		__m128 cx = _mm_set1_ps(center.x);
+		__m128 cy = _mm_set1_ps(center.y);
+		__m128 cz = _mm_set1_ps(center.z);
+
+		for (; i + 4 <= vertices.size(); i += 4)
+		{
+			__m128 x, y, z;
+			LoadLanes(vertices, i, x, y, z);
+			lane_max = _mm_max_ps(lane_max, LengthSquared(_mm_sub_ps(x, cx), _mm_sub_ps(y, cy), _mm_sub_ps(z, cz)));
+		}
+
+		result = HorizontalMax(lane_max);
+#endif
+
+		for (; i < vertices.size(); ++i)
+		{
+			result = std::max(result, (Position(vertices[i]) - center).magnitudeSquared());
+		}
+
+		return result;
+	}
+
+	// Covariance of the vertex positions, its eigenvectors are the OBB's axes
+	physx::PxMat33 Covariance(const DX::MeshData& mesh)
+	{
+		const std::vector<DX::Vertex>& vertices = mesh.vertices;
+		size_t i = 0;
+
+		// x, y, z, xx, yy, zz, xy, yz, zx
+		physx::PxReal sums[9] = {};
+
+#ifdef FIT_USE_SSE
+		__m128 lane_sums[9];
+		for (__m128& lane : lane_sums)
+		{
+			lane = _mm_setzero_ps();
+		}
+
+		for (; i + 4 <= vertices.size(); i += 4)
+		{
+			__m128 x, y, z;
+			LoadLanes(vertices, i, x, y, z);
+
+			lane_sums[0] = _mm_add_ps(lane_sums[0], x);
+			lane_sums[1] = _mm_add_ps(lane_sums[1], y);
+			lane_sums[2] = _mm_add_ps(lane_sums[2], z);
+			lane_sums[3] = _mm_add_ps(lane_sums[3], _mm_mul_ps(x, x));
+			lane_sums[4] = _mm_add_ps(lane_sums[4], _mm_mul_ps(y, y));
+			lane_sums[5] = _mm_add_ps(lane_sums[5], _mm_mul_ps(z, z));
+			lane_sums[6] = _mm_add_ps(lane_sums[6], _mm_mul_ps(x, y));
+			lane_sums[7] = _mm_add_ps(lane_sums[7], _mm_mul_ps(y, z));
+			lane_sums[8] = _mm_add_ps(lane_sums[8], _mm_mul_ps(z, x));
+		}
+
+		for (int k = 0; k < 9; ++k)
+		{
+			sums[k] = HorizontalSum(lane_sums[k]);
+		}
+#endif
+
+		for (; i < vertices.size(); ++i)
+		{
+			physx::PxVec3 p = Position(vertices[i]);
+			sums[0] += p.x;
+			sums[1] += p.y;
+			sums[2] += p.z;
+			sums[3] += p.x * p.x;
+			sums[4] += p.y * p.y;
+			sums[5] += p.z * p.z;
+			sums[6] += p.x * p.y;
+			sums[7] += p.y * p.z;
+			sums[8] += p.z * p.x;
+		}
+
+		physx::PxReal n = static_cast<physx::PxReal>(std::max<size_t>(1, vertices.size()));
+		physx::PxVec3 mean(sums[0] / n, sums[1] / n, sums[2] / n);
+
+		physx::PxReal xx = sums[3] / n - mean.x * mean.x;
+		physx::PxReal yy = sums[4] / n - mean.y * mean.y;
+		physx::PxReal zz = sums[5] / n - mean.z * mean.z;
+		physx::PxReal xy = sums[6] / n - mean.x * mean.y;
+		physx::PxReal yz = sums[7] / n - mean.y * mean.z;
+		physx::PxReal zx = sums[8] / n - mean.z * mean.x;
+
+		return physx::PxMat33(physx::PxVec3(xx, xy, zx), physx::PxVec3(xy, yy, yz), physx::PxVec3(zx, yz, zz));
+	}
+
+	// Thinnest capsule around center along axis, returns the half height
+	physx::PxReal FitCapsule(const DX::MeshData& mesh, const physx::PxVec3& center, const physx::PxVec3& axis, physx::PxReal& radius)
+	{
+		const std::vector<DX::Vertex>& vertices = mesh.vertices;
+
+		// Squared distance from the axis, along is the offset along it
+		auto distance_squared = [&](const DX::Vertex& vertex, physx::PxReal& along)
+		{
+			physx::PxVec3 offset = Position(vertex) - center;
+			along = offset.dot(axis);
+			return offset.magnitudeSquared() - along * along;
+		};
+
+#ifdef FIT_USE_SSE
+		__m128 cx = _mm_set1_ps(center.x);
+		__m128 cy = _mm_set1_ps(center.y);
+		__m128 cz = _mm_set1_ps(center.z);
+
+		auto lane_distance_squared = [&](size_t first, __m128& along)
+		{
+			__m128 x, y, z;
+			LoadLanes(vertices, first, x, y, z);
+			x = _mm_sub_ps(x, cx);
+			y = _mm_sub_ps(y, cy);
+			z = _mm_sub_ps(z, cz);
+			along = Dot(x, y, z, axis);
+			return _mm_sub_ps(LengthSquared(x, y, z), _mm_mul_ps(along, along));
+		};
+#endif
+
+		// Radius is the farthest any vertex sits from the axis
+		physx::PxReal radius_squared = 0.0f;
+		size_t i = 0;
+
+#ifdef FIT_USE_SSE
+		__m128 lane_radius = _mm_setzero_ps();
+		for (; i + 4 <= vertices.size(); i += 4)
+		{
+			__m128 along;
+			lane_radius = _mm_max_ps(lane_radius, lane_distance_squared(i, along));
+		}
+
+		radius_squared = HorizontalMax(lane_radius);
+#endif
+
+		for (; i < vertices.size(); ++i)
+		{
+			physx::PxReal along;
+			radius_squared = std::max(radius_squared, distance_squared(vertices[i], along));
+		}
+
+		// A cap reaches sqrt(r^2 - d^2) past the end of the segment for a vertex d from the axis
+		physx::PxReal half_height = 0.0f;
+		i = 0;
+
+#ifdef FIT_USE_SSE
+		__m128 lane_radius_squared = _mm_set1_ps(radius_squared);
+		__m128 sign = _mm_set1_ps(-0.0f);
+		__m128 lane_height = _mm_setzero_ps();
+
+		for (; i + 4 <= vertices.size(); i += 4)
+		{
+			__m128 along;
+			__m128 distance = lane_distance_squared(i, along);
+			__m128 cap = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lane_radius_squared, distance), _mm_setzero_ps()));
+			lane_height = _mm_max_ps(lane_height, _mm_sub_ps(_mm_andnot_ps(sign, along), cap));
+		}
+
+		half_height = HorizontalMax(lane_height);
+#endif
+
+		for (; i < vertices.size(); ++i)
+		{
+			physx::PxReal along;
+			physx::PxReal distance = distance_squared(vertices[i], along);
+			half_height = std::max(half_height, std::fabs(along) - std::sqrt(std::max(radius_squared - distance, 0.0f)));
+		}
+
+		radius = std::sqrt(radius_squared);
+		return half_height;
+	}
+
+	// Divergence theorem over the triangles, only meaningful for a closed mesh
+	physx::PxReal MeshVolume(const DX::MeshData& mesh)
+	{
+		physx::PxReal volume = 0.0f;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const DX::Vertex& a = mesh.vertices[mesh.indices[i]];
+			const DX::Vertex& b = mesh.vertices[mesh.indices[i + 1]];
+			const DX::Vertex& c = mesh.vertices[mesh.indices[i + 2]];
+
+			physx::PxVec3 pa(a.x, a.y, a.z);
+			physx::PxVec3 pb(b.x, b.y, b.z);
+			physx::PxVec3 pc(c.x, c.y, c.z);
+			volume += pa.dot(pb.cross(pc));
+		}
+
+		return std::fabs(volume) / 6.0f;
+	}
+
+	physx::PxVec3 HalfExtents(const physx::PxVec3& min, const physx::PxVec3& max)
+	{
+		physx::PxVec3 half = (max - min) * 0.5f;
+		return physx::PxVec3(std::max(half.x, MIN_HALF_EXTENT), std::max(half.y, MIN_HALF_EXTENT), std::max(half.z, MIN_HALF_EXTENT));
+	}
+
+	int Cost(PX::PrimitiveType type)
+	{
+		return type == PX::PrimitiveType::OrientedBox ? static_cast<int>(PX::PrimitiveType::Box) : static_cast<int>(type);
+	}
+}
+
+const char* PX::GetPrimitiveTypeName(PrimitiveType type)
+{
+	switch (type)
+	{
+	case PrimitiveType::Sphere: return "sphere";
+	case PrimitiveType::Capsule: return "capsule";
+	case PrimitiveType::Box: return "box";
+	case PrimitiveType::OrientedBox: return "obb";
+	}
+
+	return "unknown";
+}
+
+const PX::PrimitiveFit& PX::PrimitiveFitResult::GetPrimitive() const
+{
+	if (picked >= 0)
+	{
+		return candidates[picked];
+	}
+
+	const PrimitiveFit& box = candidates[static_cast<int>(PrimitiveType::Box)];
+	const PrimitiveFit& oriented = candidates[static_cast<int>(PrimitiveType::OrientedBox)];
+	return oriented.volume < box.volume ? oriented : box;
+}
+
+PX::MeshBounds PX::ComputeMeshBounds(const DX::MeshData& mesh)
+{
+	MeshBounds bounds;
+	if (mesh.vertices.empty())
+	{
+		return bounds;
+	}
+
+	const physx::PxVec3 axes[3] = { physx::PxVec3(1.0f, 0.0f, 0.0f), physx::PxVec3(0.0f, 1.0f, 0.0f), physx::PxVec3(0.0f, 0.0f, 1.0f) };
+	Project(mesh, axes, bounds.aabb.minimum, bounds.aabb.maximum);
+
+	bounds.sphereCenter = bounds.aabb.getCenter();
+	bounds.sphereRadius = std::sqrt(MaxDistanceSquared(mesh, bounds.sphereCenter));
+	return bounds;
+}
+
+PX::PrimitiveFitResult PX::FitPrimitives(const DX::MeshData& mesh, const PrimitiveFitDesc& desc)
+{
+	PrimitiveFitResult result;
+	result.bounds = ComputeMeshBounds(mesh);
+	result.meshVolume = MeshVolume(mesh);
+	result.candidates.resize(4);
+
+	if (mesh.vertices.empty())
+	{
+		return result;
+	}
+
+	// OBB axes from the principal directions of the vertices, world axes when they're degenerate
+	physx::PxQuat rotation;
+	physx::PxDiagonalize(Covariance(mesh), rotation);
+	if (!rotation.isFinite() || !rotation.isSane())
+	{
+		rotation = physx::PxQuat(physx::PxIdentity);
+	}
+
+	physx::PxMat33 basis(rotation);
+	const physx::PxVec3 axes[3] = { basis.column0, basis.column1, basis.column2 };
+
+	physx::PxVec3 obb_min;
+	physx::PxVec3 obb_max;
+	Project(mesh, axes, obb_min, obb_max);
+	physx::PxVec3 obb_center = basis.transform((obb_min + obb_max) * 0.5f);
+	physx::PxVec3 obb_half = HalfExtents(obb_min, obb_max);
+
+	// Box
+	{
+		PrimitiveFit& fit = result.candidates[static_cast<int>(PrimitiveType::Box)];
+		physx::PxVec3 half = HalfExtents(result.bounds.aabb.minimum, result.bounds.aabb.maximum);
+		fit.type = PrimitiveType::Box;
+		fit.geometry.storeAny(physx::PxBoxGeometry(half));
+		fit.localPose = physx::PxTransform(result.bounds.aabb.getCenter());
+		fit.volume = 8.0f * half.x * half.y * half.z;
+	}
+
+	// Oriented box
+	{
+		PrimitiveFit& fit = result.candidates[static_cast<int>(PrimitiveType::OrientedBox)];
+		fit.type = PrimitiveType::OrientedBox;
+		fit.geometry.storeAny(physx::PxBoxGeometry(obb_half));
+		fit.localPose = physx::PxTransform(obb_center, rotation);
+		fit.volume = 8.0f * obb_half.x * obb_half.y * obb_half.z;
+	}
+
+	// Sphere, around whichever of the two box centres gives the smaller one
+	{
+		PrimitiveFit& fit = result.candidates[static_cast<int>(PrimitiveType::Sphere)];
+		physx::PxVec3 center = result.bounds.sphereCenter;
+		physx::PxReal radius = result.bounds.sphereRadius;
+
+		physx::PxReal obb_radius = std::sqrt(MaxDistanceSquared(mesh, obb_center));
+		if (obb_radius < radius)
+		{
+			center = obb_center;
+			radius = obb_radius;
+		}
+
+		radius = std::max(radius, MIN_HALF_EXTENT);
+		fit.type = PrimitiveType::Sphere;
+		fit.geometry.storeAny(physx::PxSphereGeometry(radius));
+		fit.localPose = physx::PxTransform(center);
+		fit.volume = 4.0f / 3.0f * physx::PxPi * radius * radius * radius;
+	}
+
+	// Capsule along the OBB's longest side, PhysX capsules run along x so the pose turns x onto that side
+	{
+		PrimitiveFit& fit = result.candidates[static_cast<int>(PrimitiveType::Capsule)];
+		int longest = obb_half.x >= obb_half.y && obb_half.x >= obb_half.z ? 0 : (obb_half.y >= obb_half.z ? 1 : 2);
+
+		physx::PxReal radius = 0.0f;
+		physx::PxReal half_height = FitCapsule(mesh, obb_center, axes[longest], radius);
+		radius = std::max(radius, MIN_HALF_EXTENT);
+
+		fit.type = PrimitiveType::Capsule;
+		fit.geometry.storeAny(physx::PxCapsuleGeometry(radius, half_height));
+		fit.localPose = physx::PxTransform(obb_center, physx::PxShortestRotation(physx::PxVec3(1.0f, 0.0f, 0.0f), axes[longest]));
+		fit.volume = physx::PxPi * radius * radius * (2.0f * half_height + 4.0f / 3.0f * radius);
+	}
+
+	// An open or flat mesh has no volume of its own, the tightest primitive stands in for it
+	physx::PxReal reference = result.meshVolume;
+	if (reference <= std::numeric_limits<physx::PxReal>::epsilon())
+	{
+		reference = std::numeric_limits<physx::PxReal>::max();
+		for (const PrimitiveFit& fit : result.candidates)
+		{
+			reference = std::min(reference, fit.volume);
+		}
+	}
+
+	for (int i = 0; i < static_cast<int>(result.candidates.size()); ++i)
+	{
+		PrimitiveFit& fit = result.candidates[i];
+		fit.error = (fit.volume - reference) / reference;
+		if (fit.error > desc.maxVolumeError)
+		{
+			continue;
+		}
+
+		// Cheapest type wins, the two boxes cost the same so the tighter one does
+		const PrimitiveFit* current = result.picked >= 0 ? &result.candidates[result.picked] : nullptr;
+		if (current == nullptr || Cost(fit.type) < Cost(current->type) || (Cost(fit.type) == Cost(current->type) && fit.volume < current->volume))
+		{
+			result.picked = i;
+		}
+	}
+
+	return result;
+}
+
+physx::PxShape* PX::CreatePrimitiveShape(physx::PxPhysics& physics, const PrimitiveFit& fit, const physx::PxMaterial& material, bool exclusive)
+{
+	physx::PxShape* shape = physics.createShape(fit.geometry.any(), material, exclusive);
+	if (shape != nullptr)
+	{
+		shape->setLocalPose(fit.localPose);
+	}
+
+	return shape;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace PX
+{
+	// Bounded ring for exactly one producer thread and one consumer thread, neither side ever takes a lock.
+	// Head and tail sit on their own cache lines so the two threads don't fight over one
+	template <typename T>
+	class SpscQueue
+	{
+	public:
+		explicit SpscQueue(size_t capacity) : m_Slots(capacity + 1)
+		{
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		// Producer only, false when the queue is full
+		bool Push(const T& value)
+		{
+			size_t tail = m_Tail.load(std::memory_order_relaxed);
+			size_t next = tail + 1 == m_Slots.size() ? 0 : tail + 1;
+			if (next == m_Head.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			m_Slots[tail] = value;
+			m_Tail.store(next, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, false when the queue is empty
+		bool Pop(T& value)
+		{
+			size_t head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_Tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			value = m_Slots[head];
+			m_Head.store(head + 1 == m_Slots.size() ? 0 : head + 1, std::memory_order_release);
+			return true;
+		}
+
+		inline size_t GetCapacity() const { return m_Slots.size() - 1; }
+
+	private:
+		std::vector<T> m_Slots;
+		alignas(64) std::atomic<size_t> m_Head { 0 };
+		alignas(64) std::atomic<size_t> m_Tail { 0 };
+	};
+}
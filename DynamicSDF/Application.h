@@ -22,6 +22,18 @@ public:
 
 	int Execute();
 
+	// PVD connection for the physics, must be set before Execute
+	inline void SetPvdDesc(const PX::PvdDesc& desc) { m_PvdDesc = desc; }
+
+	// Leave CUDA out even when a context would be valid
+	inline void SetUseGpu(bool use_gpu) { m_UseGpu = use_gpu; }
+
+	// Run the SDF tuner before the models are created and cook them at the setting it picks
+	inline void SetTuneSdf(bool tune_sdf) { m_TuneSdf = tune_sdf; }
+
+	// Build the pyramids as convex compounds instead of SDF triangle meshes
+	inline void SetConvexHulls(const PX::ConvexDecompositionDesc& desc) { m_HullDesc = desc; m_UseConvexHulls = true; }
+
 private:
 	void DirectXSetup();
 
@@ -57,4 +69,10 @@ private:
 	void SetupDirectionalLight();
 
 	std::unique_ptr<PX::Physics> m_Physics = nullptr;
+	PX::PvdDesc m_PvdDesc;
+	bool m_UseGpu = true;
+	bool m_TuneSdf = false;
+	PX::ConvexDecompositionDesc m_HullDesc;
+	bool m_UseConvexHulls = false;
+	PX::SdfSetting TuneSdf();
 };
\ No newline at end of file
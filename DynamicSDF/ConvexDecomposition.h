@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Physics.h"
+#include "Vertex.h"
+
+namespace PX
+{
+	struct ConvexDecompositionDesc
+	{
+		// Pieces to cut the mesh into, one keeps the whole mesh as a single hull
+		physx::PxU32 maxHulls = 8;
+
+		// PhysX simplifies each hull down to this many vertices
+		physx::PxU16 vertexLimit = 32;
+
+		// Pieces thinner than this along every axis aren't cut any further
+		physx::PxReal minExtent = 0.05f;
+	};
+
+	// Hulls for one mesh, in the mesh's own space so every hull shares the body's frame
+	struct ConvexCompound
+	{
+		std::vector<physx::PxConvexMesh*> hulls;
+		double decomposeMs = 0.0;
+		double cookMs = 0.0;
+
+		// Shapes made from the hulls hold their own references
+		void Release();
+	};
+
+	// Cuts a triangle mesh into convex pieces with axis aligned planes and cooks a hull for each piece on the job system.
+	// There's no concavity search, the biggest piece is always the next one cut, which suits the rough shapes in these samples
+	class ConvexDecomposer
+	{
+	public:
+		explicit ConvexDecomposer(Physics& physics);
+
+		ConvexCompound Decompose(const DX::MeshData& mesh, const ConvexDecompositionDesc& desc = ConvexDecompositionDesc());
+
+		// One exclusive shape per hull
+		static void AttachCompound(physx::PxRigidActor& actor, const ConvexCompound& compound, const physx::PxMaterial& material);
+
+	private:
+		Physics& m_Physics;
+	};
+}
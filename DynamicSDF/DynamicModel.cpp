@@ -64,6 +64,15 @@ void DX::DynamicModel::CreateIndexBuffer()
 
 void DX::DynamicModel::CreatePhysicsActor()
 {
+	// The cooked mesh is the collision here, the fit only supplies the bounds
+	m_Bounds = PX::ComputeMeshBounds(m_MeshData);
+
+	if (m_UseConvexHulls)
+	{
+		CreateConvexActor();
+		return;
+	}
+
 	std::vector<physx::PxVec3> vecs;
 	for (auto& v : m_MeshData.vertices)
 	{
@@ -76,15 +85,11 @@ void DX::DynamicModel::CreatePhysicsActor()
 	meshDesc.points.stride = sizeof(physx::PxVec3);
 	meshDesc.points.data = vecs.data();
 
-	meshDesc.triangles.count = m_MeshData.indices.size();;
+	meshDesc.triangles.count = static_cast<physx::PxU32>(m_MeshData.indices.size() / 3);
 	meshDesc.triangles.stride = 3 * sizeof(UINT);
 	meshDesc.triangles.data = m_MeshData.indices.data();
 
-	physx::PxSDFDesc sdfDesc;
-	sdfDesc.spacing = 0.5f;
-	sdfDesc.subgridSize = 6;
-	sdfDesc.bitsPerSubgridPixel = physx::PxSdfBitsPerSubgridPixel::e16_BIT_PER_PIXEL;
-	sdfDesc.numThreadsForSdfConstruction = 16;
+	physx::PxSDFDesc sdfDesc = PX::MakeSdfDesc(m_SdfSetting);
 
 	meshDesc.sdfDesc = &sdfDesc;
 
@@ -93,24 +98,20 @@ void DX::DynamicModel::CreatePhysicsActor()
 	params.meshWeldTolerance = 0.001f;
 	params.meshPreprocessParams = physx::PxMeshPreprocessingFlags(physx::PxMeshPreprocessingFlag::eWELD_VERTICES);
 	params.buildTriangleAdjacencies = false;
-	params.buildGPUData = true;
-
-	physx::PxDefaultMemoryOutputStream writeBuffer;
-	physx::PxTriangleMeshCookingResult::Enum result;
+	params.buildGPUData = m_Physics->IsGpuEnabled();
 
-	bool status = PxCookTriangleMesh(params, meshDesc, writeBuffer, &result);
-	if (!status)
+	// Read back from the mesh cache when this mesh was cooked with the same settings before
+	auto mesh = m_Physics->GetMeshCache().CreateTriangleMesh(*m_Physics->GetPhysics(), params, meshDesc);
+	if (mesh == nullptr)
 	{
 		return;
 	}
 
-	physx::PxDefaultMemoryInputData readBuffer(writeBuffer.getData(), writeBuffer.getSize());
-	auto mesh = m_Physics->GetPhysics()->createTriangleMesh(readBuffer);
-
 
 	// Create actor
 	// physx::PxRigidDynamic* m_Body = m_Physics->GetPhysics()->createRigidDynamic(physx::PxTransform(physx::PxVec3(0, 0, 0)));
 	m_Body = m_Physics->GetPhysics()->createRigidDynamic(physx::PxTransform(physx::PxVec3(m_Position.x, m_Position.y, m_Position.z)));
+	m_Body->userData = static_cast<PX::ActorOwner*>(this);
 
 	m_Body->setLinearDamping(0.2f);
 	m_Body->setAngularDamping(0.1f);
@@ -122,7 +123,7 @@ void DX::DynamicModel::CreatePhysicsActor()
 	/*m_Body->setRigidBodyFlag(physx::PxRigidBodyFlag::eENABLE_GYROSCOPIC_FORCES, true);
 	m_Body->setRigidBodyFlag(physx::PxRigidBodyFlag::eENABLE_SPECULATIVE_CCD, true);*/
 
-	physx::PxMaterial* material = m_Physics->GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+	physx::PxMaterial* material = m_Physics->GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
 	physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*m_Body, geom, *material);
 	shape->setContactOffset(0.1f);
 	shape->setRestOffset(0.02f);
@@ -136,6 +137,35 @@ void DX::DynamicModel::CreatePhysicsActor()
 	m_Body->setMaxDepenetrationVelocity(5.f);
 }
 
+void DX::DynamicModel::CreateConvexActor()
+{
+	// Hulls are cut from the same mesh the SDF path cooks, the shapes keep them alive
+	PX::ConvexDecomposer decomposer(*m_Physics);
+	PX::ConvexCompound compound = decomposer.Decompose(m_MeshData, m_HullDesc);
+	if (compound.hulls.empty())
+	{
+		return;
+	}
+
+	m_Body = m_Physics->GetPhysics()->createRigidDynamic(physx::PxTransform(physx::PxVec3(m_Position.x, m_Position.y, m_Position.z)));
+	m_Body->userData = static_cast<PX::ActorOwner*>(this);
+
+	m_Body->setLinearDamping(0.2f);
+	m_Body->setAngularDamping(0.1f);
+
+	physx::PxMaterial* material = m_Physics->GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
+	PX::ConvexDecomposer::AttachCompound(*m_Body, compound, *material);
+	compound.Release();
+
+	physx::PxReal density = 100.f;
+	physx::PxRigidBodyExt::updateMassAndInertia(*m_Body, density);
+
+	m_Physics->GetScene()->addActor(*m_Body);
+
+	m_Body->setSolverIterationCounts(50, 1);
+	m_Body->setMaxDepenetrationVelocity(5.f);
+}
+
 void DX::DynamicModel::Render()
 {
 	auto d3dDeviceContext = m_DxRenderer->GetDeviceContext();
@@ -159,7 +189,11 @@ void DX::DynamicModel::Render()
 
 void DX::DynamicModel::Update()
 {
-	physx::PxTransform global_pose = m_Body->getGlobalPose();
+	SyncTransform(m_Physics->GetInterpolatedPose(m_Body));
+}
+
+void DX::DynamicModel::SyncTransform(const physx::PxTransform& global_pose)
+{
 	m_Position.x = global_pose.p.x;
 	m_Position.y = global_pose.p.y;
 	m_Position.z = global_pose.p.z;
@@ -4,15 +4,24 @@
 #include <DirectXMath.h>
 #include "Vertex.h"
 #include "Physics.h"
+#include "PrimitiveFit.h"
+#include "SdfTuner.h"
+#include "ConvexDecomposition.h"
 
 namespace DX
 {
-	class DynamicModel
+	class DynamicModel : public PX::ActorOwner
 	{
 	public:
 		DynamicModel(DX::Renderer* renderer, PX::Physics* physics);
 		virtual ~DynamicModel() = default;
 
+		// SDF resolution for the cooked mesh, must be set before Create
+		inline void SetSdfSetting(const PX::SdfSetting& setting) { m_SdfSetting = setting; }
+
+		// Collide as a compound of convex hulls instead of an SDF triangle mesh, must be set before Create
+		inline void SetConvexHulls(const PX::ConvexDecompositionDesc& desc) { m_HullDesc = desc; m_UseConvexHulls = true; }
+
 		// Create device
 		void Create(float x, float y, float z);
 		void Create(float x, float y, float z, float width, float height, float depth);
@@ -20,9 +29,12 @@ namespace DX
 		// Render the model
 		void Render();
 
-		// Update model
+		// Update model from the body whether it moved or not
 		void Update();
 
+		// Rebuild World from the body's pose, the active actor sync calls it for bodies that moved
+		void SyncTransform(const physx::PxTransform& pose) override;
+
 		// World 
 		DirectX::XMMATRIX World = DirectX::XMMatrixIdentity();
 
@@ -32,6 +44,9 @@ namespace DX
 		// Get actor
 		inline physx::PxRigidBody* GetBody() { return m_Body; }
 
+		// Local bounds of the render mesh, move them by the body's pose to cull
+		inline const PX::MeshBounds& GetBounds() const { return m_Bounds; }
+
 	private:
 		DX::Renderer* m_DxRenderer = nullptr;
 
@@ -48,10 +63,15 @@ namespace DX
 
 		// Mesh data
 		MeshData m_MeshData;
+		PX::MeshBounds m_Bounds;
 
 		// Physics
 		PX::Physics* m_Physics = nullptr;
 		physx::PxRigidDynamic* m_Body = nullptr;
+		PX::SdfSetting m_SdfSetting;
+		PX::ConvexDecompositionDesc m_HullDesc;
+		bool m_UseConvexHulls = false;
 		void CreatePhysicsActor();
+		void CreateConvexActor();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace
+{
+	// Which pool and worker the current thread belongs to, -1 for threads outside the pool
+	thread_local PX::JobSystem* t_JobSystem = nullptr;
+	thread_local int t_WorkerIndex = -1;
+}
+
+PX::JobSystem::JobSystem(const JobSystemDesc& desc)
+{
+	unsigned int hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	// Leave a core for the main thread, it also runs jobs while it waits in ParallelFor
+	unsigned int worker_count = desc.workerCount;
+	if (worker_count == 0)
+	{
+		worker_count = std::max(1u, hardware_threads - 1);
+	}
+
+	m_Workers.reserve(worker_count);
+	for (unsigned int i = 0; i < worker_count; ++i)
+	{
+		m_Workers.push_back(std::make_unique<Worker>());
+	}
+
+	// Start threads once every deque exists so early steals don't race the vector
+	for (unsigned int i = 0; i < worker_count; ++i)
+	{
+		m_Workers[i]->thread = std::thread(&JobSystem::WorkerMain, this, i);
+
+		if (desc.pinThreads)
+		{
+			PinThread(m_Workers[i]->thread, (i + 1) % hardware_threads);
+		}
+	}
+}
+
+PX::JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running = false;
+	}
+
+	m_SleepCondition.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		worker->thread.join();
+	}
+
+	// Workers only stop once their deques look empty, whatever a last job submitted runs here rather than being dropped
+	while (TryRunJob(-1))
+	{
+	}
+}
+
+void PX::JobSystem::submitTask(physx::PxBaseTask& task)
+{
+	Job job;
+	job.task = &task;
+	Push(std::move(job));
+}
+
+uint32_t PX::JobSystem::getWorkerCount() const
+{
+	return static_cast<uint32_t>(m_Workers.size());
+}
+
+void PX::JobSystem::Submit(std::function<void()> function)
+{
+	Job job;
+	job.function = std::move(function);
+	Push(std::move(job));
+}
+
+void PX::JobSystem::ParallelFor(size_t count, size_t grain_size, const std::function<void(size_t begin, size_t end)>& fn)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	grain_size = std::max<size_t>(1, grain_size);
+	size_t chunk_count = (count + grain_size - 1) / grain_size;
+	if (chunk_count == 1)
+	{
+		fn(0, count);
+		return;
+	}
+
+	std::atomic<size_t> remaining { chunk_count - 1 };
+	for (size_t chunk = 1; chunk < chunk_count; ++chunk)
+	{
+		size_t begin = chunk * grain_size;
+		size_t end = std::min(begin + grain_size, count);
+
+		Submit([&fn, &remaining, begin, end]()
+		{
+			fn(begin, end);
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	// Do the first chunk here then help drain the pool rather than block
+	fn(0, std::min(grain_size, count));
+
+	int index = t_JobSystem == this ? t_WorkerIndex : -1;
+	while (remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!TryRunJob(index))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+std::vector<PX::WorkerStats> PX::JobSystem::GetWorkerStats() const
+{
+	std::vector<WorkerStats> stats(m_Workers.size());
+	for (size_t i = 0; i < m_Workers.size(); ++i)
+	{
+		stats[i].tasksRun = m_Workers[i]->tasksRun.load(std::memory_order_relaxed);
+		stats[i].steals = m_Workers[i]->steals.load(std::memory_order_relaxed);
+		stats[i].idleSeconds = static_cast<double>(m_Workers[i]->idleMicroseconds.load(std::memory_order_relaxed)) / 1000000.0;
+	}
+
+	return stats;
+}
+
+void PX::JobSystem::ResetWorkerStats()
+{
+	for (auto& worker : m_Workers)
+	{
+		worker->tasksRun.store(0, std::memory_order_relaxed);
+		worker->steals.store(0, std::memory_order_relaxed);
+		worker->idleMicroseconds.store(0, std::memory_order_relaxed);
+	}
+}
+
+void PX::JobSystem::Push(Job&& job)
+{
+	// Workers keep what they spawn, everyone else spreads jobs round robin
+	unsigned int index = 0;
+	if (t_JobSystem == this)
+	{
+		index = static_cast<unsigned int>(t_WorkerIndex);
+	}
+	else
+	{
+		index = m_NextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned int>(m_Workers.size());
+	}
+
+	// Counted before it's visible, a thief that takes it straight away must not take the count below zero.
+	// A worker woken early finds nothing for a moment and looks again
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_PendingJobs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Workers[index]->mutex);
+		m_Workers[index]->jobs.push_back(std::move(job));
+	}
+
+	m_SleepCondition.notify_one();
+}
+
+bool PX::JobSystem::Pop(unsigned int index, Job& job)
+{
+	Worker& worker = *m_Workers[index];
+
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.jobs.empty())
+	{
+		return false;
+	}
+
+	job = std::move(worker.jobs.back());
+	worker.jobs.pop_back();
+	return true;
+}
+
+bool PX::JobSystem::Steal(unsigned int start, Job& job)
+{
+	size_t count = m_Workers.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Worker& victim = *m_Workers[(start + i) % count];
+
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool PX::JobSystem::TryRunJob(int index)
+{
+	Job job;
+	bool found = false;
+	bool stolen = false;
+
+	if (index >= 0)
+	{
+		found = Pop(static_cast<unsigned int>(index), job);
+	}
+
+	if (!found)
+	{
+		unsigned int start = index >= 0 ? static_cast<unsigned int>(index) + 1 : 0;
+		found = Steal(start, job);
+		stolen = found;
+	}
+
+	if (!found)
+	{
+		return false;
+	}
+
+	m_PendingJobs.fetch_sub(1, std::memory_order_relaxed);
+
+	if (job.task != nullptr)
+	{
+		job.task->run();
+		job.task->release();
+	}
+	else
+	{
+		job.function();
+	}
+
+	if (index >= 0)
+	{
+		Worker& worker = *m_Workers[index];
+		worker.tasksRun.fetch_add(1, std::memory_order_relaxed);
+		if (stolen)
+		{
+			worker.steals.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return true;
+}
+
+void PX::JobSystem::WorkerMain(unsigned int index)
+{
+	t_JobSystem = this;
+	t_WorkerIndex = static_cast<int>(index);
+
+	Worker& worker = *m_Workers[index];
+	while (true)
+	{
+		if (TryRunJob(static_cast<int>(index)))
+		{
+			continue;
+		}
+
+		auto idle_start = std::chrono::steady_clock::now();
+		{
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_SleepCondition.wait(lock, [this]() { return m_PendingJobs.load(std::memory_order_relaxed) > 0 || !m_Running; });
+
+			if (!m_Running)
+			{
+				return;
+			}
+		}
+
+		auto idle_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - idle_start);
+		worker.idleMicroseconds.fetch_add(static_cast<std::uint64_t>(idle_time.count()), std::memory_order_relaxed);
+	}
+}
+
+void PX::JobSystem::PinThread(std::thread& thread, unsigned int core)
+{
+#ifdef _WIN32
+	SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << core);
+#else
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(core, &cpu_set);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpu_set);
+#endif
+}
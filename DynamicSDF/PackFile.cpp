@@ -0,0 +1,410 @@
+#include "PackFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Bump when the layout changes, an older pack then fails to open and the loose cache is used instead
+	constexpr std::uint32_t FORMAT_VERSION = 1;
+	constexpr char MAGIC[4] = { 'P', 'X', 'P', 'K' };
+
+	// PhysX wants its cooked data 16 byte aligned
+	constexpr size_t BLOB_ALIGNMENT = 16;
+
+	struct PackHeader
+	{
+		char magic[4];
+		std::uint32_t formatVersion;
+		std::uint32_t physxVersion;
+		std::uint32_t entryCount;
+	};
+
+	size_t AlignUp(size_t value)
+	{
+		return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+	}
+}
+
+// Index entries follow the header sorted by key, so a lookup is a binary search over the mapping
+struct PX::PackEntry
+{
+	std::uint64_t key;
+	std::uint32_t type;
+	std::uint32_t padding;
+	std::uint64_t offset;
+	std::uint64_t size;
+	std::uint64_t checksum;
+};
+
+std::uint64_t PX::Checksum(const void* data, size_t size)
+{
+	// 64 bit FNV-1a
+	std::uint64_t value = 14695981039346656037ull;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		value = (value ^ bytes[i]) * 1099511628211ull;
+	}
+
+	return value;
+}
+
+PX::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+PX::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+PX::MappedFile& PX::MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+		std::swap(m_File, other.m_File);
+		std::swap(m_Mapping, other.m_Mapping);
+#endif
+	}
+
+	return *this;
+}
+
+bool PX::MappedFile::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Mapping = mapping;
+	m_Data = static_cast<const unsigned char*>(data);
+	m_Size = static_cast<size_t>(size.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info = {};
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps its own reference, the descriptor isn't needed past this
+	void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_Data = static_cast<const unsigned char*>(data);
+	m_Size = static_cast<size_t>(info.st_size);
+#endif
+
+	return true;
+}
+
+void PX::MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_Data != nullptr) UnmapViewOfFile(m_Data);
+	if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+	if (m_File != nullptr) CloseHandle(m_File);
+	m_Mapping = nullptr;
+	m_File = nullptr;
+#else
+	if (m_Data != nullptr) munmap(const_cast<unsigned char*>(m_Data), m_Size);
+#endif
+
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+PX::MappedInputData::MappedInputData(const void* data, size_t size) : m_Data(static_cast<const unsigned char*>(data)), m_Size(static_cast<physx::PxU32>(size))
+{
+}
+
+physx::PxU32 PX::MappedInputData::read(void* dest, physx::PxU32 count)
+{
+	physx::PxU32 available = std::min(count, m_Size - m_Position);
+	std::memcpy(dest, m_Data + m_Position, available);
+	m_Position += available;
+	return available;
+}
+
+physx::PxU32 PX::MappedInputData::getLength() const
+{
+	return m_Size;
+}
+
+void PX::MappedInputData::seek(physx::PxU32 offset)
+{
+	m_Position = std::min(offset, m_Size);
+}
+
+physx::PxU32 PX::MappedInputData::tell() const
+{
+	return m_Position;
+}
+
+PX::PackFile::~PackFile()
+{
+	Close();
+}
+
+bool PX::PackFile::Open(const std::string& path)
+{
+	Close();
+
+	if (!m_File.Open(path) || m_File.GetSize() < sizeof(PackHeader))
+	{
+		m_File.Close();
+		return false;
+	}
+
+	PackHeader header = {};
+	std::memcpy(&header, m_File.GetData(), sizeof(header));
+
+	// Only the header and index are checked here, the blobs are checked as they're loaded
+	size_t index_end = sizeof(PackHeader) + static_cast<size_t>(header.entryCount) * sizeof(PackEntry);
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.formatVersion != FORMAT_VERSION
+		|| header.physxVersion != PX_PHYSICS_VERSION || index_end > m_File.GetSize())
+	{
+		m_File.Close();
+		return false;
+	}
+
+	m_Entries = reinterpret_cast<const PackEntry*>(m_File.GetData() + sizeof(PackHeader));
+	m_EntryCount = header.entryCount;
+	m_Loaded.assign(m_EntryCount, nullptr);
+	m_LoadedCount = 0;
+	return true;
+}
+
+void PX::PackFile::Close()
+{
+	for (physx::PxBase* asset : m_Loaded)
+	{
+		if (asset != nullptr)
+		{
+			asset->release();
+		}
+	}
+
+	m_Loaded.clear();
+	m_LoadedCount = 0;
+	m_Entries = nullptr;
+	m_EntryCount = 0;
+	m_File.Close();
+}
+
+bool PX::PackFile::Contains(std::uint64_t key) const
+{
+	const PackEntry* end = m_Entries + m_EntryCount;
+	const PackEntry* it = std::lower_bound(m_Entries, end, key, [](const PackEntry& entry, std::uint64_t value) { return entry.key < value; });
+	return it != end && it->key == key;
+}
+
+physx::PxTriangleMesh* PX::PackFile::GetTriangleMesh(physx::PxPhysics& physics, std::uint64_t key)
+{
+	return static_cast<physx::PxTriangleMesh*>(Load(physics, key, PackEntryType::TriangleMesh));
+}
+
+physx::PxConvexMesh* PX::PackFile::GetConvexMesh(physx::PxPhysics& physics, std::uint64_t key)
+{
+	return static_cast<physx::PxConvexMesh*>(Load(physics, key, PackEntryType::ConvexMesh));
+}
+
+physx::PxHeightField* PX::PackFile::GetHeightField(physx::PxPhysics& physics, std::uint64_t key)
+{
+	return static_cast<physx::PxHeightField*>(Load(physics, key, PackEntryType::HeightField));
+}
+
+physx::PxBase* PX::PackFile::Load(physx::PxPhysics& physics, std::uint64_t key, PackEntryType type)
+{
+	const PackEntry* end = m_Entries + m_EntryCount;
+	const PackEntry* it = std::lower_bound(m_Entries, end, key, [](const PackEntry& entry, std::uint64_t value) { return entry.key < value; });
+	if (it == end || it->key != key || it->type != static_cast<std::uint32_t>(type))
+	{
+		return nullptr;
+	}
+
+	size_t index = static_cast<size_t>(it - m_Entries);
+	if (m_Loaded[index] == nullptr)
+	{
+		if (it->offset + it->size > m_File.GetSize())
+		{
+			return nullptr;
+		}
+
+		const unsigned char* data = m_File.GetData() + it->offset;
+		if (Checksum(data, static_cast<size_t>(it->size)) != it->checksum)
+		{
+			return nullptr;
+		}
+
+		MappedInputData input(data, static_cast<size_t>(it->size));
+		physx::PxBase* asset = nullptr;
+		switch (type)
+		{
+		case PackEntryType::TriangleMesh: asset = physics.createTriangleMesh(input); break;
+		case PackEntryType::ConvexMesh: asset = physics.createConvexMesh(input); break;
+		case PackEntryType::HeightField: asset = physics.createHeightField(input); break;
+		}
+
+		if (asset == nullptr)
+		{
+			return nullptr;
+		}
+
+		m_Loaded[index] = asset;
+		m_LoadedCount++;
+	}
+
+	// Every caller gets its own reference, the pack keeps the first one
+	physx::PxBase* asset = m_Loaded[index];
+	switch (type)
+	{
+	case PackEntryType::TriangleMesh: static_cast<physx::PxTriangleMesh*>(asset)->acquireReference(); break;
+	case PackEntryType::ConvexMesh: static_cast<physx::PxConvexMesh*>(asset)->acquireReference(); break;
+	case PackEntryType::HeightField: static_cast<physx::PxHeightField*>(asset)->acquireReference(); break;
+	}
+
+	return asset;
+}
+
+void PX::PackWriter::Add(std::uint64_t key, PackEntryType type, const void* data, size_t size)
+{
+	Blob blob;
+	blob.key = key;
+	blob.type = type;
+	blob.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+
+	// A key added twice keeps the newest blob
+	auto it = std::find_if(m_Entries.begin(), m_Entries.end(), [key](const Blob& entry) { return entry.key == key; });
+	if (it != m_Entries.end())
+	{
+		*it = std::move(blob);
+		return;
+	}
+
+	m_Entries.push_back(std::move(blob));
+}
+
+bool PX::PackWriter::Write(const std::string& path) const
+{
+	std::vector<const Blob*> sorted;
+	for (const Blob& blob : m_Entries)
+	{
+		sorted.push_back(&blob);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const Blob* a, const Blob* b) { return a->key < b->key; });
+
+	PackHeader header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.formatVersion = FORMAT_VERSION;
+	header.physxVersion = PX_PHYSICS_VERSION;
+	header.entryCount = static_cast<std::uint32_t>(sorted.size());
+
+	std::vector<PackEntry> index(sorted.size());
+	size_t offset = AlignUp(sizeof(PackHeader) + index.size() * sizeof(PackEntry));
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		index[i].key = sorted[i]->key;
+		index[i].type = static_cast<std::uint32_t>(sorted[i]->type);
+		index[i].padding = 0;
+		index[i].offset = offset;
+		index[i].size = sorted[i]->data.size();
+		index[i].checksum = Checksum(sorted[i]->data.data(), sorted[i]->data.size());
+		offset = AlignUp(offset + sorted[i]->data.size());
+	}
+
+	// Same write to the side and rename as the mesh cache, so a half written pack is never opened
+	std::error_code error;
+	std::string temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(PackEntry)));
+
+		const char zeros[BLOB_ALIGNMENT] = {};
+		size_t position = sizeof(PackHeader) + index.size() * sizeof(PackEntry);
+		for (size_t i = 0; i < sorted.size(); ++i)
+		{
+			file.write(zeros, static_cast<std::streamsize>(index[i].offset - position));
+			file.write(reinterpret_cast<const char*>(sorted[i]->data.data()), static_cast<std::streamsize>(sorted[i]->data.size()));
+			position = static_cast<size_t>(index[i].offset + index[i].size);
+		}
+
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temp_path, path, error);
+	if (error)
+	{
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,331 @@
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+namespace
+{
+	constexpr size_t SizeClasses[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, 4096 };
+	constexpr size_t SlabSize = 64 * 1024;
+
+	// Thread caches are bounded, past the high mark half of them go back to the shared pool
+	constexpr size_t CacheRefillCount = 32;
+	constexpr size_t CacheHighMark = 128;
+
+	std::atomic<std::uint64_t> g_NextAllocatorId { 1 };
+
+	// The current thread's cache, tagged with the allocator it belongs to
+	thread_local std::uint64_t t_CacheOwner = 0;
+	thread_local void* t_Cache = nullptr;
+
+	// Id of the allocator the current thread is running a frame for, its allocations aren't the step's
+	thread_local std::uint64_t t_FrameOwner = 0;
+
+	std::uint32_t FindSizeClass(size_t size)
+	{
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(std::size(SizeClasses)); ++i)
+		{
+			if (size <= SizeClasses[i])
+			{
+				return i;
+			}
+		}
+
+		return 0xffffffff;
+	}
+
+	const char* FileName(const char* path)
+	{
+		if (path == nullptr)
+		{
+			return "";
+		}
+
+		const char* name = path;
+		for (const char* c = path; *c != '\0'; ++c)
+		{
+			if (*c == '/' || *c == '\\')
+			{
+				name = c + 1;
+			}
+		}
+
+		return name;
+	}
+
+	void UpdatePeak(std::atomic<std::int64_t>& peak, std::int64_t value)
+	{
+		std::int64_t current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+PX::PoolAllocator::PoolAllocator() : m_Id(g_NextAllocatorId.fetch_add(1))
+{
+	static_assert(std::size(SizeClasses) == SizeClassCount, "Size class table does not match SizeClassCount");
+
+	// Category zero catches anything past MaxCategories
+	m_Categories[0] = std::make_unique<Category>();
+	m_Categories[0]->name = "Other";
+	m_CategoryCount = 1;
+}
+
+PX::PoolAllocator::~PoolAllocator()
+{
+	for (void* slab : m_Slabs)
+	{
+		::operator delete(slab, std::align_val_t(16));
+	}
+}
+
+void* PX::PoolAllocator::allocate(size_t size, const char* typeName, const char* filename, int)
+{
+	ThreadCache* cache = GetThreadCache();
+	std::uint32_t size_class = FindSizeClass(size);
+
+	void* block = nullptr;
+	if (size_class == LargeBlock)
+	{
+		block = ::operator new(sizeof(BlockHeader) + size, std::align_val_t(16));
+	}
+	else
+	{
+		block = AllocateBlock(size_class, cache);
+	}
+
+	std::uint32_t category_index = FindCategory(typeName, filename, cache);
+
+	BlockHeader* header = static_cast<BlockHeader*>(block);
+	header->sizeClass = size_class;
+	header->category = category_index;
+	header->size = size;
+
+	// Accounting
+	std::int64_t bytes = static_cast<std::int64_t>(size);
+	Category& category = *m_Categories[category_index];
+	UpdatePeak(category.peakBytes, category.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	category.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	category.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+	category.frameBytes.fetch_add(size, std::memory_order_relaxed);
+
+	UpdatePeak(m_PeakBytes, m_LiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	m_FrameAllocations.fetch_add(1, std::memory_order_relaxed);
+	m_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+	m_TotalBytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (t_FrameOwner != m_Id)
+	{
+		m_StepAllocations.fetch_add(1, std::memory_order_relaxed);
+		m_StepBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	return header + 1;
+}
+
+void PX::PoolAllocator::deallocate(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+
+	std::int64_t bytes = static_cast<std::int64_t>(header->size);
+	m_Categories[header->category]->liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	m_LiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+
+	if (header->sizeClass == LargeBlock)
+	{
+		::operator delete(header, std::align_val_t(16));
+	}
+	else
+	{
+		FreeBlock(header->sizeClass, header, GetThreadCache());
+	}
+}
+
+void PX::PoolAllocator::SetFrameThread(bool frame)
+{
+	t_FrameOwner = frame ? m_Id : 0;
+}
+
+void PX::PoolAllocator::NextFrame(double delta_time)
+{
+	std::lock_guard<std::mutex> lock(m_CategoryMutex);
+
+	std::uint32_t count = m_CategoryCount.load(std::memory_order_acquire);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		Category& category = *m_Categories[i];
+		category.lastFrameAllocations = category.frameAllocations.exchange(0, std::memory_order_relaxed);
+		category.lastFrameBytes = category.frameBytes.exchange(0, std::memory_order_relaxed);
+		category.allocationsPerSecond = delta_time > 0.0 ? static_cast<double>(category.lastFrameAllocations) / delta_time : 0.0;
+	}
+
+	m_LastFrameAllocations = m_FrameAllocations.exchange(0, std::memory_order_relaxed);
+}
+
+std::vector<PX::AllocationStats> PX::PoolAllocator::GetStats() const
+{
+	std::vector<AllocationStats> stats;
+
+	{
+		std::lock_guard<std::mutex> lock(m_CategoryMutex);
+
+		std::uint32_t count = m_CategoryCount.load(std::memory_order_acquire);
+		stats.reserve(count);
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			const Category& category = *m_Categories[i];
+
+			AllocationStats entry;
+			entry.name = category.name;
+			entry.liveBytes = category.liveBytes.load(std::memory_order_relaxed);
+			entry.peakBytes = category.peakBytes.load(std::memory_order_relaxed);
+			entry.totalAllocations = category.totalAllocations.load(std::memory_order_relaxed);
+			entry.frameAllocations = category.lastFrameAllocations;
+			entry.frameBytes = category.lastFrameBytes;
+			entry.allocationsPerSecond = category.allocationsPerSecond;
+			stats.push_back(entry);
+		}
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const AllocationStats& a, const AllocationStats& b) { return a.liveBytes > b.liveBytes; });
+	return stats;
+}
+
+void PX::PoolAllocator::PrintStats(std::ostream& stream, size_t max_categories) const
+{
+	std::vector<AllocationStats> stats = GetStats();
+
+	stream << "PhysX memory - live: " << GetLiveBytes() << " bytes, peak: " << GetPeakBytes() << " bytes, allocations last frame: " << GetFrameAllocations() << '\n';
+	stream << std::left << std::setw(56) << "Category" << std::right << std::setw(14) << "Live" << std::setw(14) << "Peak" << std::setw(12) << "Total" << std::setw(12) << "Frame" << std::setw(12) << "Per sec" << '\n';
+
+	size_t count = std::min(max_categories, stats.size());
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AllocationStats& entry = stats[i];
+		stream << std::left << std::setw(56) << entry.name << std::right
+			<< std::setw(14) << entry.liveBytes
+			<< std::setw(14) << entry.peakBytes
+			<< std::setw(12) << entry.totalAllocations
+			<< std::setw(12) << entry.frameAllocations
+			<< std::setw(12) << std::fixed << std::setprecision(1) << entry.allocationsPerSecond << '\n';
+	}
+}
+
+void* PX::PoolAllocator::AllocateBlock(std::uint32_t size_class, ThreadCache* cache)
+{
+	std::vector<void*>& local = cache->freeBlocks[size_class];
+	if (local.empty())
+	{
+		SizeClassPool& pool = m_Pools[size_class];
+
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if (pool.freeBlocks.empty())
+		{
+			RefillPool(size_class);
+		}
+
+		// Take a batch so the next few allocations on this thread don't touch the lock
+		size_t take = std::min(CacheRefillCount, pool.freeBlocks.size());
+		local.insert(local.end(), pool.freeBlocks.end() - take, pool.freeBlocks.end());
+		pool.freeBlocks.resize(pool.freeBlocks.size() - take);
+	}
+
+	void* block = local.back();
+	local.pop_back();
+	return block;
+}
+
+void PX::PoolAllocator::FreeBlock(std::uint32_t size_class, void* block, ThreadCache* cache)
+{
+	std::vector<void*>& local = cache->freeBlocks[size_class];
+	local.push_back(block);
+
+	if (local.size() > CacheHighMark)
+	{
+		SizeClassPool& pool = m_Pools[size_class];
+		size_t give = local.size() / 2;
+
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.freeBlocks.insert(pool.freeBlocks.end(), local.end() - give, local.end());
+		local.resize(local.size() - give);
+	}
+}
+
+void PX::PoolAllocator::RefillPool(std::uint32_t size_class)
+{
+	// Carve a fresh slab into blocks, the pool mutex is already held
+	size_t block_size = sizeof(BlockHeader) + SizeClasses[size_class];
+	size_t slab_size = std::max(SlabSize, block_size * CacheRefillCount);
+
+	char* slab = static_cast<char*>(::operator new(slab_size, std::align_val_t(16)));
+	{
+		std::lock_guard<std::mutex> lock(m_SlabMutex);
+		m_Slabs.push_back(slab);
+	}
+
+	std::vector<void*>& blocks = m_Pools[size_class].freeBlocks;
+	for (size_t offset = 0; offset + block_size <= slab_size; offset += block_size)
+	{
+		blocks.push_back(slab + offset);
+	}
+}
+
+PX::PoolAllocator::ThreadCache* PX::PoolAllocator::GetThreadCache()
+{
+	if (t_CacheOwner == m_Id)
+	{
+		return static_cast<ThreadCache*>(t_Cache);
+	}
+
+	std::lock_guard<std::mutex> lock(m_CacheMutex);
+	m_ThreadCaches.push_back(std::make_unique<ThreadCache>());
+
+	t_CacheOwner = m_Id;
+	t_Cache = m_ThreadCaches.back().get();
+	return m_ThreadCaches.back().get();
+}
+
+std::uint32_t PX::PoolAllocator::FindCategory(const char* type_name, const char* filename, ThreadCache* cache)
+{
+	// PhysX passes string literals, so the pointers make a cheap per thread key
+	CategoryKey key = { type_name, filename };
+	auto it = cache->categories.find(key);
+	if (it != cache->categories.end())
+	{
+		return it->second;
+	}
+
+	std::string name = type_name != nullptr ? type_name : "Unknown";
+	name += " (";
+	name += FileName(filename);
+	name += ")";
+
+	std::uint32_t index = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_CategoryMutex);
+
+		auto found = m_CategoryLookup.find(name);
+		if (found != m_CategoryLookup.end())
+		{
+			index = found->second;
+		}
+		else if (m_CategoryCount.load(std::memory_order_relaxed) < MaxCategories)
+		{
+			index = m_CategoryCount.load(std::memory_order_relaxed);
+			m_Categories[index] = std::make_unique<Category>();
+			m_Categories[index]->name = name;
+			m_CategoryLookup[name] = index;
+			m_CategoryCount.store(index + 1, std::memory_order_release);
+		}
+	}
+
+	cache->categories[key] = index;
+	return index;
+}
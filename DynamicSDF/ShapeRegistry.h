@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	struct ShapeRegistryStats
+	{
+		// Unique objects the registry holds right now
+		size_t liveMaterials = 0;
+		size_t liveShapes = 0;
+
+		// References handed out that are still held
+		std::uint64_t materialReferences = 0;
+		std::uint64_t shapeReferences = 0;
+
+		// Acquires answered with an object that was already there, and ones that had to create it
+		std::uint64_t materialHits = 0;
+		std::uint64_t materialMisses = 0;
+		std::uint64_t shapeHits = 0;
+		std::uint64_t shapeMisses = 0;
+	};
+
+	// Interns materials by their coefficients and shares non-exclusive shapes by geometry, local pose, material and flags,
+	// so a thousand identical boxes cost one material and one shape. Every acquire takes a reference that a release
+	// gives back, the PhysX object goes when the last one does. Safe to call from several threads at once
+	class ShapeRegistry
+	{
+	public:
+		ShapeRegistry() = default;
+		ShapeRegistry(const ShapeRegistry&) = delete;
+		ShapeRegistry& operator=(const ShapeRegistry&) = delete;
+
+		// Physics creates the objects, set by PX::Physics once PxPhysics exists
+		inline void SetPhysics(physx::PxPhysics* physics) { m_Physics = physics; }
+
+		physx::PxMaterial* AcquireMaterial(physx::PxReal static_friction, physx::PxReal dynamic_friction, physx::PxReal restitution);
+		void ReleaseMaterial(physx::PxMaterial* material);
+
+		// Attach the shape to as many actors as you like, they take PhysX references of their own so it outlives the release
+		physx::PxShape* AcquireShape(const physx::PxGeometry& geometry, const physx::PxMaterial& material,
+			const physx::PxTransform& local_pose = physx::PxTransform(physx::PxIdentity),
+			physx::PxShapeFlags flags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE);
+		void ReleaseShape(physx::PxShape* shape);
+
+		// Drops every reference still held, call it before PxPhysics is released
+		void Clear();
+
+		ShapeRegistryStats GetStats() const;
+		void PrintStats(std::ostream& stream) const;
+
+	private:
+		template <typename T>
+		struct Entry
+		{
+			T* object = nullptr;
+			std::uint64_t references = 0;
+		};
+
+		physx::PxPhysics* m_Physics = nullptr;
+		mutable std::mutex m_Mutex;
+
+		// Keyed by the bytes of everything that tells two objects apart, the reverse maps find the key again on release
+		std::unordered_map<std::string, Entry<physx::PxMaterial>> m_Materials;
+		std::unordered_map<const physx::PxMaterial*, std::string> m_MaterialKeys;
+		std::unordered_map<std::string, Entry<physx::PxShape>> m_Shapes;
+		std::unordered_map<const physx::PxShape*, std::string> m_ShapeKeys;
+
+		ShapeRegistryStats m_Stats;
+	};
+}
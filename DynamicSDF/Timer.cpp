@@ -1,9 +1,23 @@
 #include "Timer.h"
 #include <SDL_timer.h>
 
-Timer::Timer()
+std::int64_t SdlClock::GetCounter()
 {
-	__int64 countsPerSec = SDL_GetPerformanceFrequency();
+	return static_cast<std::int64_t>(SDL_GetPerformanceCounter());
+}
+
+std::int64_t SdlClock::GetFrequency()
+{
+	return static_cast<std::int64_t>(SDL_GetPerformanceFrequency());
+}
+
+Timer::Timer() : Timer(nullptr)
+{
+}
+
+Timer::Timer(Clock* clock) : m_Clock(clock != nullptr ? clock : &m_SdlClock)
+{
+	std::int64_t countsPerSec = m_Clock->GetFrequency();
 	m_SecondsPerCount = 1.0 / static_cast<double>(countsPerSec);
 
 	Reset();
@@ -15,7 +29,7 @@ Timer::~Timer()
 
 void Timer::Start()
 {
-	__int64 startTime = SDL_GetPerformanceCounter();
+	std::int64_t startTime = m_Clock->GetCounter();
 	m_Active = true;
 
 	if (m_Stopped)
@@ -32,7 +46,7 @@ void Timer::Stop()
 {
 	if (!m_Stopped)
 	{
-		__int64 currTime = SDL_GetPerformanceCounter();
+		std::int64_t currTime = m_Clock->GetCounter();
 
 		m_StopTime = currTime;
 		m_Stopped = true;
@@ -41,7 +55,7 @@ void Timer::Stop()
 
 void Timer::Reset()
 {
-	__int64 currTime = SDL_GetPerformanceCounter();
+	std::int64_t currTime = m_Clock->GetCounter();
 
 	m_BaseTime = currTime;
 	m_PrevTime = currTime;
@@ -58,7 +72,7 @@ void Timer::Tick()
 		return;
 	}
 
-	__int64 currTime = SDL_GetPerformanceCounter();
+	std::int64_t currTime = m_Clock->GetCounter();
 	m_CurrTime = currTime;
 
 	// Time difference between this frame and the previous.
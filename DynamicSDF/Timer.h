@@ -1,9 +1,46 @@
 #pragma once
 
+#include <cstdint>
+
+// Source of ticks for the timer, swap it out to drive time manually
+class Clock
+{
+public:
+	virtual ~Clock() = default;
+
+	virtual std::int64_t GetCounter() = 0;
+	virtual std::int64_t GetFrequency() = 0;
+};
+
+// High resolution wall clock backed by SDL
+class SdlClock : public Clock
+{
+public:
+	virtual std::int64_t GetCounter() override;
+	virtual std::int64_t GetFrequency() override;
+};
+
+// Clock that only moves when told to, lets headless runs go faster than real time
+class VirtualClock : public Clock
+{
+public:
+	VirtualClock(std::int64_t frequency = 1000000) : m_Frequency(frequency) {}
+
+	void Advance(double seconds) { m_Counter += static_cast<std::int64_t>(seconds * static_cast<double>(m_Frequency)); }
+
+	virtual std::int64_t GetCounter() override { return m_Counter; }
+	virtual std::int64_t GetFrequency() override { return m_Frequency; }
+
+private:
+	std::int64_t m_Counter = 0;
+	std::int64_t m_Frequency = 1000000;
+};
+
 class Timer
 {
 public:
 	Timer();
+	Timer(Clock* clock);
 	virtual ~Timer();
 
 	virtual void Start();
@@ -18,15 +55,18 @@ public:
 	constexpr bool IsActive() { return m_Active; }
 
 protected:
+	Clock* m_Clock = nullptr;
+	SdlClock m_SdlClock;
+
 	double m_SecondsPerCount = 0.0;
 	double m_DeltaTime = 0.0;
 
-	__int64 m_BaseTime = 0;
-	__int64 m_PausedTime = 0;
-	__int64 m_StopTime = 0;
-	__int64 m_PrevTime = 0;
-	__int64 m_CurrTime = 0;
+	std::int64_t m_BaseTime = 0;
+	std::int64_t m_PausedTime = 0;
+	std::int64_t m_StopTime = 0;
+	std::int64_t m_PrevTime = 0;
+	std::int64_t m_CurrTime = 0;
 
 	bool m_Active = false;
 	bool m_Stopped = false;
-};
\ No newline at end of file
+};
@@ -1,5 +1,9 @@
 #include "Application.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <memory>
+#include <string>
 
 // SDL is needed to handle our main function
 #include <SDL.h>
@@ -15,5 +19,56 @@ int main(int argc, char** argv)
 #endif
 
 	auto application = std::make_unique<Applicataion>();
+
+	// PVD is off unless asked for, --pvd socket|file [--pvd-flags debug,profile,memory]
+	// --cpu skips CUDA and --tune-sdf picks the SDF resolution at startup
+	// --hulls <n> [--hull-verts <n>] swaps the SDF meshes for compounds of up to n convex hulls
+	PX::PvdDesc pvd_desc;
+	PX::ConvexDecompositionDesc hull_desc;
+	bool use_hulls = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		bool valid = false;
+		if (arg == "--cpu")
+		{
+			application->SetUseGpu(false);
+			valid = true;
+		}
+		else if (arg == "--tune-sdf")
+		{
+			application->SetTuneSdf(true);
+			valid = true;
+		}
+		else if (arg == "--hulls" && has_value)
+		{
+			int hulls = std::atoi(argv[++i]);
+			hull_desc.maxHulls = static_cast<physx::PxU32>(hulls > 0 ? hulls : 1);
+			use_hulls = true;
+			valid = true;
+		}
+		else if (arg == "--hull-verts" && has_value)
+		{
+			hull_desc.vertexLimit = static_cast<physx::PxU16>(std::clamp(std::atoi(argv[++i]), 8, 256));
+			valid = true;
+		}
+		else if (arg == "--pvd" && has_value)
+			valid = PX::ParsePvdTransport(argv[++i], pvd_desc.transport);
+		else if (arg == "--pvd-flags" && has_value)
+			valid = PX::ParsePvdFlags(argv[++i], pvd_desc.flags);
+
+		if (!valid)
+		{
+			std::cout << "Ignoring " << arg << '\n';
+		}
+	}
+
+	if (use_hulls)
+	{
+		application->SetConvexHulls(hull_desc);
+	}
+
+	application->SetPvdDesc(pvd_desc);
 	return application->Execute();
 }
\ No newline at end of file
@@ -21,7 +21,13 @@ int Applicataion::Execute()
 
     // Create physics
     m_Physics = std::make_unique<PX::Physics>();
+    m_Physics->SetPvdDesc(m_PvdDesc);
     m_Physics->Setup();
+    m_Physics->SetFixedTimestep(1.0 / 60.0);
+    m_Physics->SetPipelined(true);
+
+    // F9 records a trace of the next few frames, F10 streams the step statistics to a file
+    PX::Profiler& profiler = m_Physics->GetProfiler();
 
     // Create models
     m_DynamicModel1 = std::make_unique<DX::DynamicModel>(m_DxRenderer.get(), m_Physics.get());
@@ -79,12 +85,44 @@ int Applicataion::Execute()
                 // Update world constant buffer with new camera view and perspective
                 SetCameraBuffer();
             }
+            else if (e.type == SDL_KEYDOWN)
+            {
+                if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+                {
+                    profiler.Capture(120, "PhysXTrace.json");
+                }
+                else if (e.key.keysym.scancode == SDL_SCANCODE_F10)
+                {
+                    // Toggle streaming the per step statistics
+                    PX::StatsRecorder& stats = m_Physics->GetStatsRecorder();
+                    if (stats.IsStreaming())
+                        stats.StopStream();
+                    else
+                        stats.StartStream("PhysXStats.csv", PX::StatsFormat::Csv);
+                }
+            }
         }
         else
         {
             m_Timer.Tick();
+
+            // Collect the step started last frame before reading anything back
+            m_Physics->FetchResults();
+            profiler.NextFrame();
             CalculateFramesPerSecond();
 
+            // Read back the poses of the bodies that moved and debug lines while the scene is idle
+            {
+                PX::ProfileZone zone(profiler, "Update");
+                m_Physics->SyncActiveActors();
+            }
+
+            {
+                PX::ProfileZone zone(profiler, "LineManager");
+                line_manager->AddSceneLine(m_Physics.get());
+            }
+
+            // Start the next step, it runs on the PhysX workers while we record the frame
             m_Physics->Simulate(m_Timer.DeltaTime());
 
             // Clear the buffers
@@ -94,11 +132,9 @@ int Applicataion::Execute()
             m_DxShader->Use();
 
             // Render the model
-            m_DynamicModel1->Update();
             m_DxShader->UpdateWorldBuffer(m_DynamicModel1->World, m_DynamicModel1->Colour);
             m_DynamicModel1->Render();
 
-            m_DynamicModel2->Update();
             m_DxShader->UpdateWorldBuffer(m_DynamicModel2->World, m_DynamicModel2->Colour);
             m_DynamicModel2->Render();
 
@@ -106,18 +142,21 @@ int Applicataion::Execute()
             m_DxShader->UpdateWorldBuffer(m_PlaneModel->World, m_PlaneModel->Colour);
             m_PlaneModel->Render();
 
-            // Render lines
-            line_manager->AddSceneLine(m_Physics.get());
-
             // Apply shader
             m_DxLineShader->Use();
             m_DxLineShader->UpdateModel(DirectX::XMMatrixIdentity());
 
-            line_manager->Render();
-            line_manager->ClearLines();
+            {
+                PX::ProfileZone zone(profiler, "LineManager");
+                line_manager->Render();
+                line_manager->ClearLines();
+            }
 
             // Display the rendered scene
-            m_DxRenderer->Present();
+            {
+                PX::ProfileZone zone(profiler, "Present");
+                m_DxRenderer->Present();
+            }
         }
     }
 
@@ -219,20 +258,37 @@ void Applicataion::SDLCleanup()
 
 void Applicataion::CalculateFramesPerSecond()
 {
-    // Changes the window title to show the frames per second and average frame time every second
+    // Changes the window title to show the frames per second, average frame time and how much of the physics step overlapped the frame and the heap allocations per step before and after the scratch block every second
 
     static double time = 0;
     static int frameCount = 0;
+    static double overlap = 0;
+    static int stepCount = 0;
 
     frameCount++;
     time += m_Timer.DeltaTime();
+
+    const PX::PipelineStats& stats = m_Physics->GetPipelineStats();
+    if (stats.fetched)
+    {
+        overlap += stats.overlapRatio;
+        stepCount++;
+    }
+
     if (time > 1.0f)
     {
         auto fps = frameCount;
+        auto overlap_percent = stepCount > 0 ? static_cast<int>(100.0 * overlap / stepCount) : 0;
         time = 0.0f;
         frameCount = 0;
-
-        auto title = "PhysX Samples - JointsFixed - FPS: " + std::to_string(fps) + " (" + std::to_string(1000.0f / fps) + " ms)";
+        overlap = 0.0;
+        stepCount = 0;
+
+        const PX::ScratchStats& scratch = m_Physics->GetScratchStats();
+        const PX::ActiveActorStats& active = m_Physics->GetActiveActorStats();
+        auto title = "PhysX Samples - JointsFixed - FPS: " + std::to_string(fps) + " (" + std::to_string(1000.0f / fps) + " ms) - Physics overlap: " + std::to_string(overlap_percent) + "%"
+            + " - Allocs/step: " + std::to_string(static_cast<int>(scratch.baselineAllocations)) + " -> " + std::to_string(scratch.stepAllocations)
+            + " - Active: " + std::to_string(active.active) + "/" + std::to_string(active.total);
         SDL_SetWindowTitle(m_SdlWindow, title.c_str());
     }
 }
@@ -63,14 +63,22 @@ void DX::DynamicModel::CreateIndexBuffer()
 
 void DX::DynamicModel::CreatePhysicsActor()
 {
-	physx::PxMaterial* material = m_Physics->GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
-	physx::PxShape* shape = m_Physics->GetPhysics()->createShape(physx::PxBoxGeometry(m_Dimensions.x, m_Dimensions.y, m_Dimensions.z), *material);
+	// Every box of the same size shares one material and one shape through the registry
+	PX::ShapeRegistry& registry = m_Physics->GetShapeRegistry();
+	physx::PxMaterial* material = registry.AcquireMaterial(0.4f, 0.4f, 0.4f);
+
+	// Collide as the cheapest primitive that fits the render mesh, or the tighter box when none fits closely enough
+	PX::PrimitiveFitResult fit = PX::FitPrimitives(m_MeshData);
+	m_Bounds = fit.bounds;
+	const PX::PrimitiveFit& primitive = fit.GetPrimitive();
+	physx::PxShape* shape = registry.AcquireShape(primitive.geometry.any(), *material, primitive.localPose);
 
 	// Set position
 	physx::PxVec3 position = physx::PxVec3(physx::PxReal(m_Position.x), physx::PxReal(m_Position.y), physx::PxReal(m_Position.z));
 	physx::PxTransform transform(position);
 
 	m_Body = m_Physics->GetPhysics()->createRigidDynamic(transform);
+	m_Body->userData = static_cast<PX::ActorOwner*>(this);
 	m_Body->attachShape(*shape);
 	physx::PxRigidBodyExt::updateMassAndInertia(*m_Body, 100.0f);
 	m_Physics->GetScene()->addActor(*m_Body);
@@ -99,7 +107,11 @@ void DX::DynamicModel::Render()
 
 void DX::DynamicModel::Update()
 {
-	physx::PxTransform global_pose = m_Body->getGlobalPose();
+	SyncTransform(m_Physics->GetInterpolatedPose(m_Body));
+}
+
+void DX::DynamicModel::SyncTransform(const physx::PxTransform& global_pose)
+{
 	m_Position.x = global_pose.p.x;
 	m_Position.y = global_pose.p.y;
 	m_Position.z = global_pose.p.z;
@@ -1,21 +1,118 @@
 #include "Physics.h"
-constexpr auto PVD_HOST = "127.0.0.1";
-
-//// Collision callback
-//class SimulationCallback : public physx::PxSimulationEventCallback
-//{
-//public:
-//    virtual void onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count) override {}
-//    virtual void onWake(physx::PxActor** actors, physx::PxU32 count) override {}
-//    virtual void onSleep(physx::PxActor** actors, physx::PxU32 count) override {}
-//    virtual void onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 nbPairs) override {}
-//    virtual void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count) override {}
-//    virtual void onAdvance(const physx::PxRigidBody* const* bodyBuffer, const physx::PxTransform* poseBuffer, const physx::PxU32 count) override {}
-//};
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+constexpr size_t SCRATCH_GRANULARITY = 16 * 1024;
+
+namespace
+{
+    // Continuation for processCallbacks, a worker releases it once the last callback task is done
+    class CallbacksDoneTask : public physx::PxLightCpuTask
+    {
+    public:
+        virtual const char* getName() const override { return "CallbacksDone"; }
+        virtual void run() override {}
+
+        virtual void release() override
+        {
+            physx::PxLightCpuTask::release();
+
+            // Notify under the lock, the waiter owns this task and may destroy it as soon as it sees done
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Done = true;
+            m_Condition.notify_one();
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Done; });
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Done = false;
+    };
+}
+
+bool PX::ParsePvdTransport(const std::string& name, PvdTransport& transport)
+{
+    if (name == "none")
+        transport = PvdTransport::None;
+    else if (name == "socket")
+        transport = PvdTransport::Socket;
+    else if (name == "file")
+        transport = PvdTransport::File;
+    else
+        return false;
+
+    return true;
+}
+
+const char* PX::GetPvdTransportName(PvdTransport transport)
+{
+    switch (transport)
+    {
+    case PvdTransport::Socket: return "socket";
+    case PvdTransport::File: return "file";
+    default: return "none";
+    }
+}
+
+bool PX::ParsePvdFlags(const std::string& text, physx::PxPvdInstrumentationFlags& flags)
+{
+    physx::PxPvdInstrumentationFlags parsed;
+
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+
+        std::string name = text.substr(start, end - start);
+        if (name == "debug")
+            parsed |= physx::PxPvdInstrumentationFlag::eDEBUG;
+        else if (name == "profile")
+            parsed |= physx::PxPvdInstrumentationFlag::ePROFILE;
+        else if (name == "memory")
+            parsed |= physx::PxPvdInstrumentationFlag::eMEMORY;
+        else if (name == "all")
+            parsed |= physx::PxPvdInstrumentationFlag::eALL;
+        else
+            return false;
+
+        start = end + 1;
+    }
+
+    flags = parsed;
+    return true;
+}
 
 PX::Physics::~Physics()
 {
+    FetchResults();
+
+#ifdef _DEBUG
+    // Everything still held at shutdown, the registry's materials and shapes are given back below
+    m_AllocatorCallback.PrintStats(std::cout);
+    m_ShapeRegistry.PrintStats(std::cout);
+#endif
+
+    if (m_Scene != nullptr) m_Scene->release();
+    m_ShapeRegistry.Clear();
+    ReleaseScratch();
+    m_MeshCache.ClosePack();
     if (m_Physics != nullptr) m_Physics->release();
+
+    // The client disconnects and flushes on release, the transport has to outlive it
+    if (m_Pvd != nullptr) m_Pvd->release();
+    if (m_Transport != nullptr) m_Transport->release();
     if (m_Foundation != nullptr) m_Foundation->release();
 }
 
@@ -34,43 +131,494 @@ void PX::Physics::Setup()
 
 void PX::Physics::Simulate(double delta_time)
 {
-    m_Scene->simulate(static_cast<physx::PxReal>(delta_time));
-    m_Scene->fetchResults(true);
+    ProfileZone zone(m_Profiler, "Simulate");
+    m_AllocatorCallback.NextFrame(delta_time);
+
+    // A step left running last frame has to finish before we can start another
+    FetchResults();
+    m_FrameSteps = 0;
+
+    if (!m_FixedTimestep)
+    {
+        Step(delta_time, true);
+        return;
+    }
+
+    m_Accumulator += delta_time;
+
+    int steps = 0;
+    while (m_Accumulator >= m_StepSize && steps < m_MaxStepsPerFrame)
+    {
+        // Keep the poses from before the final step of this frame so rendering can blend towards the new ones
+        bool last_step = (m_Accumulator - m_StepSize < m_StepSize) || (steps + 1 == m_MaxStepsPerFrame);
+        if (last_step)
+        {
+            StorePreviousPoses();
+        }
+
+        Step(m_StepSize, last_step);
+
+        m_Accumulator -= m_StepSize;
+        steps++;
+    }
+
+    // A slow frame leaves more time than we are allowed to simulate, drop it rather than spiral
+    if (m_Accumulator >= m_StepSize)
+    {
+        m_Accumulator = std::fmod(m_Accumulator, m_StepSize);
+    }
+
+    m_InterpolationAlpha = m_Accumulator / m_StepSize;
+}
+
+void PX::Physics::Step(double step_size, bool last_step)
+{
+    // A frame without a step keeps the last list, interpolation still moves those bodies
+    if (m_FrameSteps++ == 0)
+    {
+        m_ActiveActors.clear();
+    }
+
+    ResizeScratch();
+
+    m_StepStartAllocations = m_AllocatorCallback.GetStepAllocations();
+    m_StepStartBytes = m_AllocatorCallback.GetStepAllocatedBytes();
+    m_StepStartTime = std::chrono::steady_clock::now();
+
+    m_Scene->simulate(static_cast<physx::PxReal>(step_size), nullptr, m_ScratchBlock, static_cast<physx::PxU32>(m_ScratchSize));
+
+    // Leave the final step running, the next FetchResults picks it up
+    if (m_Pipelined && last_step)
+    {
+        // What the frame allocates from here on isn't the step's
+        m_AllocatorCallback.SetFrameThread(true);
+        m_Simulating = true;
+        m_SimulateStartTime = std::chrono::steady_clock::now();
+        return;
+    }
+
+    Fetch(true);
+    EndStep();
+}
+
+void PX::Physics::SetPipelined(bool pipelined)
+{
+    if (!pipelined)
+    {
+        FetchResults();
+    }
+
+    m_Pipelined = pipelined;
+}
+
+void PX::Physics::FetchResults()
+{
+    m_PipelineStats = PipelineStats();
+    if (!m_Simulating)
+    {
+        return;
+    }
+
+    ProfileZone zone(m_Profiler, "FetchResults");
+    m_AllocatorCallback.SetFrameThread(false);
+    auto fetch_time = std::chrono::steady_clock::now();
+
+    m_PipelineStats.fetched = true;
+    m_PipelineStats.overlapMs = std::chrono::duration<double, std::milli>(fetch_time - m_SimulateStartTime).count();
+
+    // Poll first, if the workers are already done the whole step was hidden behind the frame
+    if (Fetch(false))
+    {
+        m_PipelineStats.completedEarly = true;
+    }
+    else
+    {
+        Fetch(true);
+        m_PipelineStats.waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fetch_time).count();
+    }
+
+    double total_ms = m_PipelineStats.overlapMs + m_PipelineStats.waitMs;
+    m_PipelineStats.overlapRatio = total_ms > 0.0 ? m_PipelineStats.overlapMs / total_ms : 1.0;
+
+    m_Simulating = false;
+    EndStep();
+}
+
+bool PX::Physics::Fetch(bool block)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+
+    auto start = Clock::now();
+    m_FetchStats = FetchStats();
+    m_FetchStats.parallelCallbacks = m_ParallelCallbacks;
+
+    if (!m_ParallelCallbacks)
+    {
+        if (!m_Scene->fetchResults(block))
+        {
+            return false;
+        }
+
+        m_FetchStats.startMs = elapsed_ms(start, Clock::now());
+        m_FetchStats.totalMs = m_FetchStats.startMs;
+        return true;
+    }
+
+    // Swaps the buffers but holds the contact reports back for processCallbacks
+    const physx::PxContactPairHeader* pair_headers = nullptr;
+    physx::PxU32 pair_count = 0;
+    {
+        ProfileZone zone(m_Profiler, "FetchResultsStart");
+        if (!m_Scene->fetchResultsStart(pair_headers, pair_count, block))
+        {
+            return false;
+        }
+    }
+
+    auto started = Clock::now();
+    m_FetchStats.contactPairs = pair_count;
+
+    // Batches of contact pairs go to the workers as tasks that all lead into the continuation. Its own
+    // reference keeps it from running before they are all submitted
+    {
+        ProfileZone zone(m_Profiler, "ProcessCallbacks");
+        CallbacksDoneTask done;
+        done.setContinuation(*m_Scene->getTaskManager(), nullptr);
+        m_Scene->processCallbacks(&done);
+        done.removeReference();
+        done.Wait();
+    }
+
+    auto processed = Clock::now();
+
+    // Triggers, wakes, sleeps and breaks still fire here, on this thread
+    {
+        ProfileZone zone(m_Profiler, "FetchResultsFinish");
+        m_Scene->fetchResultsFinish();
+    }
+
+    auto finished = Clock::now();
+    m_FetchStats.startMs = elapsed_ms(start, started);
+    m_FetchStats.callbacksMs = elapsed_ms(started, processed);
+    m_FetchStats.finishMs = elapsed_ms(processed, finished);
+    m_FetchStats.totalMs = elapsed_ms(start, finished);
+    return true;
+}
+
+void PX::Physics::EndStep()
+{
+    EndStepAccounting();
+
+    // For a pipelined step the wall time covers the whole overlap, not just the time the workers were busy
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_StepStartTime).count();
+    m_Scene->getSimulationStatistics(m_SimulationStatistics);
+    m_StatsRecorder.Record(m_SimulationStatistics, wall_ms);
+
+    GatherActiveActors();
+
+    // The step's callbacks ran during fetchResults, their events go to the consumer as one frame
+    m_SimulationEvents.Publish();
+}
+
+void PX::Physics::GatherActiveActors()
+{
+    size_t previous = m_ActiveActors.size();
+
+    physx::PxU32 count = 0;
+    physx::PxActor** actors = m_Scene->getActiveActors(count);
+    for (physx::PxU32 i = 0; i < count; ++i)
+    {
+        if (physx::PxRigidActor* actor = actors[i]->is<physx::PxRigidActor>())
+        {
+            m_ActiveActors.push_back(actor);
+        }
+    }
+
+    // A body awake for several steps of the frame is only synced once
+    if (previous > 0)
+    {
+        std::sort(m_ActiveActors.begin(), m_ActiveActors.end());
+        m_ActiveActors.erase(std::unique(m_ActiveActors.begin(), m_ActiveActors.end()), m_ActiveActors.end());
+    }
+}
+
+void PX::Physics::SyncActiveActors()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (physx::PxRigidActor* actor : m_ActiveActors)
+    {
+        if (actor->userData != nullptr)
+        {
+            static_cast<ActorOwner*>(actor->userData)->SyncTransform(GetInterpolatedPose(actor));
+        }
+    }
+
+    m_ActiveActorStats.active = m_ActiveActors.size();
+    m_ActiveActorStats.total = m_Scene->getNbActors(physx::PxActorTypeFlag::eRIGID_DYNAMIC);
+    m_ActiveActorStats.ratio = m_ActiveActorStats.total > 0 ? static_cast<double>(m_ActiveActorStats.active) / static_cast<double>(m_ActiveActorStats.total) : 0.0;
+    m_ActiveActorStats.syncMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PX::Physics::OnActorsRemoved(physx::PxRigidActor* const* actors, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_PreviousPoses.erase(actors[i]);
+    }
+
+    if (count == 1)
+    {
+        m_ActiveActors.erase(std::remove(m_ActiveActors.begin(), m_ActiveActors.end(), actors[0]), m_ActiveActors.end());
+        return;
+    }
+
+    // A whole pool going at once, sorted so each active actor is one lookup rather than a pass over them all
+    std::vector<physx::PxRigidActor*> removed(actors, actors + count);
+    std::sort(removed.begin(), removed.end());
+    m_ActiveActors.erase(std::remove_if(m_ActiveActors.begin(), m_ActiveActors.end(),
+        [&removed](physx::PxRigidActor* actor) { return std::binary_search(removed.begin(), removed.end(), actor); }), m_ActiveActors.end());
+}
+
+void PX::Physics::SetScratchDesc(const ScratchDesc& desc)
+{
+    // The block can't change under a running step
+    FetchResults();
+    ReleaseScratch();
+
+    m_ScratchDesc = desc;
+    m_ScratchStats = ScratchStats();
+    m_ScratchHistory.assign(std::max<size_t>(1, desc.window), 0);
+    m_ScratchHistoryIndex = 0;
+    m_BaselineSteps = 0;
+    m_BaselineAllocations = 0;
+}
+
+void PX::Physics::ResizeScratch()
+{
+    size_t target = m_ScratchDesc.initialSize;
+    if (m_ScratchDesc.autoSize)
+    {
+        target = std::max(target, m_ScratchStats.highWaterBytes);
+    }
+
+    target = (target + SCRATCH_GRANULARITY - 1) / SCRATCH_GRANULARITY * SCRATCH_GRANULARITY;
+    target = std::min(target, m_ScratchDesc.maxSize / SCRATCH_GRANULARITY * SCRATCH_GRANULARITY);
+
+    // Only ever grow, a smaller block would just push the big steps back onto the heap
+    if (target <= m_ScratchSize)
+    {
+        return;
+    }
+
+    ReleaseScratch();
+
+    // Goes through our allocator so it shows up in the memory stats, its blocks are 16 byte aligned
+    m_ScratchBlock = m_AllocatorCallback.allocate(target, "Scratch block", __FILE__, __LINE__);
+    m_ScratchSize = target;
+    m_ScratchStats.sizeBytes = target;
+    m_ScratchStats.resizes++;
+
+    // A bigger block moves more onto it, the quietest step has to be found again
+    m_QuietAllocations = UINT64_MAX;
+    m_QuietBytes = UINT64_MAX;
+}
+
+void PX::Physics::ReleaseScratch()
+{
+    if (m_ScratchBlock != nullptr)
+    {
+        m_AllocatorCallback.deallocate(m_ScratchBlock);
+    }
+
+    m_ScratchBlock = nullptr;
+    m_ScratchSize = 0;
+    m_ScratchStats.sizeBytes = 0;
+}
+
+void PX::Physics::EndStepAccounting()
+{
+    // Counts what the step allocated, a pipelined step's main thread was running the frame and is left out
+    m_ScratchStats.stepAllocations = m_AllocatorCallback.GetStepAllocations() - m_StepStartAllocations;
+    m_ScratchStats.stepBytes = m_AllocatorCallback.GetStepAllocatedBytes() - m_StepStartBytes;
+    m_ScratchStats.spillBytes = 0;
+
+    if (m_ScratchSize == 0)
+    {
+        m_BaselineSteps++;
+        m_BaselineAllocations += m_ScratchStats.stepAllocations;
+        m_ScratchStats.baselineAllocations = static_cast<double>(m_BaselineAllocations) / static_cast<double>(m_BaselineSteps);
+    }
+
+    if (m_ScratchHistory.empty())
+    {
+        m_ScratchHistory.assign(std::max<size_t>(1, m_ScratchDesc.window), 0);
+    }
+
+    // Without a block everything the step allocated is all there is to size the first one from
+    size_t sample = static_cast<size_t>(m_ScratchStats.stepBytes);
+    if (m_ScratchSize > 0)
+    {
+        // PhysX doesn't say how much of the block it used. Some of what it allocates goes to the heap with any block,
+        // so a step only spilled when it allocated more than the quietest step with this block, and more than a step
+        // without one did on average. Then it needed at least the block plus the difference
+        bool above_baseline = m_BaselineSteps == 0 || static_cast<double>(m_ScratchStats.stepAllocations) > m_ScratchStats.baselineAllocations;
+        bool spilled = m_ScratchStats.stepAllocations > m_QuietAllocations && m_ScratchStats.stepBytes > m_QuietBytes && above_baseline;
+        m_QuietAllocations = std::min(m_QuietAllocations, m_ScratchStats.stepAllocations);
+        m_QuietBytes = std::min(m_QuietBytes, m_ScratchStats.stepBytes);
+
+        m_ScratchStats.spillBytes = spilled ? m_ScratchStats.stepBytes - m_QuietBytes : 0;
+        sample = spilled ? m_ScratchSize + static_cast<size_t>(m_ScratchStats.spillBytes) : 0;
+    }
+
+    m_ScratchHistory[m_ScratchHistoryIndex] = sample;
+    m_ScratchHistoryIndex = (m_ScratchHistoryIndex + 1) % m_ScratchHistory.size();
+    m_ScratchStats.highWaterBytes = *std::max_element(m_ScratchHistory.begin(), m_ScratchHistory.end());
+}
+
+void PX::Physics::SetFixedTimestep(double step_size, int max_steps_per_frame)
+{
+    m_FixedTimestep = true;
+    m_StepSize = step_size;
+    m_MaxStepsPerFrame = max_steps_per_frame < 1 ? 1 : max_steps_per_frame;
+    m_Accumulator = 0.0;
+    m_InterpolationAlpha = 1.0;
+    m_PreviousPoses.clear();
+}
+
+void PX::Physics::DisableFixedTimestep()
+{
+    m_FixedTimestep = false;
+    m_Accumulator = 0.0;
+    m_InterpolationAlpha = 1.0;
+    m_PreviousPoses.clear();
+}
+
+physx::PxTransform PX::Physics::GetInterpolatedPose(physx::PxRigidActor* actor) const
+{
+    physx::PxTransform current = actor->getGlobalPose();
+    if (!m_FixedTimestep)
+    {
+        return current;
+    }
+
+    auto it = m_PreviousPoses.find(actor);
+    if (it == m_PreviousPoses.end())
+    {
+        return current;
+    }
+
+    const physx::PxTransform& previous = it->second;
+    physx::PxReal alpha = static_cast<physx::PxReal>(m_InterpolationAlpha);
+
+    physx::PxVec3 position = previous.p + (current.p - previous.p) * alpha;
+    physx::PxQuat rotation = physx::PxSlerp(alpha, previous.q, current.q);
+    return physx::PxTransform(position, rotation);
+}
+
+void PX::Physics::StorePreviousPoses()
+{
+    // Only the bodies awake last step, a sleeping one hasn't moved and one that wakes up this step starts from its current pose
+    m_PreviousPoses.clear();
+    for (physx::PxRigidActor* actor : m_ActiveActors)
+    {
+        m_PreviousPoses[actor] = actor->getGlobalPose();
+    }
 }
 
 void PX::Physics::CreateFoundationAndPhysics()
 {
     // Physics
-    m_Foundation = PxCreateFoundation(PX_PHYSICS_VERSION, m_DefaultAllocatorCallback, m_DefaultErrorCallback);
+    m_Foundation = PxCreateFoundation(PX_PHYSICS_VERSION, m_AllocatorCallback, m_DefaultErrorCallback);
     if (m_Foundation == nullptr)
     {
-        throw std::exception("PxCreateFoundation failed!");
+        throw std::runtime_error("PxCreateFoundation failed!");
     }
 
+    // Type names are how the allocator splits memory into categories
+    m_Foundation->setReportAllocationNames(true);
+
     // Create PVD client
-    m_Pvd = PxCreatePvd(*m_Foundation);
-    m_Transport = physx::PxDefaultPvdSocketTransportCreate(PVD_HOST, 5425, 10);
-    m_Pvd->connect(*m_Transport, physx::PxPvdInstrumentationFlag::eALL);
+    ConnectPvd();
 
     // Create physics
     m_Physics = PxCreatePhysics(PX_PHYSICS_VERSION, *m_Foundation, physx::PxTolerancesScale(), true, m_Pvd);
     if (m_Physics == nullptr)
     {
-        throw std::exception("PxCreatePhysics failed!");
+        throw std::runtime_error("PxCreatePhysics failed!");
+    }
+
+    // Shared materials and shapes come from here
+    m_ShapeRegistry.SetPhysics(m_Physics);
+}
+
+void PX::Physics::ConnectPvd()
+{
+    if (m_PvdDesc.transport == PvdTransport::None)
+    {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (m_PvdDesc.transport == PvdTransport::Socket)
+    {
+        m_Transport = physx::PxDefaultPvdSocketTransportCreate(m_PvdDesc.host.c_str(), m_PvdDesc.port, m_PvdDesc.timeoutMs);
+    }
+    else
+    {
+        m_Transport = physx::PxDefaultPvdFileTransportCreate(m_PvdDesc.filePath.c_str());
+    }
+
+    if (m_Transport != nullptr)
+    {
+        m_Pvd = PxCreatePvd(*m_Foundation);
     }
+
+    // Nobody listening isn't an error, carry on without PVD rather than paying for the instrumentation anyway
+    if (m_Pvd == nullptr || !m_Pvd->connect(*m_Transport, m_PvdDesc.flags))
+    {
+        std::cout << "PVD: could not connect over " << GetPvdTransportName(m_PvdDesc.transport) << ", running without it\n";
+
+        if (m_Pvd != nullptr) m_Pvd->release();
+        if (m_Transport != nullptr) m_Transport->release();
+        m_Pvd = nullptr;
+        m_Transport = nullptr;
+    }
+
+    m_PvdSetupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void PX::Physics::CreateScene()
 {
-    // Create CPU dispatcher
-    physx::PxDefaultCpuDispatcher* dispatcher = physx::PxDefaultCpuDispatcherCreate(2);
+    // Create CPU dispatcher, the pool is sized from the hardware unless told otherwise
+    m_JobSystem = std::make_unique<JobSystem>(m_JobSystemDesc);
 
     // Create scene
     physx::PxSceneDesc scene_desc(m_Physics->getTolerancesScale());
     scene_desc.gravity = physx::PxVec3(0.0f, -9.81f, 0.0f);
-    scene_desc.cpuDispatcher = dispatcher;
+    scene_desc.cpuDispatcher = m_JobSystem.get();
     scene_desc.filterShader = physx::PxDefaultSimulationFilterShader;
-    // scene_desc.simulationEventCallback = this;
+
+    // Keeps the list of bodies that moved each step, the transform sync only walks those
+    scene_desc.flags |= physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+
+    // Events are copied into frames for a consumer, contact reports also need the notify flags from our filter shader
+    scene_desc.simulationEventCallback = &m_SimulationEvents;
+    SimulationEvents::FilterShaderData filter_data;
+    filter_data.reportPersists = m_SimulationEvents.GetDesc().reportPersists;
+    if (m_SimulationEvents.GetDesc().reportContacts)
+    {
+        scene_desc.filterShader = SimulationEvents::FilterShader;
+        scene_desc.filterShaderData = &filter_data;
+        scene_desc.filterShaderDataSize = sizeof(filter_data);
+    }
 
     m_Scene = m_Physics->createScene(scene_desc);
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	struct JobSystemDesc
+	{
+		// Number of worker threads, zero sizes the pool from the hardware concurrency
+		unsigned int workerCount = 0;
+
+		// Pin each worker to its own core, core 0 is left for the main thread
+		bool pinThreads = false;
+	};
+
+	struct WorkerStats
+	{
+		std::uint64_t tasksRun = 0;
+		std::uint64_t steals = 0;
+		double idleSeconds = 0.0;
+	};
+
+	// Work-stealing thread pool, used as the PhysX CPU dispatcher and for application jobs so they share the same threads
+	class JobSystem : public physx::PxCpuDispatcher
+	{
+	public:
+		JobSystem(const JobSystemDesc& desc = JobSystemDesc());
+		virtual ~JobSystem();
+
+		// Called by PhysX to schedule a task
+		virtual void submitTask(physx::PxBaseTask& task) override;
+		virtual uint32_t getWorkerCount() const override;
+
+		// Queue an application job
+		void Submit(std::function<void()> job);
+
+		// Split [0, count) into chunks of grain_size and run them across the pool, the calling thread helps until all are done
+		void ParallelFor(size_t count, size_t grain_size, const std::function<void(size_t begin, size_t end)>& fn);
+
+		// Per worker counters
+		std::vector<WorkerStats> GetWorkerStats() const;
+		void ResetWorkerStats();
+
+	private:
+		struct Job
+		{
+			physx::PxBaseTask* task = nullptr;
+			std::function<void()> function;
+		};
+
+		// Each worker owns a deque, it pops from the back and thieves take from the front
+		struct Worker
+		{
+			std::thread thread;
+			std::mutex mutex;
+			std::deque<Job> jobs;
+
+			std::atomic<std::uint64_t> tasksRun { 0 };
+			std::atomic<std::uint64_t> steals { 0 };
+			std::atomic<std::uint64_t> idleMicroseconds { 0 };
+		};
+
+		std::vector<std::unique_ptr<Worker>> m_Workers;
+		std::atomic<unsigned int> m_NextWorker { 0 };
+		std::atomic<int> m_PendingJobs { 0 };
+		bool m_Running = true;
+
+		// Idle workers sleep here until a job is pushed
+		std::mutex m_SleepMutex;
+		std::condition_variable m_SleepCondition;
+
+		void Push(Job&& job);
+		bool Pop(unsigned int index, Job& job);
+		bool Steal(unsigned int start, Job& job);
+		bool TryRunJob(int index);
+		void WorkerMain(unsigned int index);
+		void PinThread(std::thread& thread, unsigned int core);
+	};
+}
@@ -4,10 +4,11 @@
 #include <DirectXMath.h>
 #include "Vertex.h"
 #include "Physics.h"
+#include "PrimitiveFit.h"
 
 namespace DX
 {
-	class KinematicModel
+	class KinematicModel : public PX::ActorOwner
 	{
 	public:
 		KinematicModel(DX::Renderer* renderer, PX::Physics* physics);
@@ -20,9 +21,12 @@ namespace DX
 		// Render the model
 		void Render();
 
-		// Update model
+		// Update model from the body whether it moved or not
 		void Update();
 
+		// Rebuild World from the body's pose, the active actor sync calls it for bodies that moved
+		void SyncTransform(const physx::PxTransform& pose) override;
+
 		// World 
 		DirectX::XMMATRIX World = DirectX::XMMatrixIdentity();
 
@@ -32,6 +36,9 @@ namespace DX
 		// Get actor
 		inline physx::PxRigidDynamic* GetBody() { return m_Body; }
 
+		// Local bounds of the render mesh, move them by the body's pose to cull
+		inline const PX::MeshBounds& GetBounds() const { return m_Bounds; }
+
 	private:
 		DX::Renderer* m_DxRenderer = nullptr;
 
@@ -48,6 +55,7 @@ namespace DX
 
 		// Mesh data
 		MeshData m_MeshData;
+		PX::MeshBounds m_Bounds;
 
 		// Physics
 		PX::Physics* m_Physics = nullptr;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "Vertex.h"
+
+namespace PX
+{
+	// Ordered by what PhysX pays per contact, cheapest first
+	enum class PrimitiveType
+	{
+		Sphere,
+		Capsule,
+		Box,
+		OrientedBox
+	};
+
+	const char* GetPrimitiveTypeName(PrimitiveType type);
+
+	// Local space bounds of a mesh, move them with the body's pose to cull
+	struct MeshBounds
+	{
+		physx::PxBounds3 aabb = physx::PxBounds3::empty();
+		physx::PxVec3 sphereCenter = physx::PxVec3(0.0f);
+		physx::PxReal sphereRadius = 0.0f;
+	};
+
+	struct PrimitiveFit
+	{
+		PrimitiveType type = PrimitiveType::Box;
+
+		// Geometry sits at localPose in the mesh's space, capsules lie along the pose's x axis like PhysX expects
+		physx::PxGeometryHolder geometry;
+		physx::PxTransform localPose = physx::PxTransform(physx::PxIdentity);
+
+		physx::PxReal volume = 0.0f;
+
+		// Volume the primitive adds over the mesh, as a fraction of the mesh's volume
+		physx::PxReal error = 0.0f;
+	};
+
+	struct PrimitiveFitDesc
+	{
+		// Most extra volume a primitive may add before the mesh is kept instead
+		physx::PxReal maxVolumeError = 0.15f;
+	};
+
+	struct PrimitiveFitResult
+	{
+		MeshBounds bounds;
+		physx::PxReal meshVolume = 0.0f;
+
+		// One per type in PrimitiveType order
+		std::vector<PrimitiveFit> candidates;
+
+		// Index into candidates, -1 when nothing is within the tolerance
+		int picked = -1;
+
+		// The picked primitive, or the tighter box when nothing is within the tolerance
+		const PrimitiveFit& GetPrimitive() const;
+	};
+
+	// Bounds alone, for meshes that keep their cooked collision
+	MeshBounds ComputeMeshBounds(const DX::MeshData& mesh);
+
+	// Fits every primitive around the mesh and picks the cheapest one within the tolerance
+	PrimitiveFitResult FitPrimitives(const DX::MeshData& mesh, const PrimitiveFitDesc& desc = PrimitiveFitDesc());
+
+	// Shape for a fit with its local pose applied
+	physx::PxShape* CreatePrimitiveShape(physx::PxPhysics& physics, const PrimitiveFit& fit, const physx::PxMaterial& material, bool exclusive = false);
+}
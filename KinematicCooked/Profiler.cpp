@@ -0,0 +1,251 @@
+#include "Profiler.h"
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	std::atomic<std::uint64_t> g_NextProfilerId { 1 };
+
+	// The current thread's buffer, tagged with the profiler it belongs to
+	thread_local std::uint64_t t_BufferOwner = 0;
+	thread_local void* t_Buffer = nullptr;
+
+	void WriteString(std::ostream& stream, const char* text)
+	{
+		stream << '"';
+		for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				stream << '\\';
+			}
+
+			stream << *c;
+		}
+		stream << '"';
+	}
+}
+
+PX::Profiler::Profiler(size_t events_per_thread) :
+	m_Id(g_NextProfilerId.fetch_add(1)),
+	m_EventsPerThread(events_per_thread > 0 ? events_per_thread : 1),
+	m_Epoch(std::chrono::steady_clock::now())
+{
+}
+
+PX::Profiler::~Profiler()
+{
+	if (IsCapturing())
+	{
+		PxSetProfilerCallback(m_PreviousCallback);
+	}
+}
+
+void* PX::Profiler::zoneStart(const char* eventName, bool detached, uint64_t contextId)
+{
+	if (!IsCapturing())
+	{
+		return nullptr;
+	}
+
+	// Cross thread zones end somewhere else, so they go in as two halves matched up by context id
+	if (detached)
+	{
+		Record(eventName, "PhysX", contextId, 'b');
+		return nullptr;
+	}
+
+	return Record(eventName, "PhysX", contextId, 'X');
+}
+
+void PX::Profiler::zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId)
+{
+	if (detached)
+	{
+		if (IsCapturing())
+		{
+			Record(eventName, "PhysX", contextId, 'e');
+		}
+
+		return;
+	}
+
+	// Null when the zone started before the capture did
+	if (profilerData != nullptr)
+	{
+		Finish(profilerData);
+	}
+}
+
+void PX::Profiler::Capture(int frame_count, const std::string& path)
+{
+	if (IsCapturing() || frame_count < 1)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		for (auto& buffer : m_Buffers)
+		{
+			buffer->count.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	GetThreadBuffer()->name = "Main thread";
+
+	m_FramesLeft = frame_count;
+	m_Path = path;
+
+	// Take over from whatever was installed, PVD sets itself when it profiles
+	m_PreviousCallback = PxGetProfilerCallback();
+	PxSetProfilerCallback(this);
+	m_Capturing.store(true, std::memory_order_release);
+}
+
+void PX::Profiler::NextFrame()
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	Finish(Record("Frame", "App", 0, 'i'));
+
+	if (--m_FramesLeft > 0)
+	{
+		return;
+	}
+
+	m_Capturing.store(false, std::memory_order_release);
+	PxSetProfilerCallback(m_PreviousCallback);
+
+	if (WriteTrace(m_Path))
+	{
+		std::cout << "Trace written to " << m_Path << '\n';
+	}
+}
+
+bool PX::Profiler::WriteTrace(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Error: could not open " << path << " for the trace\n";
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_BufferMutex);
+
+	file << "{\"traceEvents\":[\n";
+
+	bool first = true;
+	for (size_t tid = 0; tid < m_Buffers.size(); ++tid)
+	{
+		const ThreadBuffer& buffer = *m_Buffers[tid];
+
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+		WriteString(file, buffer.name.c_str());
+		file << "}}";
+		first = false;
+
+		// Once the ring has wrapped only the newest events are left
+		std::uint64_t count = buffer.count.load(std::memory_order_acquire);
+		std::uint64_t begin = count > m_EventsPerThread ? count - m_EventsPerThread : 0;
+
+		for (std::uint64_t i = begin; i < count; ++i)
+		{
+			const TraceEvent& event = buffer.events[i % m_EventsPerThread];
+			std::int64_t duration = event.durationNs.load(std::memory_order_relaxed);
+
+			// Zones still open when the capture ended
+			if (event.phase == 'X' && duration < 0)
+			{
+				continue;
+			}
+
+			file << ",\n{\"name\":";
+			WriteString(file, event.name);
+			file << ",\"cat\":\"" << event.category << "\",\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << tid
+				<< ",\"ts\":" << static_cast<double>(event.startNs) / 1000.0;
+
+			if (event.phase == 'X')
+			{
+				file << ",\"dur\":" << static_cast<double>(duration) / 1000.0;
+			}
+			else if (event.phase == 'i')
+			{
+				file << ",\"s\":\"g\"";
+			}
+			else
+			{
+				file << ",\"id\":" << event.contextId;
+			}
+
+			file << '}';
+		}
+	}
+
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
+
+PX::Profiler::ThreadBuffer* PX::Profiler::GetThreadBuffer()
+{
+	if (t_BufferOwner == m_Id)
+	{
+		return static_cast<ThreadBuffer*>(t_Buffer);
+	}
+
+	std::lock_guard<std::mutex> lock(m_BufferMutex);
+
+	auto buffer = std::make_unique<ThreadBuffer>();
+	buffer->name = "Thread " + std::to_string(m_Buffers.size());
+	buffer->events = std::make_unique<TraceEvent[]>(m_EventsPerThread);
+	m_Buffers.push_back(std::move(buffer));
+
+	t_BufferOwner = m_Id;
+	t_Buffer = m_Buffers.back().get();
+	return m_Buffers.back().get();
+}
+
+void* PX::Profiler::Record(const char* name, const char* category, std::uint64_t context_id, char phase)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	// Only this thread writes count, the release store hands the event over to WriteTrace
+	std::uint64_t index = buffer->count.load(std::memory_order_relaxed);
+	TraceEvent& event = buffer->events[index % m_EventsPerThread];
+	event.name = name;
+	event.category = category;
+	event.contextId = context_id;
+	event.phase = phase;
+	event.durationNs.store(-1, std::memory_order_relaxed);
+	event.startNs = Now();
+
+	buffer->count.store(index + 1, std::memory_order_release);
+
+	// The token is the index rather than the slot, offset so it's never null, so Finish can tell when the slot was reused
+	return reinterpret_cast<void*>(static_cast<std::uintptr_t>(index + 1));
+}
+
+void PX::Profiler::Finish(void* zone)
+{
+	// Non-detached zones end on the thread that started them, so this is the buffer Record wrote to
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::uint64_t index = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(zone)) - 1;
+
+	// The ring wrapped while the zone was open and a newer event has its slot, the zone is lost with it
+	if (buffer->count.load(std::memory_order_relaxed) - index >= m_EventsPerThread)
+	{
+		return;
+	}
+
+	TraceEvent& event = buffer->events[index % m_EventsPerThread];
+	event.durationNs.store(Now() - event.startNs, std::memory_order_relaxed);
+}
+
+std::int64_t PX::Profiler::Now() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Epoch).count();
+}
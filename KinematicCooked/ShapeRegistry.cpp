@@ -0,0 +1,228 @@
+#include "ShapeRegistry.h"
+
+namespace
+{
+	template <typename T>
+	void Append(std::string& key, const T& value)
+	{
+		key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	// Empty for the geometry types nothing here shares
+	std::string MakeGeometryKey(const physx::PxGeometry& geometry)
+	{
+		std::string key;
+		Append(key, geometry.getType());
+
+		switch (geometry.getType())
+		{
+		case physx::PxGeometryType::eSPHERE:
+			Append(key, static_cast<const physx::PxSphereGeometry&>(geometry).radius);
+			break;
+		case physx::PxGeometryType::ePLANE:
+			break;
+		case physx::PxGeometryType::eCAPSULE:
+		{
+			const physx::PxCapsuleGeometry& capsule = static_cast<const physx::PxCapsuleGeometry&>(geometry);
+			Append(key, capsule.radius);
+			Append(key, capsule.halfHeight);
+			break;
+		}
+		case physx::PxGeometryType::eBOX:
+			Append(key, static_cast<const physx::PxBoxGeometry&>(geometry).halfExtents);
+			break;
+		case physx::PxGeometryType::eCONVEXMESH:
+		{
+			const physx::PxConvexMeshGeometry& convex = static_cast<const physx::PxConvexMeshGeometry&>(geometry);
+			Append(key, convex.convexMesh);
+			Append(key, convex.scale.scale);
+			Append(key, convex.scale.rotation);
+			Append(key, static_cast<physx::PxU8>(convex.meshFlags));
+			break;
+		}
+		case physx::PxGeometryType::eTRIANGLEMESH:
+		{
+			const physx::PxTriangleMeshGeometry& mesh = static_cast<const physx::PxTriangleMeshGeometry&>(geometry);
+			Append(key, mesh.triangleMesh);
+			Append(key, mesh.scale.scale);
+			Append(key, mesh.scale.rotation);
+			Append(key, static_cast<physx::PxU8>(mesh.meshFlags));
+			break;
+		}
+		case physx::PxGeometryType::eHEIGHTFIELD:
+		{
+			const physx::PxHeightFieldGeometry& height_field = static_cast<const physx::PxHeightFieldGeometry&>(geometry);
+			Append(key, height_field.heightField);
+			Append(key, height_field.heightScale);
+			Append(key, height_field.rowScale);
+			Append(key, height_field.columnScale);
+			Append(key, static_cast<physx::PxU8>(height_field.heightFieldFlags));
+			break;
+		}
+		default:
+			return std::string();
+		}
+
+		return key;
+	}
+}
+
+physx::PxMaterial* PX::ShapeRegistry::AcquireMaterial(physx::PxReal static_friction, physx::PxReal dynamic_friction, physx::PxReal restitution)
+{
+	std::string key;
+	Append(key, static_friction);
+	Append(key, dynamic_friction);
+	Append(key, restitution);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	Entry<physx::PxMaterial>& entry = m_Materials[key];
+	if (entry.object == nullptr)
+	{
+		entry.object = m_Physics->createMaterial(static_friction, dynamic_friction, restitution);
+		m_MaterialKeys[entry.object] = key;
+		m_Stats.materialMisses++;
+	}
+	else
+	{
+		m_Stats.materialHits++;
+	}
+
+	entry.references++;
+	m_Stats.materialReferences++;
+	return entry.object;
+}
+
+void PX::ShapeRegistry::ReleaseMaterial(physx::PxMaterial* material)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto key = m_MaterialKeys.find(material);
+	if (key == m_MaterialKeys.end())
+	{
+		return;
+	}
+
+	// Shapes made with it hold PhysX references of their own, the material stays until they go too
+	auto entry = m_Materials.find(key->second);
+	m_Stats.materialReferences--;
+	if (--entry->second.references == 0)
+	{
+		entry->second.object->release();
+		m_Materials.erase(entry);
+		m_MaterialKeys.erase(key);
+	}
+}
+
+physx::PxShape* PX::ShapeRegistry::AcquireShape(const physx::PxGeometry& geometry, const physx::PxMaterial& material, const physx::PxTransform& local_pose, physx::PxShapeFlags flags)
+{
+	std::string key = MakeGeometryKey(geometry);
+	bool shared = !key.empty();
+
+	Append(key, &material);
+	Append(key, local_pose.p);
+	Append(key, local_pose.q);
+	Append(key, static_cast<physx::PxU8>(flags));
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (shared)
+	{
+		auto entry = m_Shapes.find(key);
+		if (entry != m_Shapes.end())
+		{
+			entry->second.references++;
+			m_Stats.shapeReferences++;
+			m_Stats.shapeHits++;
+			return entry->second.object;
+		}
+	}
+
+	physx::PxShape* shape = m_Physics->createShape(geometry, material, false, flags);
+	if (shape == nullptr)
+	{
+		return nullptr;
+	}
+
+	shape->setLocalPose(local_pose);
+
+	// A geometry we can't key gets a shape of its own, keyed by its address so the release still finds it
+	if (!shared)
+	{
+		key.clear();
+		Append(key, shape);
+	}
+
+	Entry<physx::PxShape>& entry = m_Shapes[key];
+	entry.object = shape;
+	entry.references = 1;
+	m_ShapeKeys[shape] = key;
+
+	m_Stats.shapeReferences++;
+	m_Stats.shapeMisses++;
+	return shape;
+}
+
+void PX::ShapeRegistry::ReleaseShape(physx::PxShape* shape)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto key = m_ShapeKeys.find(shape);
+	if (key == m_ShapeKeys.end())
+	{
+		return;
+	}
+
+	// Actors it's attached to keep it alive, this only gives back the registry's reference
+	auto entry = m_Shapes.find(key->second);
+	m_Stats.shapeReferences--;
+	if (--entry->second.references == 0)
+	{
+		entry->second.object->release();
+		m_Shapes.erase(entry);
+		m_ShapeKeys.erase(key);
+	}
+}
+
+void PX::ShapeRegistry::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// Shapes first, they hold references to the materials
+	for (auto& entry : m_Shapes)
+	{
+		entry.second.object->release();
+	}
+
+	for (auto& entry : m_Materials)
+	{
+		entry.second.object->release();
+	}
+
+	m_Shapes.clear();
+	m_ShapeKeys.clear();
+	m_Materials.clear();
+	m_MaterialKeys.clear();
+	m_Stats.shapeReferences = 0;
+	m_Stats.materialReferences = 0;
+}
+
+PX::ShapeRegistryStats PX::ShapeRegistry::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	ShapeRegistryStats stats = m_Stats;
+	stats.liveMaterials = m_Materials.size();
+	stats.liveShapes = m_Shapes.size();
+	return stats;
+}
+
+void PX::ShapeRegistry::PrintStats(std::ostream& stream) const
+{
+	ShapeRegistryStats stats = GetStats();
+
+	stream << "Shape registry: " << stats.liveMaterials << " materials for " << stats.materialReferences << " references ("
+		<< stats.materialHits << " hits, " << stats.materialMisses << " misses), "
+		<< stats.liveShapes << " shapes for " << stats.shapeReferences << " references ("
+		<< stats.shapeHits << " hits, " << stats.shapeMisses << " misses)\n";
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "SpscQueue.h"
+
+namespace PX
+{
+	// Bump allocator for one frame of events, everything in it goes at once on Reset and the blocks are kept
+	class EventArena
+	{
+	public:
+		explicit EventArena(size_t block_size = 64 * 1024);
+		EventArena(const EventArena&) = delete;
+		EventArena& operator=(const EventArena&) = delete;
+
+		void* Allocate(size_t bytes, size_t alignment);
+		void Reset();
+
+		inline size_t GetUsedBytes() const { return m_UsedBytes; }
+		size_t GetCapacityBytes() const;
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<unsigned char[]> memory;
+			size_t size = 0;
+			size_t used = 0;
+		};
+
+		size_t m_BlockSize = 0;
+		std::vector<Block> m_Blocks;
+		size_t m_Current = 0;
+		size_t m_UsedBytes = 0;
+	};
+
+	// Growable array in an arena. Growing doubles into a new allocation and leaves the old one to the next Reset,
+	// which runs no destructors, so elements have to be trivially destructible
+	template <typename T>
+	class ArenaArray
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "ArenaArray elements are never destroyed");
+
+	public:
+		void PushBack(EventArena& arena, const T& value)
+		{
+			if (m_Count == m_Capacity)
+			{
+				size_t capacity = m_Capacity > 0 ? m_Capacity * 2 : 64;
+				T* data = static_cast<T*>(arena.Allocate(capacity * sizeof(T), alignof(T)));
+				std::uninitialized_copy(m_Data, m_Data + m_Count, data);
+
+				m_Data = data;
+				m_Capacity = capacity;
+			}
+
+			new (m_Data + m_Count) T(value);
+			m_Count++;
+		}
+
+		// Only before the arena is reset, the memory goes with it
+		inline void Clear() { m_Data = nullptr; m_Count = 0; m_Capacity = 0; }
+
+		inline const T* Data() const { return m_Data; }
+		inline size_t Size() const { return m_Count; }
+		inline const T& operator[](size_t index) const { return m_Data[index]; }
+
+	private:
+		T* m_Data = nullptr;
+		size_t m_Count = 0;
+		size_t m_Capacity = 0;
+	};
+
+	// One entry per reported pair. Position and normal are the first contact point's, impulse the sum over the
+	// pair's points, events the PxPairFlag notify bits that fired
+	struct ContactEvents
+	{
+		ArenaArray<physx::PxActor*> actor0;
+		ArenaArray<physx::PxActor*> actor1;
+		ArenaArray<physx::PxVec3> position;
+		ArenaArray<physx::PxVec3> normal;
+		ArenaArray<physx::PxReal> impulse;
+		ArenaArray<physx::PxU16> events;
+
+		inline size_t Size() const { return actor0.Size(); }
+	};
+
+	struct TriggerEvents
+	{
+		ArenaArray<physx::PxActor*> trigger;
+		ArenaArray<physx::PxActor*> other;
+		ArenaArray<physx::PxU16> status;
+
+		inline size_t Size() const { return trigger.Size(); }
+	};
+
+	// The joint's external reference and type, the constraint itself is gone by the time anyone reads this
+	struct ConstraintBreakEvents
+	{
+		ArenaArray<void*> externalReference;
+		ArenaArray<physx::PxU32> type;
+
+		inline size_t Size() const { return type.Size(); }
+	};
+
+	struct AdvanceEvents
+	{
+		ArenaArray<const physx::PxRigidBody*> body;
+		ArenaArray<physx::PxTransform> pose;
+
+		inline size_t Size() const { return body.Size(); }
+	};
+
+	// Every event of one step, filled by the callbacks and handed over whole. Actor pointers are only good
+	// for as long as the consumer knows the actors live
+	struct SimulationEventFrame
+	{
+		explicit SimulationEventFrame(size_t arena_block_size) : arena(arena_block_size)
+		{
+		}
+
+		// The step these events came from, a frame never holds more than one. Steps without events aren't
+		// published, and a step that finds no free frame to move on to loses its events
+		std::uint64_t step = 0;
+
+		EventArena arena;
+		ContactEvents contacts;
+		TriggerEvents triggers;
+		ArenaArray<physx::PxActor*> woken;
+		ArenaArray<physx::PxActor*> slept;
+		ConstraintBreakEvents breaks;
+		AdvanceEvents advances;
+
+		bool IsEmpty() const;
+		void Clear();
+	};
+
+	struct SimulationEventDesc
+	{
+		// Contact reports need notify flags from the filter shader and cost for every touching pair, so they're opt in
+		bool reportContacts = false;
+
+		// Also report pairs that stay in touch, every step they do. Throttling keeps this from flooding
+		bool reportPersists = false;
+
+		// Pairs pushing with less total impulse than this are dropped, zero keeps them all. Found and lost go through
+		physx::PxReal minImpulse = 0.0f;
+
+		// A pair that stays in touch reports again at most once per this many steps, zero reports it every step
+		int pairThrottleSteps = 0;
+
+		// Contacts kept per step before persisting pairs are dropped, zero leaves it unbounded. Found and lost go through
+		size_t maxContactsPerStep = 0;
+
+		// Frames the producer and consumer pass between them. With none free the producer drops its frame and
+		// starts over, so nothing grows when no one consumes
+		size_t frames = 4;
+		size_t arenaBlockSize = 64 * 1024;
+	};
+
+	struct SimulationEventStats
+	{
+		std::uint64_t steps = 0;
+
+		std::uint64_t contacts = 0;
+		std::uint64_t contactsBelowImpulse = 0;
+		std::uint64_t contactsThrottled = 0;
+		std::uint64_t contactsCapped = 0;
+
+		std::uint64_t triggers = 0;
+		std::uint64_t wakes = 0;
+		std::uint64_t sleeps = 0;
+		std::uint64_t breaks = 0;
+		std::uint64_t advances = 0;
+
+		// Frames handed to the consumer, and publishes that found no free frame to move on to
+		std::uint64_t published = 0;
+		std::uint64_t stalls = 0;
+
+		// Time spent in the callbacks during the last step, and over every step. Summed over threads, so with
+		// parallel callbacks it can come to more than the step's wall time
+		double stepCallbackUs = 0.0;
+		double totalCallbackUs = 0.0;
+	};
+
+	// The scene's PxSimulationEventCallback. The callbacks copy what they're given into the current frame while
+	// fetchResults runs, Physics publishes the frame after each step and one consumer thread takes frames with
+	// Acquire and gives them back with Release. Both directions go through lock-free single producer, single
+	// consumer queues, so the consumer can be any one thread. onContact may also run on several of the job
+	// system's workers at once, see Physics::SetParallelCallbacks
+	class SimulationEvents : public physx::PxSimulationEventCallback
+	{
+	public:
+		SimulationEvents();
+		SimulationEvents(const SimulationEvents&) = delete;
+		SimulationEvents& operator=(const SimulationEvents&) = delete;
+		virtual ~SimulationEvents() = default;
+
+		// Must be set before the scene is created, it decides the filter shader
+		void SetDesc(const SimulationEventDesc& desc);
+		inline const SimulationEventDesc& GetDesc() const { return m_Desc; }
+
+		// The filter shader for a scene that reports contacts, PxDefaultSimulationFilterShader with notify flags added.
+		// Its constant block is a FilterShaderData
+		struct FilterShaderData
+		{
+			bool reportPersists = false;
+		};
+
+		static physx::PxFilterFlags FilterShader(physx::PxFilterObjectAttributes attributes0, physx::PxFilterData filter_data0,
+			physx::PxFilterObjectAttributes attributes1, physx::PxFilterData filter_data1,
+			physx::PxPairFlags& pair_flags, const void* constant_block, physx::PxU32 constant_block_size);
+
+		virtual void onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count) override;
+		// Only for actors with PxActorFlag::eSEND_SLEEP_NOTIFIES set
+		virtual void onWake(physx::PxActor** actors, physx::PxU32 count) override;
+		virtual void onSleep(physx::PxActor** actors, physx::PxU32 count) override;
+		// Extracts the pair's points unlocked, then takes a lock to filter the pair and append it
+		virtual void onContact(const physx::PxContactPairHeader& pair_header, const physx::PxContactPair* pairs, physx::PxU32 count) override;
+		virtual void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count) override;
+
+		// Runs on the simulation's threads while it steps, so unlike the rest it takes a lock
+		virtual void onAdvance(const physx::PxRigidBody* const* bodies, const physx::PxTransform* poses, const physx::PxU32 count) override;
+
+		// Producer, Physics calls it once the step's callbacks are done
+		void Publish();
+
+		// Consumer, the oldest published frame or null. Give every frame back with Release once read
+		const SimulationEventFrame* Acquire();
+		void Release(const SimulationEventFrame* frame);
+
+		// Producer side, read it from the thread that steps the scene
+		inline const SimulationEventStats& GetStats() const { return m_Stats; }
+		void PrintStats(std::ostream& stream) const;
+
+	private:
+		SimulationEventDesc m_Desc;
+		SimulationEventStats m_Stats;
+
+		std::vector<std::unique_ptr<SimulationEventFrame>> m_Frames;
+		std::unique_ptr<SpscQueue<SimulationEventFrame*>> m_Ready;
+		std::unique_ptr<SpscQueue<SimulationEventFrame*>> m_Free;
+		SimulationEventFrame* m_Current = nullptr;
+		std::mutex m_AdvanceMutex;
+		std::mutex m_ContactMutex;
+
+		// Step each touching pair last reported, dropped when the pair loses touch
+		struct PairKey
+		{
+			const physx::PxActor* actor0 = nullptr;
+			const physx::PxActor* actor1 = nullptr;
+			bool operator==(const PairKey& other) const { return actor0 == other.actor0 && actor1 == other.actor1; }
+		};
+
+		struct PairKeyHash
+		{
+			size_t operator()(const PairKey& key) const;
+		};
+
+		std::unordered_map<PairKey, std::uint64_t, PairKeyHash> m_PairSteps;
+		size_t m_StepContacts = 0;
+		std::atomic<std::chrono::steady_clock::rep> m_StepCallbackTicks { 0 };
+
+		void CreateFrames();
+		bool KeepContact(const physx::PxContactPairHeader& pair_header, const physx::PxContactPair& pair, physx::PxReal impulse);
+	};
+}
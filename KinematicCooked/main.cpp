@@ -1,5 +1,7 @@
 #include "Application.h"
+#include <iostream>
 #include <memory>
+#include <string>
 
 // SDL is needed to handle our main function
 #include <SDL.h>
@@ -15,5 +17,24 @@ int main(int argc, char** argv)
 #endif
 
 	auto application = std::make_unique<Applicataion>();
+
+	// PVD is off unless asked for, --pvd socket|file [--pvd-flags debug,profile,memory]
+	PX::PvdDesc pvd_desc;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string arg = argv[i];
+		bool valid = false;
+		if (arg == "--pvd")
+			valid = PX::ParsePvdTransport(argv[i + 1], pvd_desc.transport);
+		else if (arg == "--pvd-flags")
+			valid = PX::ParsePvdFlags(argv[i + 1], pvd_desc.flags);
+
+		if (!valid)
+		{
+			std::cout << "Ignoring " << arg << ' ' << argv[i + 1] << '\n';
+		}
+	}
+
+	application->SetPvdDesc(pvd_desc);
 	return application->Execute();
 }
\ No newline at end of file
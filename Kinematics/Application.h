@@ -24,6 +24,9 @@ public:
 
 	int Execute();
 
+	// PVD connection for the physics, must be set before Execute
+	inline void SetPvdDesc(const PX::PvdDesc& desc) { m_PvdDesc = desc; }
+
 private:
 	void DirectXSetup();
 
@@ -59,4 +62,5 @@ private:
 	void SetupDirectionalLight();
 
 	std::unique_ptr<PX::Physics> m_Physics = nullptr;
+	PX::PvdDesc m_PvdDesc;
 };
\ No newline at end of file
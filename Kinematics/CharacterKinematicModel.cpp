@@ -63,7 +63,7 @@ void DX::CharacterKinematicModel::CreateIndexBuffer()
 
 void DX::CharacterKinematicModel::CreatePhysicsActor()
 {
-	physx::PxMaterial* material = m_Physics->GetPhysics()->createMaterial(0.5f, 0.5f, 0.1f);
+	physx::PxMaterial* material = m_Physics->GetShapeRegistry().AcquireMaterial(0.5f, 0.5f, 0.1f);
 
 	physx::PxCapsuleControllerDesc desc;
 	desc.height = 2.0f;
@@ -63,8 +63,15 @@ void DX::KinematicModel::CreateIndexBuffer()
 
 void DX::KinematicModel::CreatePhysicsActor()
 {
-	physx::PxMaterial* material = m_Physics->GetPhysics()->createMaterial(0.5f, 0.5f, 0.1f);
-	physx::PxShape* shape = m_Physics->GetPhysics()->createShape(physx::PxBoxGeometry(m_Dimensions.x, m_Dimensions.y, m_Dimensions.z), *material);
+	// Every box of the same size shares one material and one shape through the registry
+	PX::ShapeRegistry& registry = m_Physics->GetShapeRegistry();
+	physx::PxMaterial* material = registry.AcquireMaterial(0.5f, 0.5f, 0.1f);
+
+	// Collide as the cheapest primitive that fits the render mesh, or the tighter box when none fits closely enough
+	PX::PrimitiveFitResult fit = PX::FitPrimitives(m_MeshData);
+	m_Bounds = fit.bounds;
+	const PX::PrimitiveFit& primitive = fit.GetPrimitive();
+	physx::PxShape* shape = registry.AcquireShape(primitive.geometry.any(), *material, primitive.localPose);
 
 	// Set position
 	physx::PxVec3 position = physx::PxVec3(physx::PxReal(m_Position.x), physx::PxReal(m_Position.y), physx::PxReal(m_Position.z));
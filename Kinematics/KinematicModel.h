@@ -4,6 +4,7 @@
 #include <DirectXMath.h>
 #include "Vertex.h"
 #include "Physics.h"
+#include "PrimitiveFit.h"
 
 namespace DX
 {
@@ -32,6 +33,9 @@ namespace DX
 		// Get actor
 		inline physx::PxRigidBody* GetBody() { return m_Body; }
 
+		// Local bounds of the render mesh, move them by the body's pose to cull
+		inline const PX::MeshBounds& GetBounds() const { return m_Bounds; }
+
 	private:
 		DX::Renderer* m_DxRenderer = nullptr;
 
@@ -48,6 +52,7 @@ namespace DX
 
 		// Mesh data
 		MeshData m_MeshData;
+		PX::MeshBounds m_Bounds;
 
 		// Physics
 		PX::Physics* m_Physics = nullptr;
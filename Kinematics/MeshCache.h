@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "PxPhysicsAPI.h"
+#include "PackFile.h"
+
+namespace PX
+{
+	struct MeshCacheStats
+	{
+		std::uint64_t hits = 0;
+		std::uint64_t packHits = 0;
+		std::uint64_t misses = 0;
+
+		// Entries that were there but didn't validate, these are cooked again and count as misses too
+		std::uint64_t invalid = 0;
+
+		// Time spent cooking on a miss and reading the blob on a hit
+		double cookMs = 0.0;
+		double loadMs = 0.0;
+
+		std::uint64_t bytesRead = 0;
+		std::uint64_t bytesWritten = 0;
+	};
+
+	// Cooked triangle meshes on disk, safe to call from several threads at once, one file per mesh named after a hash of everything that goes into the cook,
+	// and Meshes.pxpack next to them once WritePack has gathered them into one mapped file
+	class MeshCache
+	{
+	public:
+		explicit MeshCache(const std::string& directory = "MeshCache");
+		MeshCache(const MeshCache&) = delete;
+		MeshCache& operator=(const MeshCache&) = delete;
+
+		void SetDirectory(const std::string& directory);
+		inline const std::string& GetDirectory() const { return m_Directory; }
+
+		// Disabled, every call cooks and nothing is written
+		inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+		inline bool IsEnabled() const { return m_Enabled; }
+
+		// Same as PxCookTriangleMesh followed by createTriangleMesh, but a mesh cooked before is read back instead
+		physx::PxTriangleMesh* CreateTriangleMesh(physx::PxPhysics& physics, const physx::PxCookingParams& params, const physx::PxTriangleMeshDesc& desc);
+
+		// Hash of the vertices, indices, cooking params, SDF settings and PhysX version
+		static std::uint64_t ComputeKey(const physx::PxCookingParams& params, const physx::PxTriangleMeshDesc& desc);
+
+		// Packs every valid loose entry, the next cache to start up maps the one file instead of opening each
+		bool WritePack();
+
+		// Meshes created from the pack are held until this, call it before PxPhysics is released
+		void ClosePack();
+
+		MeshCacheStats GetStats() const;
+		void ResetStats();
+		void PrintStats(std::ostream& stream) const;
+
+	private:
+		std::string m_Directory;
+		bool m_Enabled = true;
+		MeshCacheStats m_Stats;
+		mutable std::mutex m_Mutex;
+		std::atomic<unsigned int> m_TempCounter { 0 };
+		void CountInvalid();
+
+		// Opened on the first lookup so a cache that's never asked costs nothing
+		PackFile m_Pack;
+		bool m_PackOpened = false;
+
+		std::string GetPath(std::uint64_t key) const;
+		std::string GetPackPath() const;
+
+		// Maps the entry, false if it's missing, truncated, from another PhysX or doesn't match its checksum
+		bool Read(std::uint64_t key, MappedFile& file, const unsigned char*& blob, size_t& size);
+		bool Write(std::uint64_t key, const void* data, size_t size);
+	};
+}
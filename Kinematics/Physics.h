@@ -1,7 +1,19 @@
 #pragma once
 
 #include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "PxPhysicsAPI.h"
+#include "JobSystem.h"
+#include "MeshCache.h"
+#include "PoolAllocator.h"
+#include "Profiler.h"
+#include "ShapeRegistry.h"
+#include "SimulationEvents.h"
+#include "StatsRecorder.h"
 
 namespace PX
 {
@@ -14,17 +26,186 @@ namespace PX
 		}
 	};
 
+	// How much of a pipelined step ran while the main thread was busy with the frame
+	struct PipelineStats
+	{
+		double overlapMs = 0.0;
+		double waitMs = 0.0;
+		double overlapRatio = 0.0;
+		bool fetched = false;
+		bool completedEarly = false;
+	};
+
+	// Where the last step's fetch spent its time. Start includes waiting for the workers to finish the step, and
+	// without parallel callbacks all of fetchResults lands in it, the contact callbacks too
+	struct FetchStats
+	{
+		bool parallelCallbacks = false;
+
+		// Contact pair headers fetchResultsStart handed out, only counted with parallel callbacks
+		physx::PxU32 contactPairs = 0;
+
+		double startMs = 0.0;
+		double callbacksMs = 0.0;
+		double finishMs = 0.0;
+		double totalMs = 0.0;
+	};
+
+	struct ScratchDesc
+	{
+		// Block to start with, zero lets the first steps run from the heap so they can be measured
+		size_t initialSize = 0;
+
+		// The block never grows past this
+		size_t maxSize = 16 * 1024 * 1024;
+
+		// Grow the block to the high water mark of the last window steps
+		bool autoSize = true;
+		size_t window = 120;
+	};
+
+	// Scratch block size and the heap traffic of a step
+	struct ScratchStats
+	{
+		size_t sizeBytes = 0;
+		size_t highWaterBytes = 0;
+		int resizes = 0;
+
+		// Average allocations per step while there was no block, and the allocations of the latest step
+		double baselineAllocations = 0.0;
+		std::uint64_t stepAllocations = 0;
+		std::uint64_t stepBytes = 0;
+
+		// Bytes the latest step put on the heap past the quietest step with this block, zero unless it spilled
+		std::uint64_t spillBytes = 0;
+	};
+
+	enum class PvdTransport
+	{
+		None,
+		Socket,
+		File
+	};
+
+	// PhysX Visual Debugger connection, off unless asked for
+	struct PvdDesc
+	{
+		PvdTransport transport = PvdTransport::None;
+
+		// Socket, a PVD that isn't running costs up to timeoutMs at Setup
+		std::string host = "127.0.0.1";
+		int port = 5425;
+		unsigned int timeoutMs = 10;
+
+		// File, opened with PVD afterwards
+		std::string filePath = "PhysX.pxd2";
+
+		// eDEBUG sends the scene, ePROFILE the zones and eMEMORY every allocation, each one adds to every step
+		physx::PxPvdInstrumentationFlags flags = physx::PxPvdInstrumentationFlag::eDEBUG;
+	};
+
+	// Whatever owns a body, put in the actor's userData so the active actor sync can find it
+	class ActorOwner
+	{
+	public:
+		virtual ~ActorOwner() = default;
+		virtual void SyncTransform(const physx::PxTransform& pose) = 0;
+	};
+
+	// How much of the scene the last sync had to touch
+	struct ActiveActorStats
+	{
+		size_t active = 0;
+		size_t total = 0;
+		double ratio = 0.0;
+		double syncMs = 0.0;
+	};
+
+	// "none", "socket" or "file"
+	bool ParsePvdTransport(const std::string& name, PvdTransport& transport);
+	const char* GetPvdTransportName(PvdTransport transport);
+
+	// Comma separated "debug", "profile" and "memory", or "all"
+	bool ParsePvdFlags(const std::string& text, physx::PxPvdInstrumentationFlags& flags);
+
 	class Physics
 	{
 	public:
 		Physics() = default;
 		virtual ~Physics();
 
+		// Worker threads for the scene, must be set before Setup
+		inline void SetJobSystemDesc(const JobSystemDesc& desc) { m_JobSystemDesc = desc; }
+
+		// PVD connection, must be set before Setup
+		inline void SetPvdDesc(const PvdDesc& desc) { m_PvdDesc = desc; }
+		inline const PvdDesc& GetPvdDesc() const { return m_PvdDesc; }
+		inline bool IsPvdConnected() const { return m_Pvd != nullptr && m_Pvd->isConnected(); }
+
+		// Time Setup spent creating the PVD client and connecting it
+		inline double GetPvdSetupMs() const { return m_PvdSetupMs; }
+
 		void Setup();
 		void Simulate(double delta_time);
 
+		// Step the scene in fixed increments of step_size, running at most max_steps_per_frame steps per call
+		void SetFixedTimestep(double step_size, int max_steps_per_frame = 5);
+		void DisableFixedTimestep();
+		inline bool IsFixedTimestep() const { return m_FixedTimestep; }
+
+		// How far between the previous and current step the leftover time puts us, in the range [0, 1)
+		inline double GetInterpolationAlpha() const { return m_InterpolationAlpha; }
+
+		// Pose blended between the previous and current step by the interpolation alpha
+		physx::PxTransform GetInterpolatedPose(physx::PxRigidActor* actor) const;
+
+		// Leave the last step of Simulate running so it overlaps the frame, FetchResults collects it
+		void SetPipelined(bool pipelined);
+		inline bool IsPipelined() const { return m_Pipelined; }
+		inline bool IsSimulating() const { return m_Simulating; }
+		void FetchResults();
+		inline const PipelineStats& GetPipelineStats() const { return m_PipelineStats; }
+
+		// Fetch with fetchResultsStart, processCallbacks and fetchResultsFinish, so the contact callbacks are spread
+		// over the job system's workers instead of running one after another inside fetchResults
+		inline void SetParallelCallbacks(bool parallel) { m_ParallelCallbacks = parallel; }
+		inline bool IsParallelCallbacks() const { return m_ParallelCallbacks; }
+		inline const FetchStats& GetFetchStats() const { return m_FetchStats; }
+
+		// Bodies that moved in the steps of the last Simulate call that stepped, gathered with eENABLE_ACTIVE_ACTORS.
+		// Sleeping bodies and statics never show up, so this costs what's awake rather than what's in the scene
+		inline const std::vector<physx::PxRigidActor*>& GetActiveActors() const { return m_ActiveActors; }
+
+		// Hands the interpolated pose of every active body to the ActorOwner in its userData, bodies without one are skipped.
+		// Call it while the scene is idle and before releasing any of this frame's actors
+		void SyncActiveActors();
+
+		// Call before releasing an actor or taking it out of the scene. A frame that doesn't step keeps the last
+		// step's list, so without this it would sync and interpolate a body that's gone
+		void OnActorsRemoved(physx::PxRigidActor* const* actors, size_t count);
+		inline void OnActorRemoved(physx::PxRigidActor* actor) { OnActorsRemoved(&actor, 1); }
+		inline const ActiveActorStats& GetActiveActorStats() const { return m_ActiveActorStats; }
+
+		// Which simulation events are reported and how contacts are filtered, must be set before Setup
+		inline void SetSimulationEventDesc(const SimulationEventDesc& desc) { m_SimulationEvents.SetDesc(desc); }
+
+		// Contacts, triggers, wakes, sleeps, breaks and advances of each step, published as a frame after it
+		inline SimulationEvents& GetSimulationEvents() { return m_SimulationEvents; }
+
+		// Memory handed to simulate for PhysX's per step temporaries, resets the high water mark
+		void SetScratchDesc(const ScratchDesc& desc);
+		inline const ScratchStats& GetScratchStats() const { return m_ScratchStats; }
+
+		// PxSimulationStatistics and wall time of every step
+		inline StatsRecorder& GetStatsRecorder() { return m_StatsRecorder; }
+
 		inline physx::PxPhysics* GetPhysics() { return m_Physics; }
 		inline physx::PxScene* GetScene() { return m_Scene; }
+		inline JobSystem* GetJobSystem() { return m_JobSystem.get(); }
+		inline PoolAllocator& GetAllocator() { return m_AllocatorCallback; }
+		inline Profiler& GetProfiler() { return m_Profiler; }
+		inline MeshCache& GetMeshCache() { return m_MeshCache; }
+		inline ShapeRegistry& GetShapeRegistry() { return m_ShapeRegistry; }
 		inline physx::PxControllerManager* GetControllerManager() { return m_ControllerManager; }
 
 	private:
@@ -34,8 +215,16 @@ namespace PX
 		physx::PxPvdTransport* m_Transport = nullptr;
 		physx::PxFoundation* m_Foundation = nullptr;
 
+		PvdDesc m_PvdDesc;
+		double m_PvdSetupMs = 0.0;
+		void ConnectPvd();
+
 		UserErrorCallback m_DefaultErrorCallback;
-		physx::PxDefaultAllocator m_DefaultAllocatorCallback;
+		PoolAllocator m_AllocatorCallback;
+		Profiler m_Profiler;
+		MeshCache m_MeshCache;
+		ShapeRegistry m_ShapeRegistry;
+		SimulationEvents m_SimulationEvents;
 		void CreateFoundationAndPhysics();
 
 		// Scene
@@ -44,5 +233,63 @@ namespace PX
 
 		// Controller Kinematics
 		physx::PxControllerManager* m_ControllerManager = nullptr;
+
+		// Thread pool shared by the scene and application jobs
+		JobSystemDesc m_JobSystemDesc;
+		std::unique_ptr<JobSystem> m_JobSystem = nullptr;
+
+		// Fixed timestep
+		bool m_FixedTimestep = false;
+		double m_StepSize = 1.0 / 60.0;
+		int m_MaxStepsPerFrame = 5;
+		double m_Accumulator = 0.0;
+		double m_InterpolationAlpha = 1.0;
+
+		// Poses from before the last step of the frame, used for interpolation
+		std::unordered_map<const physx::PxRigidActor*, physx::PxTransform> m_PreviousPoses;
+		void StorePreviousPoses();
+
+		// Active actors of every step since the last Simulate call that stepped
+		std::vector<physx::PxRigidActor*> m_ActiveActors;
+		ActiveActorStats m_ActiveActorStats;
+		int m_FrameSteps = 0;
+		void GatherActiveActors();
+
+		// Pipelining
+		bool m_Pipelined = false;
+		bool m_Simulating = false;
+		std::chrono::steady_clock::time_point m_SimulateStartTime;
+		PipelineStats m_PipelineStats;
+		void Step(double step_size, bool last_step);
+
+		// Fetching, false when not blocking and the step isn't done
+		bool m_ParallelCallbacks = false;
+		FetchStats m_FetchStats;
+		bool Fetch(bool block);
+		void EndStep();
+
+		// Step statistics
+		StatsRecorder m_StatsRecorder;
+		physx::PxSimulationStatistics m_SimulationStatistics;
+		std::chrono::steady_clock::time_point m_StepStartTime;
+
+		// Scratch block, 16 byte aligned and a multiple of 16 KB as simulate requires
+		ScratchDesc m_ScratchDesc;
+		ScratchStats m_ScratchStats;
+		void* m_ScratchBlock = nullptr;
+		size_t m_ScratchSize = 0;
+		std::vector<size_t> m_ScratchHistory;
+		size_t m_ScratchHistoryIndex = 0;
+		std::uint64_t m_StepStartAllocations = 0;
+		std::uint64_t m_StepStartBytes = 0;
+		std::uint64_t m_BaselineSteps = 0;
+		std::uint64_t m_BaselineAllocations = 0;
+
+		// Quietest step since the block was last sized, whatever PhysX allocates with the block in place anyway
+		std::uint64_t m_QuietAllocations = UINT64_MAX;
+		std::uint64_t m_QuietBytes = UINT64_MAX;
+		void ResizeScratch();
+		void ReleaseScratch();
+		void EndStepAccounting();
 	};
 }
\ No newline at end of file
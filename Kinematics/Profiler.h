@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	// One recorded zone, names have to outlive the capture which holds for the literals PhysX and the application pass
+	struct TraceEvent
+	{
+		const char* name = nullptr;
+		const char* category = nullptr;
+		std::uint64_t contextId = 0;
+		std::int64_t startNs = 0;
+
+		// Filled in when the zone ends, negative while it is still open
+		std::atomic<std::int64_t> durationNs { -1 };
+
+		// 'X' for a zone, 'b' and 'e' for the two halves of a cross thread zone, 'i' for a frame marker
+		char phase = 'X';
+	};
+
+	// PhysX profiler callback that records zones into per thread ring buffers and writes them out as Chrome trace JSON.
+	// It's only installed while a capture runs, the rest of the time PhysX sees no callback and skips its zones.
+	// PhysX only emits zones from its checked and profile builds, a release build just shows the application zones.
+	class Profiler : public physx::PxProfilerCallback
+	{
+	public:
+		Profiler(size_t events_per_thread = 64 * 1024);
+		virtual ~Profiler();
+
+		// Called by PhysX
+		virtual void* zoneStart(const char* eventName, bool detached, uint64_t contextId) override;
+		virtual void zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId) override;
+
+		// Record the next frame_count frames then write them to path
+		void Capture(int frame_count, const std::string& path);
+		inline bool IsCapturing() const { return m_Capturing.load(std::memory_order_relaxed); }
+
+		// Mark the start of a frame, the frame that ends a capture writes the file so call it while no step is running
+		void NextFrame();
+
+		// Application zones, one relaxed load when not capturing
+		inline void* BeginZone(const char* name) { return IsCapturing() ? Record(name, "App", 0, 'X') : nullptr; }
+		inline void EndZone(void* zone) { if (zone != nullptr) Finish(zone); }
+
+		// Write the buffers as Chrome trace JSON, opens in chrome://tracing or ui.perfetto.dev
+		bool WriteTrace(const std::string& path) const;
+
+	private:
+		// Written only by its own thread, published through count so the writer never takes a lock
+		struct ThreadBuffer
+		{
+			std::string name;
+			std::unique_ptr<TraceEvent[]> events;
+			std::atomic<std::uint64_t> count { 0 };
+		};
+
+		const std::uint64_t m_Id;
+		const size_t m_EventsPerThread;
+		const std::chrono::steady_clock::time_point m_Epoch;
+
+		mutable std::mutex m_BufferMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+		ThreadBuffer* GetThreadBuffer();
+
+		std::atomic<bool> m_Capturing { false };
+		int m_FramesLeft = 0;
+		std::string m_Path;
+		physx::PxProfilerCallback* m_PreviousCallback = nullptr;
+
+		void* Record(const char* name, const char* category, std::uint64_t context_id, char phase);
+		void Finish(void* zone);
+		std::int64_t Now() const;
+	};
+
+	// Times the enclosing scope as an application zone
+	class ProfileZone
+	{
+	public:
+		ProfileZone(Profiler& profiler, const char* name) : m_Profiler(profiler), m_Zone(profiler.BeginZone(name)) {}
+		~ProfileZone() { m_Profiler.EndZone(m_Zone); }
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		Profiler& m_Profiler;
+		void* m_Zone = nullptr;
+	};
+}
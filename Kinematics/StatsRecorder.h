@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	// One step worth of PxSimulationStatistics and how long the step took
+	struct StepStats
+	{
+		std::uint64_t step = 0;
+		double wallMs = 0.0;
+
+		// Bodies
+		std::uint32_t activeDynamicBodies = 0;
+		std::uint32_t activeKinematicBodies = 0;
+		std::uint32_t staticBodies = 0;
+		std::uint32_t dynamicBodies = 0;
+		std::uint32_t kinematicBodies = 0;
+
+		// Constraints
+		std::uint32_t activeConstraints = 0;
+		std::uint32_t axisSolverConstraints = 0;
+		std::uint32_t peakConstraintMemory = 0;
+
+		// Broadphase
+		std::uint32_t broadPhaseAdds = 0;
+		std::uint32_t broadPhaseRemoves = 0;
+
+		// Narrowphase, pairsPerGeometry counts the discrete contact pairs each geometry type takes part in
+		std::uint32_t discreteContactPairs = 0;
+		std::uint32_t newPairs = 0;
+		std::uint32_t lostPairs = 0;
+		std::uint32_t newTouches = 0;
+		std::uint32_t lostTouches = 0;
+		std::array<std::uint32_t, physx::PxGeometryType::eGEOMETRY_COUNT> pairsPerGeometry = {};
+	};
+
+	enum class StatsFormat
+	{
+		Csv,
+		Json
+	};
+
+	// Keeps the most recent steps in a ring buffer and can stream every step to a file as it is recorded
+	class StatsRecorder
+	{
+	public:
+		StatsRecorder(size_t capacity = 4096);
+		virtual ~StatsRecorder();
+
+		void Record(const physx::PxSimulationStatistics& statistics, double wall_ms);
+
+		// Oldest first
+		std::vector<StepStats> GetHistory() const;
+		inline const StepStats& GetLatest() const { return m_Steps[(m_Next + m_Steps.size() - 1) % m_Steps.size()]; }
+		inline size_t GetCount() const { return m_Count; }
+
+		// Append every following step to path until StopStream, replaces any stream already open
+		bool StartStream(const std::string& path, StatsFormat format);
+		void StopStream();
+		inline bool IsStreaming() const { return m_Stream.is_open(); }
+
+		// Write what the ring buffer holds right now
+		bool Export(const std::string& path, StatsFormat format) const;
+
+	private:
+		std::vector<StepStats> m_Steps;
+		size_t m_Next = 0;
+		size_t m_Count = 0;
+		std::uint64_t m_StepCounter = 0;
+
+		std::ofstream m_Stream;
+		StatsFormat m_StreamFormat = StatsFormat::Csv;
+		bool m_StreamFirst = true;
+
+		static void WriteHeader(std::ostream& stream, StatsFormat format);
+		static void WriteStep(std::ostream& stream, StatsFormat format, const StepStats& stats, bool first);
+		static void WriteFooter(std::ostream& stream, StatsFormat format);
+	};
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PxPhysicsAPI.h"
+
+namespace PX
+{
+	// 64 bit FNV-1a, catches a damaged file, not anyone trying to forge one
+	std::uint64_t Checksum(const void* data, size_t size);
+
+	// Read only view of a whole file, the OS pages it in as it's touched
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return m_Data != nullptr; }
+		inline const unsigned char* GetData() const { return m_Data; }
+		inline size_t GetSize() const { return m_Size; }
+
+	private:
+		const unsigned char* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WIN32
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+#endif
+	};
+
+	// PxInputData over memory we don't own, PhysX reads straight out of the mapping
+	class MappedInputData : public physx::PxInputData
+	{
+	public:
+		MappedInputData(const void* data, size_t size);
+
+		virtual physx::PxU32 read(void* dest, physx::PxU32 count) override;
+		virtual physx::PxU32 getLength() const override;
+		virtual void seek(physx::PxU32 offset) override;
+		virtual physx::PxU32 tell() const override;
+
+	private:
+		const unsigned char* m_Data = nullptr;
+		physx::PxU32 m_Size = 0;
+		physx::PxU32 m_Position = 0;
+	};
+
+	enum class PackEntryType : std::uint32_t
+	{
+		TriangleMesh,
+		ConvexMesh,
+		HeightField
+	};
+
+	struct PackEntry;
+
+	// Many cooked assets in one mapped file, only the index is read on Open and each asset is created the first time it's asked for
+	class PackFile
+	{
+	public:
+		PackFile() = default;
+		~PackFile();
+
+		bool Open(const std::string& path);
+		void Close();
+		inline bool IsOpen() const { return m_File.IsOpen(); }
+
+		bool Contains(std::uint64_t key) const;
+		inline size_t GetEntryCount() const { return m_EntryCount; }
+
+		// Null when the key isn't in the pack, isn't that type or doesn't pass its checksum
+		physx::PxTriangleMesh* GetTriangleMesh(physx::PxPhysics& physics, std::uint64_t key);
+		physx::PxConvexMesh* GetConvexMesh(physx::PxPhysics& physics, std::uint64_t key);
+		physx::PxHeightField* GetHeightField(physx::PxPhysics& physics, std::uint64_t key);
+
+		// Assets created so far, the pack holds a reference to each until Close, which has to come before PxPhysics is released
+		inline size_t GetLoadedCount() const { return m_LoadedCount; }
+
+	private:
+		MappedFile m_File;
+		const PackEntry* m_Entries = nullptr;
+		size_t m_EntryCount = 0;
+		std::vector<physx::PxBase*> m_Loaded;
+		size_t m_LoadedCount = 0;
+
+		physx::PxBase* Load(physx::PxPhysics& physics, std::uint64_t key, PackEntryType type);
+	};
+
+	// Builds a pack, entries are kept in memory until Write
+	class PackWriter
+	{
+	public:
+		void Add(std::uint64_t key, PackEntryType type, const void* data, size_t size);
+		inline size_t GetEntryCount() const { return m_Entries.size(); }
+
+		bool Write(const std::string& path) const;
+
+	private:
+		struct Blob
+		{
+			std::uint64_t key = 0;
+			PackEntryType type = PackEntryType::TriangleMesh;
+			std::vector<unsigned char> data;
+		};
+
+		std::vector<Blob> m_Entries;
+	};
+}
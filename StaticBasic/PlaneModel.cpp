@@ -16,7 +16,7 @@ void DX::PlaneModel::Create()
 	CreateIndexBuffer();
 
 	physx::PxShapeFlags shapeFlags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE;
-	physx::PxMaterial* materialPtr = m_Physics->GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+	physx::PxMaterial* materialPtr = m_Physics->GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
 
 	physx::PxRigidStatic* rigidStatic = m_Physics->GetPhysics()->createRigidStatic(physx::PxTransformFromPlaneEquation(physx::PxPlane(physx::PxVec3(0.f, 1.f, 0.f), 1.f)));
 	{
@@ -0,0 +1,404 @@
+#include "SimulationEvents.h"
+#include <algorithm>
+
+namespace
+{
+	// Adds the time to the step's callback total when it goes out of scope
+	class CallbackTimer
+	{
+	public:
+		explicit CallbackTimer(std::atomic<std::chrono::steady_clock::rep>& total) : m_Total(total), m_Start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~CallbackTimer()
+		{
+			m_Total.fetch_add((std::chrono::steady_clock::now() - m_Start).count(), std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<std::chrono::steady_clock::rep>& m_Total;
+		std::chrono::steady_clock::time_point m_Start;
+	};
+
+	// Enough for the impulse of a box face, the sum of the rest of a pair's points is left out
+	constexpr physx::PxU32 MAX_PAIR_POINTS = 16;
+
+	// Pairs of one header extracted before the lock is taken for all of them
+	constexpr physx::PxU32 CONTACT_BATCH = 16;
+
+	struct ExtractedPair
+	{
+		const physx::PxContactPair* pair = nullptr;
+		physx::PxVec3 position = physx::PxVec3(0.0f);
+		physx::PxVec3 normal = physx::PxVec3(0.0f);
+		physx::PxReal impulse = 0.0f;
+		bool removed = false;
+	};
+}
+
+PX::EventArena::EventArena(size_t block_size) : m_BlockSize(block_size)
+{
+}
+
+void* PX::EventArena::Allocate(size_t bytes, size_t alignment)
+{
+	while (m_Current < m_Blocks.size())
+	{
+		Block& block = m_Blocks[m_Current];
+		size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+		if (offset + bytes <= block.size)
+		{
+			block.used = offset + bytes;
+			m_UsedBytes += bytes;
+			return block.memory.get() + offset;
+		}
+
+		m_Current++;
+	}
+
+	// Out of blocks, a request bigger than a block gets one of its own size
+	Block block;
+	block.size = std::max(m_BlockSize, bytes + alignment);
+	block.memory = std::make_unique<unsigned char[]>(block.size);
+	m_Blocks.push_back(std::move(block));
+	m_Current = m_Blocks.size() - 1;
+	return Allocate(bytes, alignment);
+}
+
+void PX::EventArena::Reset()
+{
+	for (Block& block : m_Blocks)
+	{
+		block.used = 0;
+	}
+
+	m_Current = 0;
+	m_UsedBytes = 0;
+}
+
+size_t PX::EventArena::GetCapacityBytes() const
+{
+	size_t bytes = 0;
+	for (const Block& block : m_Blocks)
+	{
+		bytes += block.size;
+	}
+
+	return bytes;
+}
+
+bool PX::SimulationEventFrame::IsEmpty() const
+{
+	return contacts.Size() == 0 && triggers.Size() == 0 && woken.Size() == 0 && slept.Size() == 0 && breaks.Size() == 0 && advances.Size() == 0;
+}
+
+void PX::SimulationEventFrame::Clear()
+{
+	contacts = ContactEvents();
+	triggers = TriggerEvents();
+	woken.Clear();
+	slept.Clear();
+	breaks = ConstraintBreakEvents();
+	advances = AdvanceEvents();
+	arena.Reset();
+}
+
+PX::SimulationEvents::SimulationEvents()
+{
+	CreateFrames();
+}
+
+void PX::SimulationEvents::SetDesc(const SimulationEventDesc& desc)
+{
+	m_Desc = desc;
+	m_Desc.frames = std::max<size_t>(2, m_Desc.frames);
+	CreateFrames();
+}
+
+void PX::SimulationEvents::CreateFrames()
+{
+	m_Frames.clear();
+	m_Ready = std::make_unique<SpscQueue<SimulationEventFrame*>>(m_Desc.frames);
+	m_Free = std::make_unique<SpscQueue<SimulationEventFrame*>>(m_Desc.frames);
+
+	for (size_t i = 0; i < m_Desc.frames; ++i)
+	{
+		m_Frames.push_back(std::make_unique<SimulationEventFrame>(m_Desc.arenaBlockSize));
+		if (i > 0)
+		{
+			m_Free->Push(m_Frames.back().get());
+		}
+	}
+
+	m_Current = m_Frames.front().get();
+	m_PairSteps.clear();
+	m_Stats = SimulationEventStats();
+}
+
+physx::PxFilterFlags PX::SimulationEvents::FilterShader(physx::PxFilterObjectAttributes attributes0, physx::PxFilterData filter_data0,
+	physx::PxFilterObjectAttributes attributes1, physx::PxFilterData filter_data1,
+	physx::PxPairFlags& pair_flags, const void* constant_block, physx::PxU32 constant_block_size)
+{
+	physx::PxFilterFlags flags = physx::PxDefaultSimulationFilterShader(attributes0, filter_data0, attributes1, filter_data1, pair_flags, constant_block, constant_block_size);
+
+	// Triggers already report, and pairs that won't collide have nothing to report
+	if (flags & (physx::PxFilterFlag::eKILL | physx::PxFilterFlag::eSUPPRESS) || physx::PxFilterObjectIsTrigger(attributes0) || physx::PxFilterObjectIsTrigger(attributes1))
+	{
+		return flags;
+	}
+
+	pair_flags |= physx::PxPairFlag::eNOTIFY_TOUCH_FOUND | physx::PxPairFlag::eNOTIFY_TOUCH_LOST | physx::PxPairFlag::eNOTIFY_CONTACT_POINTS;
+
+	const FilterShaderData* data = constant_block_size >= sizeof(FilterShaderData) ? static_cast<const FilterShaderData*>(constant_block) : nullptr;
+	if (data != nullptr && data->reportPersists)
+	{
+		pair_flags |= physx::PxPairFlag::eNOTIFY_TOUCH_PERSISTS;
+	}
+
+	return flags;
+}
+
+void PX::SimulationEvents::onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count)
+{
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		m_Current->breaks.externalReference.PushBack(m_Current->arena, constraints[i].externalReference);
+		m_Current->breaks.type.PushBack(m_Current->arena, constraints[i].type);
+	}
+
+	m_Stats.breaks += count;
+}
+
+void PX::SimulationEvents::onWake(physx::PxActor** actors, physx::PxU32 count)
+{
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		m_Current->woken.PushBack(m_Current->arena, actors[i]);
+	}
+
+	m_Stats.wakes += count;
+}
+
+void PX::SimulationEvents::onSleep(physx::PxActor** actors, physx::PxU32 count)
+{
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		m_Current->slept.PushBack(m_Current->arena, actors[i]);
+	}
+
+	m_Stats.sleeps += count;
+}
+
+void PX::SimulationEvents::onContact(const physx::PxContactPairHeader& pair_header, const physx::PxContactPair* pairs, physx::PxU32 count)
+{
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	// A removed actor's pointer is only good for forgetting its pairs
+	bool removed = pair_header.flags & (physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1);
+
+	physx::PxContactPairPoint points[MAX_PAIR_POINTS];
+	ExtractedPair batch[CONTACT_BATCH];
+	physx::PxU32 batch_count = 0;
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		const physx::PxContactPair& pair = pairs[i];
+		ExtractedPair& extracted = batch[batch_count++];
+		extracted = ExtractedPair();
+		extracted.pair = &pair;
+
+		extracted.removed = removed || pair.flags & (physx::PxContactPairFlag::eREMOVED_SHAPE_0 | physx::PxContactPairFlag::eREMOVED_SHAPE_1);
+		physx::PxU32 point_count = !extracted.removed && pair.contactCount > 0 ? pair.extractContacts(points, MAX_PAIR_POINTS) : 0;
+		for (physx::PxU32 j = 0; j < point_count; ++j)
+		{
+			extracted.impulse += points[j].impulse.magnitude();
+		}
+
+		if (point_count > 0)
+		{
+			extracted.position = points[0].position;
+			extracted.normal = points[0].normal;
+		}
+
+		if (batch_count < CONTACT_BATCH && i + 1 < count)
+		{
+			continue;
+		}
+
+		// The extraction above is the expensive part and runs on every worker, only this is serialised
+		std::lock_guard<std::mutex> lock(m_ContactMutex);
+		for (physx::PxU32 j = 0; j < batch_count; ++j)
+		{
+			const ExtractedPair& kept = batch[j];
+			if (kept.removed)
+			{
+				m_PairSteps.erase({ pair_header.actors[0], pair_header.actors[1] });
+				continue;
+			}
+
+			if (!KeepContact(pair_header, *kept.pair, kept.impulse))
+			{
+				continue;
+			}
+
+			m_Current->contacts.actor0.PushBack(m_Current->arena, pair_header.actors[0]);
+			m_Current->contacts.actor1.PushBack(m_Current->arena, pair_header.actors[1]);
+			m_Current->contacts.position.PushBack(m_Current->arena, kept.position);
+			m_Current->contacts.normal.PushBack(m_Current->arena, kept.normal);
+			m_Current->contacts.impulse.PushBack(m_Current->arena, kept.impulse);
+			m_Current->contacts.events.PushBack(m_Current->arena, static_cast<physx::PxU16>(kept.pair->events));
+			m_Stats.contacts++;
+			m_StepContacts++;
+		}
+
+		batch_count = 0;
+	}
+}
+
+bool PX::SimulationEvents::KeepContact(const physx::PxContactPairHeader& pair_header, const physx::PxContactPair& pair, physx::PxReal impulse)
+{
+	PairKey key = { pair_header.actors[0], pair_header.actors[1] };
+	std::uint64_t step = m_Stats.steps;
+
+	// Found and lost always go through, dropping one would leave a pair touching forever as far as anyone knows
+	if (pair.events & physx::PxPairFlag::eNOTIFY_TOUCH_LOST)
+	{
+		m_PairSteps.erase(key);
+		return true;
+	}
+
+	if (pair.events & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND)
+	{
+		if (m_Desc.pairThrottleSteps > 0)
+		{
+			m_PairSteps[key] = step;
+		}
+
+		return true;
+	}
+
+	// Only pairs staying in touch from here on
+	if (m_Desc.maxContactsPerStep > 0 && m_StepContacts >= m_Desc.maxContactsPerStep)
+	{
+		m_Stats.contactsCapped++;
+		return false;
+	}
+
+	if (impulse < m_Desc.minImpulse)
+	{
+		m_Stats.contactsBelowImpulse++;
+		return false;
+	}
+
+	if (m_Desc.pairThrottleSteps > 0)
+	{
+		auto last = m_PairSteps.find(key);
+		if (last != m_PairSteps.end() && step - last->second < static_cast<std::uint64_t>(m_Desc.pairThrottleSteps))
+		{
+			m_Stats.contactsThrottled++;
+			return false;
+		}
+
+		m_PairSteps[key] = step;
+	}
+
+	return true;
+}
+
+void PX::SimulationEvents::onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count)
+{
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		const physx::PxTriggerPair& pair = pairs[i];
+		if (pair.flags & (physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER))
+		{
+			continue;
+		}
+
+		m_Current->triggers.trigger.PushBack(m_Current->arena, pair.triggerActor);
+		m_Current->triggers.other.PushBack(m_Current->arena, pair.otherActor);
+		m_Current->triggers.status.PushBack(m_Current->arena, static_cast<physx::PxU16>(pair.status));
+		m_Stats.triggers++;
+	}
+}
+
+void PX::SimulationEvents::onAdvance(const physx::PxRigidBody* const* bodies, const physx::PxTransform* poses, const physx::PxU32 count)
+{
+	std::lock_guard<std::mutex> lock(m_AdvanceMutex);
+	CallbackTimer timer(m_StepCallbackTicks);
+
+	for (physx::PxU32 i = 0; i < count; ++i)
+	{
+		m_Current->advances.body.PushBack(m_Current->arena, bodies[i]);
+		m_Current->advances.pose.PushBack(m_Current->arena, poses[i]);
+	}
+
+	m_Stats.advances += count;
+}
+
+void PX::SimulationEvents::Publish()
+{
+	m_Current->step = m_Stats.steps;
+	m_Stats.steps++;
+
+	m_Stats.stepCallbackUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(m_StepCallbackTicks.exchange(0))).count();
+	m_Stats.totalCallbackUs += m_Stats.stepCallbackUs;
+	m_StepContacts = 0;
+
+	if (m_Current->IsEmpty())
+	{
+		return;
+	}
+
+	// Nobody gave a frame back, so these events go rather than let the frame grow without a consumer
+	SimulationEventFrame* next = nullptr;
+	if (!m_Free->Pop(next))
+	{
+		m_Stats.stalls++;
+		m_Current->Clear();
+		return;
+	}
+
+	m_Ready->Push(m_Current);
+	m_Stats.published++;
+
+	next->Clear();
+	m_Current = next;
+}
+
+const PX::SimulationEventFrame* PX::SimulationEvents::Acquire()
+{
+	SimulationEventFrame* frame = nullptr;
+	return m_Ready->Pop(frame) ? frame : nullptr;
+}
+
+void PX::SimulationEvents::Release(const SimulationEventFrame* frame)
+{
+	if (frame != nullptr)
+	{
+		m_Free->Push(const_cast<SimulationEventFrame*>(frame));
+	}
+}
+
+void PX::SimulationEvents::PrintStats(std::ostream& stream) const
+{
+	stream << "Simulation events: " << m_Stats.steps << " steps, " << m_Stats.contacts << " contacts ("
+		<< m_Stats.contactsBelowImpulse << " below impulse, " << m_Stats.contactsThrottled << " throttled, " << m_Stats.contactsCapped << " capped), "
+		<< m_Stats.triggers << " triggers, " << m_Stats.wakes << " wakes, " << m_Stats.sleeps << " sleeps, " << m_Stats.breaks << " breaks, "
+		<< m_Stats.advances << " advances, " << m_Stats.published << " frames published, " << m_Stats.stalls << " dropped\n";
+}
+
+size_t PX::SimulationEvents::PairKeyHash::operator()(const PairKey& key) const
+{
+	size_t hash = std::hash<const void*>()(key.actor0);
+	return hash ^ (std::hash<const void*>()(key.actor1) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
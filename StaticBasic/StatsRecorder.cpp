@@ -0,0 +1,204 @@
+#include "StatsRecorder.h"
+#include <iostream>
+
+namespace
+{
+	constexpr const char* GeometryNames[] = { "pairs_sphere", "pairs_plane", "pairs_capsule", "pairs_box", "pairs_convex_mesh", "pairs_particle_system", "pairs_tetrahedron_mesh", "pairs_triangle_mesh", "pairs_heightfield", "pairs_hair_system", "pairs_custom" };
+	static_assert(std::size(GeometryNames) == physx::PxGeometryType::eGEOMETRY_COUNT, "Geometry name table does not match PxGeometryType");
+
+	// Column names and values share one list so CSV and JSON can't drift apart
+	template <typename Fn>
+	void ForEachField(const PX::StepStats& stats, Fn fn)
+	{
+		fn("step", stats.step);
+		fn("wall_ms", stats.wallMs);
+		fn("active_dynamic_bodies", stats.activeDynamicBodies);
+		fn("active_kinematic_bodies", stats.activeKinematicBodies);
+		fn("static_bodies", stats.staticBodies);
+		fn("dynamic_bodies", stats.dynamicBodies);
+		fn("kinematic_bodies", stats.kinematicBodies);
+		fn("active_constraints", stats.activeConstraints);
+		fn("axis_solver_constraints", stats.axisSolverConstraints);
+		fn("peak_constraint_memory", stats.peakConstraintMemory);
+		fn("broadphase_adds", stats.broadPhaseAdds);
+		fn("broadphase_removes", stats.broadPhaseRemoves);
+		fn("discrete_contact_pairs", stats.discreteContactPairs);
+		fn("new_pairs", stats.newPairs);
+		fn("lost_pairs", stats.lostPairs);
+		fn("new_touches", stats.newTouches);
+		fn("lost_touches", stats.lostTouches);
+
+		for (size_t i = 0; i < stats.pairsPerGeometry.size(); ++i)
+		{
+			fn(GeometryNames[i], stats.pairsPerGeometry[i]);
+		}
+	}
+}
+
+PX::StatsRecorder::StatsRecorder(size_t capacity) : m_Steps(capacity > 0 ? capacity : 1)
+{
+}
+
+PX::StatsRecorder::~StatsRecorder()
+{
+	StopStream();
+}
+
+void PX::StatsRecorder::Record(const physx::PxSimulationStatistics& statistics, double wall_ms)
+{
+	StepStats& stats = m_Steps[m_Next];
+	stats.step = m_StepCounter++;
+	stats.wallMs = wall_ms;
+
+	stats.activeDynamicBodies = statistics.nbActiveDynamicBodies;
+	stats.activeKinematicBodies = statistics.nbActiveKinematicBodies;
+	stats.staticBodies = statistics.nbStaticBodies;
+	stats.dynamicBodies = statistics.nbDynamicBodies;
+	stats.kinematicBodies = statistics.nbKinematicBodies;
+
+	stats.activeConstraints = statistics.nbActiveConstraints;
+	stats.axisSolverConstraints = statistics.nbAxisSolverConstraints;
+	stats.peakConstraintMemory = statistics.peakConstraintMemory;
+
+	stats.broadPhaseAdds = statistics.getNbBroadPhaseAdds();
+	stats.broadPhaseRemoves = statistics.getNbBroadPhaseRemoves();
+
+	stats.discreteContactPairs = statistics.nbDiscreteContactPairsTotal;
+	stats.newPairs = statistics.nbNewPairs;
+	stats.lostPairs = statistics.nbLostPairs;
+	stats.newTouches = statistics.nbNewTouches;
+	stats.lostTouches = statistics.nbLostTouches;
+
+	// The pair table is symmetric, a row sum is every pair the type is part of with same type pairs counted once
+	for (int i = 0; i < physx::PxGeometryType::eGEOMETRY_COUNT; ++i)
+	{
+		std::uint32_t pairs = 0;
+		for (int j = 0; j < physx::PxGeometryType::eGEOMETRY_COUNT; ++j)
+		{
+			pairs += statistics.getRbPairStats(physx::PxSimulationStatistics::eDISCRETE_CONTACT_PAIRS, static_cast<physx::PxGeometryType::Enum>(i), static_cast<physx::PxGeometryType::Enum>(j));
+		}
+
+		stats.pairsPerGeometry[i] = pairs;
+	}
+
+	m_Next = (m_Next + 1) % m_Steps.size();
+	m_Count = m_Count < m_Steps.size() ? m_Count + 1 : m_Count;
+
+	if (m_Stream.is_open())
+	{
+		WriteStep(m_Stream, m_StreamFormat, stats, m_StreamFirst);
+		m_StreamFirst = false;
+	}
+}
+
+std::vector<PX::StepStats> PX::StatsRecorder::GetHistory() const
+{
+	std::vector<StepStats> history;
+	history.reserve(m_Count);
+
+	size_t first = (m_Next + m_Steps.size() - m_Count) % m_Steps.size();
+	for (size_t i = 0; i < m_Count; ++i)
+	{
+		history.push_back(m_Steps[(first + i) % m_Steps.size()]);
+	}
+
+	return history;
+}
+
+bool PX::StatsRecorder::StartStream(const std::string& path, StatsFormat format)
+{
+	StopStream();
+
+	m_Stream.open(path);
+	if (!m_Stream)
+	{
+		std::cout << "Error: could not open " << path << " for the stats stream\n";
+		return false;
+	}
+
+	m_StreamFormat = format;
+	m_StreamFirst = true;
+	WriteHeader(m_Stream, format);
+	return true;
+}
+
+void PX::StatsRecorder::StopStream()
+{
+	if (!m_Stream.is_open())
+	{
+		return;
+	}
+
+	WriteFooter(m_Stream, m_StreamFormat);
+	m_Stream.close();
+}
+
+bool PX::StatsRecorder::Export(const std::string& path, StatsFormat format) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Error: could not open " << path << " for the stats export\n";
+		return false;
+	}
+
+	WriteHeader(file, format);
+
+	bool first = true;
+	for (const StepStats& stats : GetHistory())
+	{
+		WriteStep(file, format, stats, first);
+		first = false;
+	}
+
+	WriteFooter(file, format);
+	return static_cast<bool>(file);
+}
+
+void PX::StatsRecorder::WriteHeader(std::ostream& stream, StatsFormat format)
+{
+	if (format == StatsFormat::Json)
+	{
+		stream << "[\n";
+		return;
+	}
+
+	bool first = true;
+	ForEachField(StepStats(), [&](const char* name, auto)
+	{
+		stream << (first ? "" : ",") << name;
+		first = false;
+	});
+	stream << '\n';
+}
+
+void PX::StatsRecorder::WriteStep(std::ostream& stream, StatsFormat format, const StepStats& stats, bool first)
+{
+	bool first_field = true;
+	if (format == StatsFormat::Json)
+	{
+		stream << (first ? "{" : ",\n{");
+		ForEachField(stats, [&](const char* name, auto value)
+		{
+			stream << (first_field ? "" : ",") << '"' << name << "\":" << value;
+			first_field = false;
+		});
+		stream << '}';
+		return;
+	}
+
+	ForEachField(stats, [&](const char*, auto value)
+	{
+		stream << (first_field ? "" : ",") << value;
+		first_field = false;
+	});
+	stream << '\n';
+}
+
+void PX::StatsRecorder::WriteFooter(std::ostream& stream, StatsFormat format)
+{
+	if (format == StatsFormat::Json)
+	{
+		stream << "\n]\n";
+	}
+}
@@ -1,4 +1,5 @@
 #include "DxShader.h"
+#include <cstring>
 #include <fstream>
 #include <vector>
 
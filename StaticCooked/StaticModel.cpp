@@ -64,6 +64,9 @@ void DX::StaticModel::CreateIndexBuffer()
 
 void DX::StaticModel::CreatePhysicsActor()
 {
+	// The cooked mesh is the collision here, the fit only supplies the bounds
+	m_Bounds = PX::ComputeMeshBounds(m_MeshData);
+
 	std::vector<physx::PxVec3> vecs;
 	for (auto& v : m_MeshData.vertices)
 	{
@@ -76,7 +79,7 @@ void DX::StaticModel::CreatePhysicsActor()
 	meshDesc.points.stride = sizeof(physx::PxVec3);
 	meshDesc.points.data = vecs.data();
 
-	meshDesc.triangles.count = m_MeshData.indices.size();;
+	meshDesc.triangles.count = static_cast<physx::PxU32>(m_MeshData.indices.size() / 3);
 	meshDesc.triangles.stride = 3 * sizeof(UINT);
 	meshDesc.triangles.data = m_MeshData.indices.data();
 
@@ -87,30 +90,26 @@ void DX::StaticModel::CreatePhysicsActor()
 	params.buildTriangleAdjacencies = false;
 	params.buildGPUData = true;
 
-	physx::PxDefaultMemoryOutputStream writeBuffer;
-	physx::PxTriangleMeshCookingResult::Enum result;
-
-	bool status = PxCookTriangleMesh(params, meshDesc, writeBuffer, &result);
-	if (!status)
+	// Read back from the mesh cache when this mesh was cooked with the same settings before
+	auto mesh = m_Physics->GetMeshCache().CreateTriangleMesh(*m_Physics->GetPhysics(), params, meshDesc);
+	if (mesh == nullptr)
 	{
 		return;
 	}
 
-	physx::PxDefaultMemoryInputData readBuffer(writeBuffer.getData(), writeBuffer.getSize());
-	auto mesh = m_Physics->GetPhysics()->createTriangleMesh(readBuffer);
-
 	physx::PxTriangleMeshGeometry geom;
 	geom.triangleMesh = mesh;
 	geom.scale = physx::PxVec3(1.0f, 1.0f, 1.0f);
 
 
-	physx::PxMaterial* material = m_Physics->GetPhysics()->createMaterial(0.4f, 0.4f, 0.4f);
+	physx::PxMaterial* material = m_Physics->GetShapeRegistry().AcquireMaterial(0.4f, 0.4f, 0.4f);
 	// physx::PxShape* shape = m_Physics->GetPhysics()->createShape(physx::PxBoxGeometry(m_Dimensions.x, m_Dimensions.y, m_Dimensions.z), *material);
 
 	// Set position
 	physx::PxVec3 position = physx::PxVec3(physx::PxReal(m_Position.x), physx::PxReal(m_Position.y), physx::PxReal(m_Position.z));
 	physx::PxTransform transform(position);
 	m_Body = m_Physics->GetPhysics()->createRigidStatic(transform);
+	m_Body->userData = static_cast<PX::ActorOwner*>(this);
 
 	physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*m_Body, geom, *material);
 	shape->setContactOffset(0.1f);
@@ -143,7 +142,11 @@ void DX::StaticModel::Render()
 
 void DX::StaticModel::Update()
 {
-	physx::PxTransform global_pose = m_Body->getGlobalPose();
+	SyncTransform(m_Physics->GetInterpolatedPose(m_Body));
+}
+
+void DX::StaticModel::SyncTransform(const physx::PxTransform& global_pose)
+{
 	m_Position.x = global_pose.p.x;
 	m_Position.y = global_pose.p.y;
 	m_Position.z = global_pose.p.z;